@@ -10,6 +10,10 @@ public:
     
     void setSize(int width, int height);
     void setFov(float fov);
+    // Pinhole focal lengths in pixels, principal point at the center; the
+    // FOV follows fy. The next setSize or setFov goes back to square pixels.
+    void setFocalLengths(float fx, float fy);
+    void setClipPlanes(float nearPlane, float farPlane);
     void setPosition(const glm::vec3& pos);
     void setTarget(const glm::vec3& target);
     void setUp(const glm::vec3& up);
@@ -30,6 +34,8 @@ public:
     int getHeight() const { return height; }
 
 private:
+    void updateProjection();
+    
     glm::vec3 position;
     glm::vec3 target;
     glm::vec3 up;
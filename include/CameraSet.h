@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Camera.h"
+
+namespace gsplat {
+
+// One view of an evaluation camera list
+struct CameraView {
+    std::string name;
+    int width;
+    int height;
+    // Focal lengths in pixels; the principal point is the image center
+    float fx;
+    float fy;
+    // Camera center, and camera-to-world rotation whose columns are the
+    // right, down and forward axes (COLMAP convention)
+    glm::vec3 position;
+    glm::mat3 rotation;
+};
+
+// Camera lists in the cameras.json layout 3DGS training writes: an array of
+// objects with img_name, width, height, position, rotation (camera to world,
+// as three rows), fx and fy. Errors throw std::runtime_error.
+class CameraSet {
+public:
+    static std::vector<CameraView> load(const std::string& path);
+
+    // Pose camera as view, with its size and focal lengths
+    static void apply(const CameraView& view, Camera& camera);
+};
+
+} // namespace gsplat
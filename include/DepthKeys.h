@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+#include "glm/glm.hpp"
+
+#include "Simd.h"
+
+namespace gsplat {
+
+// Depth used for ordering is dot(xyz, p) + w: one row of the view-projection
+struct DepthAxis {
+    float x, y, z, w;
+};
+
+// Clip-space w (view distance) for perspective projections. Ordering by w
+// matches ordering by z/w for every point in front of the camera and needs
+// no divide. Orthographic projections have a constant w, so z is used.
+DepthAxis depthAxisFromViewProj(const glm::mat4& viewProj);
+
+// The four rows of a view-projection, giving clip-space x, y, z and w
+struct ClipRows {
+    DepthAxis x, y, z, w;
+};
+
+ClipRows clipRowsFromViewProj(const glm::mat4& viewProj);
+
+// Clip-space margin of the frustum test; splat.vert culls centers outside
+// 1.2 * w in x and y, so a splat partly on screen is kept
+constexpr float kCullMargin = 1.2f;
+
+// Kernels over structure-of-arrays positions. All levels produce identical
+// bits: the SIMD paths use the same operation order as the scalar one.
+
+// keys[i] = order-preserving uint32 of the depth
+void computeDepthKeys32(SimdLevel level, const DepthAxis& axis,
+                        const float* x, const float* y, const float* z,
+                        uint32_t count, uint32_t* keys);
+
+// depths[i] = depth; minDepth/maxDepth are widened to cover them (NaN ignored)
+void computeDepths(SimdLevel level, const DepthAxis& axis,
+                   const float* x, const float* y, const float* z,
+                   uint32_t count, float* depths, float& minDepth, float& maxDepth);
+
+// Frustum-culling variants: only splats splat.vert would draw (clip z within
+// +-w, x and y within +-kCullMargin * w) are written, packed to the front,
+// with base + i appended to indices. Values match the unculled kernels.
+// Return how many splats were visible.
+uint32_t cullDepthKeys32(SimdLevel level, const ClipRows& clip, const DepthAxis& axis,
+                         const float* x, const float* y, const float* z,
+                         uint32_t count, uint32_t base, uint32_t* keys, uint32_t* indices);
+
+uint32_t cullDepths(SimdLevel level, const ClipRows& clip, const DepthAxis& axis,
+                    const float* x, const float* y, const float* z,
+                    uint32_t count, uint32_t base, float* depths, uint32_t* indices,
+                    float& minDepth, float& maxDepth);
+
+// Where an axis-aligned box lies against the frustum the culling kernels
+// test. Inside and Outside hold for every point in the box under the
+// per-splat test despite its rounding; boxes near a plane are Partial.
+enum class BoxVisibility { Outside, Partial, Inside };
+
+BoxVisibility classifyBox(const ClipRows& clip, const glm::vec3& boxMin, const glm::vec3& boxMax);
+
+// Range of the depths the kernels compute for points in the box; exact, as
+// each rounded step is monotonic in every coordinate
+void boxDepthRange(const DepthAxis& axis, const glm::vec3& boxMin, const glm::vec3& boxMax,
+                   float& minDepth, float& maxDepth);
+
+// keys[i] = clamp((depths[i] - minDepth) * scale, 0, 65535), NaN -> 0
+void quantizeDepths16(SimdLevel level, const float* depths, uint32_t count,
+                      float minDepth, float scale, uint32_t* keys);
+
+} // namespace gsplat
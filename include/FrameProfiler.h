@@ -0,0 +1,136 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+
+namespace gsplat {
+
+// Parts of Renderer::render the profiler times, in frame order
+enum class ProfilePhase {
+    SplatUpload,  // Budgeted splat texture upload
+    Camera,       // View and projection matrices
+    Sort,         // CPU or GPU depth sort, or fetching the worker's order
+    IndexUpload,  // Sorted indices to the index buffer
+    Uniforms,     // GL state, textures, uniforms and vertex attributes
+    Draw,
+    Frame,        // Whole render call; its GPU time is the sum of the phases
+    Count
+};
+
+const char* profilePhaseName(ProfilePhase phase);
+
+// Of the samples in the rolling window, in milliseconds; 0 without samples
+struct Percentiles {
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+};
+
+// Per-phase CPU and GPU timings of rendered frames. CPU times come from
+// steady_clock. GPU times come from one GL_TIME_ELAPSED query per phase,
+// read back kLatency frames later; a frame whose results are still pending
+// then is dropped rather than waited on, so profiling never stalls the
+// pipeline. Percentiles are taken over the last kWindow frames, and with
+// recording on every frame is kept for export.
+//
+// Phases do not nest: beginning one ends the one in progress. Disabled by
+// default, in which case every call returns immediately. GL calls need the
+// context current; queries are created on first enable.
+class FrameProfiler {
+public:
+    static constexpr size_t kWindow = 240;
+    static constexpr int kLatency = 4;
+
+    FrameProfiler();
+    ~FrameProfiler();
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+
+    void beginFrame();
+    void endFrame();
+    void begin(ProfilePhase phase);
+    void end();
+    // Wait for the frames still in flight and read their GPU times back,
+    // e.g. before printing or writing the results on exit
+    void flush();
+
+    Percentiles getCpuPercentiles(ProfilePhase phase) const;
+    Percentiles getGpuPercentiles(ProfilePhase phase) const;
+    // Frames whose GPU results were not ready in time
+    uint64_t getDroppedGpuFrames() const { return droppedGpuFrames; }
+
+    // One line per phase with CPU and GPU p50/p95/p99
+    void printSummary(std::ostream& out) const;
+
+    // Keep every frame from now on for the writers below. Frames are kept
+    // once their GPU times are read back or dropped.
+    void setRecording(bool enabled) { recording = enabled; }
+    // Chrome trace event JSON (chrome://tracing, Perfetto). CPU phases are on
+    // one track; GPU phases on another, placed at their CPU start since only
+    // their durations are measured. Throws std::runtime_error on I/O errors.
+    void writeChromeTrace(const std::string& path) const;
+    // One row per frame and phase: frame,phase,cpu_start_us,cpu_ms,gpu_ms
+    // (gpu_ms empty when dropped)
+    void writeCsv(const std::string& path) const;
+
+private:
+    static constexpr size_t kPhases = static_cast<size_t>(ProfilePhase::Count);
+
+    // One frame's timings; GPU times are negative until read back
+    struct FrameRecord {
+        uint64_t frame = 0;
+        double cpuStartUs[kPhases] = {};
+        float cpuMs[kPhases] = {};
+        float gpuMs[kPhases] = {};
+        bool timed[kPhases] = {};
+    };
+
+    // Queries of a frame in flight
+    struct Slot {
+        GLuint queries[kPhases] = {};
+        bool issued[kPhases] = {};
+        bool pending = false;
+        FrameRecord record;
+    };
+
+    // The last kWindow samples of one phase
+    struct Window {
+        std::vector<float> samples;
+        size_t next = 0;
+    };
+
+    double nowUs() const;
+    // Read back every pending frame whose results are ready, oldest first;
+    // the slot about to be reused is dropped if it is not
+    void collect(int reuse);
+    static void addSample(Window& window, float ms);
+    static Percentiles percentiles(const Window& window);
+
+    bool enabled;
+    bool recording;
+    bool hasQueries;
+    std::chrono::steady_clock::time_point epoch;
+    uint64_t frame;
+    // Slot of the frame in progress, and the phase in progress or -1
+    int current;
+    int phase;
+    double phaseStartUs;
+    uint64_t droppedGpuFrames;
+    Slot slots[kLatency];
+
+    Window cpuWindows[kPhases];
+    Window gpuWindows[kPhases];
+    std::vector<FrameRecord> records;
+};
+
+} // namespace gsplat
@@ -4,22 +4,92 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include "MemoryReport.h"
+#include "Simd.h"
+#include "SplatFormat.h"
+
 namespace gsplat {
 
+class ThreadPool;
+
+// Structure-of-arrays positions, laid out for the vectorized depth kernels
+struct SoAPositions {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    
+    size_t size() const { return x.size(); }
+    void resize(size_t n) { x.resize(n); y.resize(n); z.resize(n); }
+    void clear() { x.clear(); y.clear(); z.clear(); }
+};
+
 struct GaussianData {
+    // Source attributes; empty when the scene was loaded from a SplatCache
     std::vector<glm::vec3> positions;
     std::vector<glm::vec3> scales;
     std::vector<glm::quat> rotations;
     std::vector<glm::u8vec4> colors;
+    // Spherical harmonics past DC: shCoefficients(shDegree) RGB triplets per
+    // splat, lowest band first
+    std::vector<float> shRest;
+    
+    // Layout pack() produces and packedData holds
+    SplatFormat format = SplatFormat::Full;
+    // Harmonic bands in shRest and shData; 0 is view-independent color
+    int shDegree = 0;
+    ShFormat shFormat = ShFormat::Half;
     
-    // Packed data for GPU
+    // Packed data for GPU, splatWords(format) uint32 per gaussian. A texture
+    // row holds 2048 texels, so this is already in texture layout.
     std::vector<uint32_t> packedData;
-    std::vector<float> worldPositions;  // Only needed for sorting
+    // Compressed only: per chunk, the float bits of position min and step and
+    // log-scale min and step, each an xyz0 texel
+    std::vector<uint32_t> chunkData;
+    // shTexels(shDegree, shFormat) texels per splat, consecutive in texture order
+    std::vector<uint32_t> shData;
+    // Only needed for sorting. For compressed data these are the dequantized
+    // positions, so the order matches what is drawn.
+    SoAPositions worldPositions;
     
-    size_t count() const { return positions.size(); }
+    // Axis-aligned bounds of the positions
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
     
-    void pack();
+    size_t count() const { return worldPositions.size(); }
+    // Layout of the packed data, with the harmonic degree it actually has
+    SplatLayout layout() const { return {format, shDegree, shFormat}; }
+    
+    // Fill packedData, worldPositions and the bounds from the source
+    // attributes. The result does not depend on the pool or SIMD level.
+    void pack(ThreadPool* pool = nullptr, SimdLevel level = detectSimdLevel());
     void clear();
+    
+    // Reorder the source attributes so every run of kSplatChunkSize splats
+    // is a compact region: runs are cut at chunk-aligned medians of the
+    // longest axis, recursively. Call before pack(); SplatChunks bounds and
+    // compressed chunk ranges are tight afterwards. Deterministic for any pool.
+    void sortSpatially(ThreadPool* pool = nullptr);
+    
+    // Free the source attributes; after pack() nothing else needs them
+    void releaseSource();
+    
+    void reportMemory(MemoryReport& report) const;
+    
+    // Append other's packed data, sort positions and bounds; source
+    // attributes are not carried over. Compressed data can only be appended
+    // at a chunk boundary, and harmonics must match; throws
+    // std::runtime_error otherwise.
+    void appendPacked(const GaussianData& other);
+    // Throw the std::runtime_error appendPacked would for other's format or
+    // harmonics, without changing anything
+    void checkAppendable(const GaussianData& other) const;
+    
+    // Compressed only: append splats up to the next chunk boundary so
+    // another scene can be appended. Their packed data is zero, which
+    // dequantizes to the chunk's position minimum, and their sort positions
+    // sit there too so the CPU and GPU sorts place them alike; callers must
+    // not draw them.
+    void padToChunk();
 };
 
 } // namespace gsplat
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "DepthKeys.h"
+#include "MemoryReport.h"
+#include "ProgramCache.h"
+#include "SplatTexture.h"
+
+namespace gsplat {
+
+// Where the per-frame depth sort runs
+enum class SortBackend {
+    Cpu,  // SplatSortContext; the index buffer is uploaded whenever the order changes
+    Gpu   // GpuSort; the order is produced directly in a GPU buffer (OpenGL 4.3)
+};
+
+// Depth sort with compute shaders. Keys are computed from the splat texture
+// and radix-sorted straight into a buffer the renderer binds as its
+// per-instance index attribute, so no index data crosses the bus per frame.
+//
+// Uses 32-bit keys and eight stable 4-bit passes; the resulting order is
+// identical to SplatSort::sort.
+class GpuSort {
+public:
+    // Programs come from programCache when given, else are compiled
+    explicit GpuSort(ProgramCache* programCache = nullptr);
+    ~GpuSort();
+    
+    GpuSort(const GpuSort&) = delete;
+    GpuSort& operator=(const GpuSort&) = delete;
+    
+    // True if the current context can run the compute path
+    static bool isSupported();
+    
+    // Allocate buffers for splatCount splats and forget the previous order
+    void resize(uint32_t splatCount);
+    
+    // Forget the previous order, e.g. after scene instances moved
+    void reset() { hasPrevious = false; }
+    
+    // Sort the splats stored in splats, placed by the SceneInstances table
+    // texture instances when nonzero. Returns false when the depth axis is
+    // unchanged and the previous order is still exact.
+    bool sort(const glm::mat4& viewProj, const SplatTexture& splats, GLuint instances = 0);
+    
+    // Buffer holding the order after sort(), one uint32 per splat
+    GLuint getIndexBuffer() const { return indexBuffers[0]; }
+    
+    // Read the current order back, for validation
+    void readIndices(std::vector<uint32_t>& out);
+    
+    void reportMemory(MemoryReport& report) const;
+
+private:
+    // Key computation, one program per splat format, with and without instances
+    struct KeyProgram {
+        GLuint program = 0;
+        GLint u_texture = -1, u_chunks = -1, u_instances = -1, u_axis = -1, u_count = -1;
+    };
+    static KeyProgram createKeyProgram(ProgramCache& programs, const std::string& defines);
+    
+    // Indexed by compressed + 2 * instanced
+    KeyProgram keyPrograms[4];
+    GLuint programCount, programScan, programScatter;
+    GLint u_countCount, u_countShift, u_countBlockCount;
+    GLint u_scanSize;
+    GLint u_scatterCount, u_scatterShift, u_scatterBlockCount, u_scatterFirstPass;
+    
+    // Ping-pong key and index buffers; the final pass writes index 0
+    GLuint keyBuffers[2];
+    GLuint indexBuffers[2];
+    GLuint histogramBuffer;
+    
+    uint32_t splatCount;
+    uint32_t blockCount;
+    bool hasPrevious;
+    DepthAxis prevAxis;
+};
+
+} // namespace gsplat
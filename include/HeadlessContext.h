@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+namespace gsplat {
+
+// OpenGL core context without a window or display server, made current on
+// the calling thread. Tries each EGL GPU device, then Mesa's surfaceless
+// platform (llvmpipe on machines without a GPU), then the default display.
+// There is no default framebuffer, so render into a framebuffer object.
+// Loads the GL functions; throws std::runtime_error when no platform gives
+// a context of at least the requested version.
+class HeadlessContext {
+public:
+    HeadlessContext(int major, int minor);
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // EGL platform and vendor the context came from
+    const std::string& getDescription() const { return description; }
+
+private:
+    // EGLDisplay and EGLContext, kept opaque so EGL stays out of the header
+    void* display;
+    void* context;
+    std::string description;
+};
+
+} // namespace gsplat
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gsplat {
+
+// Writes images on a background thread so rendering never waits on the
+// disk. PNGs are stored uncompressed, as nothing here links zlib.
+class ImageWriter {
+public:
+    // write() blocks while maxQueued images are waiting
+    explicit ImageWriter(size_t maxQueued = 8);
+    // Writes whatever is still queued
+    ~ImageWriter();
+
+    ImageWriter(const ImageWriter&) = delete;
+    ImageWriter& operator=(const ImageWriter&) = delete;
+
+    // rgb holds width * height * 3 bytes, top row first. Rethrows an earlier
+    // write error as std::runtime_error.
+    void write(const std::string& path, int width, int height, std::vector<uint8_t>&& rgb);
+    // Wait until every queued image is on disk; rethrows a write error
+    void finish();
+    size_t getWrittenCount() const;
+
+    // 8-bit RGB PNG, written on the calling thread
+    static void writePng(const std::string& path, int width, int height, const uint8_t* rgb);
+
+private:
+    struct Image {
+        std::string path;
+        int width;
+        int height;
+        std::vector<uint8_t> rgb;
+    };
+
+    void run();
+
+    size_t maxQueued;
+    std::deque<Image> queue;
+    mutable std::mutex mutex;
+    std::condition_variable queueCv;
+    std::condition_variable doneCv;
+    bool stopping;
+    bool busy;
+    size_t written;
+    std::string error;
+    std::thread thread;
+};
+
+} // namespace gsplat
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "glad/glad.h"
+
+namespace gsplat {
+
+// Per-instance index stream for the CPU sort backends. One persistently and
+// coherently mapped buffer is split into three regions: each new order is
+// written straight into the next region while the GPU may still be drawing
+// from the others, and a fence per region stops a write from overtaking a
+// draw that still reads it. Nothing is reallocated or copied by the driver.
+class IndexRing {
+public:
+    IndexRing();
+    ~IndexRing();
+    
+    IndexRing(const IndexRing&) = delete;
+    IndexRing& operator=(const IndexRing&) = delete;
+    
+    // True if the context has glBufferStorage (OpenGL 4.4 or ARB_buffer_storage)
+    static bool isSupported();
+    
+    // Next region, with room for count indices, once the GPU is done with it.
+    // Growing reallocates the whole ring, which discards the current order.
+    uint32_t* beginWrite(size_t count);
+    // Draw from the region returned by the last beginWrite
+    void endWrite();
+    
+    // Fence the region in use after issuing the draws that read it
+    void fence();
+    
+    GLuint getBuffer() const { return buffer; }
+    // Byte offset of the region to draw from
+    size_t getDrawOffset() const { return static_cast<size_t>(current) * capacity * sizeof(uint32_t); }
+    
+    size_t gpuBytes() const { return kSlots * capacity * sizeof(uint32_t); }
+
+private:
+    static constexpr int kSlots = 3;
+    
+    void allocate(size_t count);
+    void waitSlot(int slot);
+    
+    GLuint buffer;
+    uint32_t* mapped;
+    size_t capacity;
+    int current;
+    GLsync fences[kSlots];
+};
+
+} // namespace gsplat
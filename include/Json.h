@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gsplat {
+
+// The JSON subset camera lists and scene compositions use: objects, arrays,
+// numbers, strings, booleans and null
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+    Type type = Type::Null;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    const JsonValue* find(const std::string& key) const {
+        for (const auto& member : members) {
+            if (member.first == key) return &member.second;
+        }
+        return nullptr;
+    }
+};
+
+// Parse a whole document; path is only used in messages. Errors throw
+// std::runtime_error with the byte offset.
+JsonValue parseJson(const std::string& text, const std::string& path);
+
+} // namespace gsplat
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "GaussianData.h"
+#include "MemoryReport.h"
+
+namespace gsplat {
+
+class ThreadPool;
+
+// Node i of the tree is splat i of the scene it was built for
+struct LodNode {
+    // Bounding sphere of every source splat below the node, at 3 sigma
+    glm::vec3 center;
+    float radius;
+    // Children are consecutive nodes; 0 children for a source splat
+    uint32_t firstChild;
+    uint32_t childCount;
+};
+
+// Level-of-detail hierarchy over a scene. Source splats are the leaves;
+// each interior node holds one merged Gaussian matching the weight, mean
+// and covariance of its children, with opacity * area as the weight. Nodes
+// are in breadth-first order, so coarse levels come first in the texture
+// and are drawn while a budgeted upload is still filling in the leaves.
+class LodTree {
+public:
+    // Children per interior node, from three median splits
+    static constexpr uint32_t kFanout = 8;
+
+    // Reorder data into tree order with the merged parents added, and repack
+    // it. Needs data's source attributes; throws std::runtime_error without.
+    static LodTree build(GaussianData& data, ThreadPool* pool = nullptr);
+
+    bool empty() const { return nodes.empty(); }
+    size_t nodeCount() const { return nodes.size(); }
+    const std::vector<LodNode>& getNodes() const { return nodes; }
+
+    // Splats to draw from eye: nodes are refined largest projected radius
+    // first while it exceeds pixelError pixels, the cut stays within budget
+    // splats (0 = no limit) and the children are among the first resident
+    // splats. focal is in pixels.
+    void selectCut(const glm::vec3& eye, float focal, float pixelError, size_t budget, size_t resident,
+                   std::vector<uint32_t>& cut);
+
+    void reportMemory(MemoryReport& report) const;
+
+private:
+    std::vector<LodNode> nodes;
+    // Refinement candidates by projected radius, reused across frames
+    std::vector<std::pair<float, uint32_t>> heap;
+};
+
+} // namespace gsplat
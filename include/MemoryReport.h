@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace gsplat {
+
+// Bytes held per buffer, for finding where the memory of a scene goes
+class MemoryReport {
+public:
+    void add(const std::string& name, size_t bytes, bool gpu = false);
+    
+    size_t totalBytes(bool gpu) const;
+    
+    // One line per buffer, CPU then GPU, with totals
+    void print(std::ostream& out) const;
+
+private:
+    struct Entry {
+        std::string name;
+        size_t bytes;
+        bool gpu;
+    };
+    std::vector<Entry> entries;
+};
+
+// Allocated (not just used) size of a vector
+template <typename T>
+size_t vectorBytes(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+} // namespace gsplat
@@ -12,6 +12,8 @@ public:
     
     void update(float deltaTime);
     void reset();
+    // Orbit target from distance, keeping the view direction
+    void frame(const glm::vec3& target, float distance);
     
     void setRotationSpeed(float speed) { rotationSpeed = speed; }
     void setZoomSpeed(float speed) { zoomSpeed = speed; }
@@ -31,6 +33,8 @@ private:
     bool panning;
     
     float distance;
+    // Farthest zoom, grown by frame() for large scenes
+    float maxDistance;
     float theta, phi;
     glm::vec3 targetPos;
     
@@ -6,9 +6,37 @@
 
 namespace gsplat {
 
+class ThreadPool;
+
+// Raw attributes of one PLY vertex, as stored in the file
+struct PLYVertex {
+    float x, y, z;
+    float scale[3];     // log scale
+    float rot[4];       // unnormalized quaternion, w first
+    float color[3];     // f_dc_* when hasSH, red/green/blue when hasRGB
+    float opacity;      // logit, when hasOpacity
+    float shRest[3][kMaxShCoefficients];  // f_rest_* per channel, lowest band first
+    bool hasSH;
+    bool hasRGB;
+    bool hasOpacity;
+};
+
 class PLYLoader {
 public:
-    static GaussianData load(const std::string& path);
+    // pool, if given, parallelizes packing. The source attributes are
+    // released after packing unless keepSource is set. spatialOrder groups
+    // the splats into compact chunks first (GaussianData::sortSpatially),
+    // so file order is lost.
+    static GaussianData load(const std::string& path, ThreadPool* pool = nullptr, bool keepSource = false,
+                             const SplatLayout& layout = SplatLayout(), bool spatialOrder = false);
+    
+    // Activate scale and opacity, normalize the rotation, evaluate the color,
+    // and store the result at index i of data's source attributes. The first
+    // data.shDegree bands of v.shRest go to data.shRest, which must be sized.
+    static void convertVertex(const PLYVertex& v, GaussianData& data, size_t i);
+    
+    // Highest complete harmonic degree among restCount f_rest_* properties
+    static int shDegreeFor(size_t restCount);
 };
 
 } // namespace gsplat
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Simd.h"
+#include "SplatFormat.h"
+
+namespace gsplat {
+
+// Source attributes of the splats to pack, as stored in GaussianData
+struct PackInput {
+    const glm::vec3* positions;
+    const glm::vec3* scales;
+    const glm::quat* rotations;
+    const glm::u8vec4* colors;
+};
+
+// Pack splats [begin, end) into packed (8 uint32 each: position bits, 0,
+// covariance as three half2, RGBA8) and their positions into x/y/z.
+// All levels produce identical bits: the covariance is evaluated in the
+// same operation order everywhere and halves are truncated, which is what
+// F16C does with round-toward-zero. Without F16C, and at the SSE4.1 level,
+// the scalar path is used.
+void packSplats(SimdLevel level, const PackInput& in, size_t begin, size_t end,
+                uint32_t* packed, float* x, float* y, float* z);
+
+// Compressed layout of splats [begin, end); begin must start a chunk. Each
+// splat takes 4 uint32:
+//   x: position x | y << 16, 16-bit steps from the chunk minimum
+//   y: position z | rotation a << 16 | rotation b << 24
+//   z: rotation c | largest component << 8 | log-scale x << 10 | y << 17 | z << 24
+//   w: RGBA8
+// Rotations use the smallest three components at 8 bits, scales 7 bits of
+// log scale within the chunk's range. x/y/z receive the dequantized
+// positions, computed exactly as splat.vert and sort_keys.comp do.
+void compressSplats(const PackInput& in, size_t begin, size_t end,
+                    uint32_t* packed, uint32_t* chunks, float* x, float* y, float* z);
+
+// Pack the harmonics of splats [begin, end) from rest (shCoefficients(degree)
+// RGB triplets per splat) into out, shTexels(degree, format) texels each.
+// Values keep their order, two halves or four bytes per word, low first.
+// The byte layout starts with the largest magnitude as a half, rounded up,
+// and stores round(v / range * 127) + 128. Padding is zero.
+void packSH(int degree, ShFormat format, const float* rest, size_t begin, size_t end, uint32_t* out);
+
+// Deviation of the compressed layout from the full one
+struct CompressionError {
+    float maxPosition;       // World units
+    float maxScale;          // Relative
+    float maxRotationDeg;
+    float rmsCovariance;     // Frobenius norm relative to the full covariance
+    float maxCovariance;
+};
+
+// Decode compressed splats [begin, end) and compare with the source attributes
+CompressionError measureCompression(const PackInput& in, size_t begin, size_t end,
+                                    const uint32_t* packed, const uint32_t* chunks);
+
+} // namespace gsplat
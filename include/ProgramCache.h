@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+
+namespace gsplat {
+
+// One stage of a program: shader type, complete source, and a name for messages
+struct ShaderStage {
+    GLenum type;
+    std::string source;
+    std::string name;
+};
+
+// Source of shaders/<name>, looked up in $GSPLAT_SHADER_DIR, then ./shaders,
+// then the build tree's copy, so the programs run from any directory.
+// Throws std::runtime_error if none has it.
+std::string readShader(const std::string& name);
+
+// Compiles and links programs, keeping each linked binary on disk so later
+// starts load it with glProgramBinary instead of compiling. Binaries are
+// keyed by a hash of the GL vendor, renderer and version and of the stage
+// sources after #define injection and the attribute bindings, so a driver
+// update or an edited shader misses rather than loading a stale binary. A
+// binary the driver rejects is rebuilt from source and replaced.
+class ProgramCache {
+public:
+    // An empty directory compiles every time
+    explicit ProgramCache(std::string directory = "");
+
+    // $XDG_CACHE_HOME/gsplat/programs, else ~/.cache/gsplat/programs; empty
+    // when neither variable is set
+    static std::string defaultDirectory();
+
+    // attributes are bound to locations 0, 1, ... before linking. Returns 0,
+    // after printing the log, if a stage fails to compile or link.
+    GLuint build(const std::vector<ShaderStage>& stages, const std::vector<std::string>& attributes = {});
+
+    // Programs loaded from disk and built from source
+    size_t getHits() const { return hits; }
+    size_t getMisses() const { return misses; }
+
+private:
+    GLuint compileAndLink(const std::vector<ShaderStage>& stages, const std::vector<std::string>& attributes,
+                          bool retrievable);
+    GLuint loadBinary(const std::string& path, uint64_t key);
+    void saveBinary(GLuint program, const std::string& path, uint64_t key);
+
+    std::string directory;
+    // Set on first use: whether the driver offers any binary format
+    int binaryFormats;
+    size_t hits;
+    size_t misses;
+};
+
+} // namespace gsplat
@@ -1,48 +1,202 @@
 #pragma once
 
+#include <algorithm>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "glad/glad.h"
 
 #include "Camera.h"
+#include "FrameProfiler.h"
 #include "GaussianData.h"
+#include "SplatChunks.h"
+#include "SplatSort.h"
+#include "SplatTexture.h"
+#include "GpuSort.h"
+#include "IndexRing.h"
+#include "LodTree.h"
+#include "ProgramCache.h"
+#include "SceneInstances.h"
+#include "SortWorker.h"
+#include "SplatEditor.h"
 
 namespace gsplat {
 
 class Renderer {
 public:
-    Renderer(int width, int height);
+    // Linked shader programs are cached in programCacheDir; empty compiles
+    // them on every start
+    Renderer(int width, int height, const std::string& programCacheDir = ProgramCache::defaultDirectory());
     ~Renderer();
     
+    // The renderer keeps only the packed data and sort positions. Prefer the
+    // move overload; the copy overload copies just those.
+    void setGaussianData(GaussianData&& data);
     void setGaussianData(const GaussianData& data);
+    
+    // Progressive loading: size the splat texture for capacity splats up
+    // front, then append chunks as they arrive. Each chunk is uploaded with
+    // sub-image updates and drawn from the next frame on.
+    void reserveSplats(size_t capacity);
+    void appendGaussianData(const GaussianData& chunk);
+    const GaussianData& getGaussianData() const { return gaussianData; }
+    const SplatTexture& getSplatTexture() const { return splatTexture; }
+    
+    // Composition: append data to the shared splat store as a new instance
+    // drawn under transform, sorted together with every other instance and
+    // drawn in the same call. setGaussianData makes its scene instance 0 and
+    // appendGaussianData grows the last instance. Compressed scenes are
+    // padded to a chunk boundary first. Returns the instance's index.
+    size_t addInstance(const GaussianData& data, const glm::mat4& transform = glm::mat4(1.0f));
+    // Only the instance table and the CPU sort's world positions change; no
+    // splat is re-packed or re-uploaded. Not while a LOD tree is set.
+    void setInstanceTransform(size_t instance, const glm::mat4& transform);
+    // Hidden instances are still sorted, but dropped before rasterization
+    void setInstanceVisible(size_t instance, bool visible);
+    size_t getInstanceCount() const { return instances.size(); }
+    const SplatInstance& getInstance(size_t instance) const { return instances.get(instance); }
+    
+    // Editing. Shapes select by splat center in world space, so instances
+    // are selected where they are drawn. Edits rewrite the selected splats'
+    // packed words in place, and the next render uploads only the texture
+    // rows that changed. Selecting is not supported while a LOD tree is set.
+    size_t select(const SelectionShape& shape, SelectionMode mode = SelectionMode::Replace);
+    size_t clearSelection() { return editor.clearSelection(); }
+    size_t invertSelection() { return editor.invertSelection(); }
+    size_t getSelectedCount() const { return editor.getSelectedCount(); }
+    // Deleted splats stay in the store and the sort, but are never drawn again
+    size_t deleteSelected() { return editor.deleteSelected(); }
+    size_t hideSelected() { return editor.hideSelected(); }
+    size_t unhideAll() { return editor.unhideAll(); }
+    size_t recolorSelected(const glm::u8vec3& color) { return editor.recolorSelected(color); }
+    // Edits are in getGaussianData() from then on, selection flags included
+    bool isEdited() const { return editor.hasEdits(); }
+    
+    // Bytes of splat data sent to the texture per frame (0 = everything at
+    // once). Splats are drawn as soon as they are resident, so a large scene
+    // fills in over a few frames instead of stalling the first one.
+    void setUploadBudget(size_t bytes) { uploadBudget = bytes; }
+    bool isUploadPending() const { return splatCount < gaussianData.count(); }
+    
+    // Waits for a running background sort so its buffers can be inspected
+    void reportMemory(MemoryReport& report);
     void render(Camera& camera);
     void resize(int width, int height);
     
+    // Splats resident in the texture and drawn
     size_t getSplatCount() const { return splatCount; }
+    // Splats drawn by the last render: those left after culling, out of the
+    // LOD cut when a tree is set
+    size_t getDrawCount() const { return drawCount; }
+    
+    // Drop splats outside the view frustum while sorting, so only visible
+    // ones are sorted, uploaded and drawn. CPU sort backends only.
+    void setCulling(bool enabled);
+    bool isCulling() const { return sortContext.isCulling(); }
+    
+    // Cull and order whole chunks of the resident splats before sorting
+    // within them; the order is the same either way. CPU sort backends only,
+    // and not for LOD cuts.
+    void setChunkedSort(bool enabled);
+    bool isChunkedSort() const { return chunkedSort; }
+    // Bounds of the resident splats' chunks, kept current as splats arrive
+    const SplatChunks& getChunks() const { return chunks; }
+    
+    // Draw a cut through tree instead of every splat. The scene must be the
+    // one LodTree::build reordered, drawn as a single untransformed instance;
+    // the next setGaussianData, append or addInstance drops the tree. Cuts are sorted on the CPU on the render thread, so GPU and
+    // async sorting are not used while a tree is set.
+    void setLodTree(LodTree&& tree);
+    bool hasLodTree() const { return !lodTree.empty(); }
+    // Projected radius in pixels above which a node is refined, and the most
+    // splats a cut may hold (0 = no limit)
+    void setLodError(float pixels) { lodError = pixels; }
+    void setLodBudget(size_t splats) { lodBudget = splats; }
+    
+    void setSortKeyBits(SortKeyBits bits) { sortContext.setKeyBits(bits); }
+    // Pool shared by CPU-side work such as sorting; must outlive the renderer
+    void setThreadPool(ThreadPool* pool) { sortContext.setThreadPool(pool); editor.setThreadPool(pool); }
+    void setSimdLevel(SimdLevel level) { sortContext.setSimdLevel(level); }
+    // Camera rotation (degrees) up to which the previous order is refined instead of re-sorted
+    void setResortAngle(float degrees) { sortContext.setRefineAngle(degrees); }
+    
+    // Sort on a background thread and draw with the newest finished order
+    void setAsyncSort(bool enabled);
+    bool isAsyncSort() const { return asyncSort; }
+    // Start sorting for the view the next render() draws, so the sort runs
+    // while this frame is drawn and read back. That render waits for exactly
+    // this order instead of drawing a stale one; a different view there
+    // falls back to the usual async behavior. No-op without async sorting.
+    void queueSort(Camera& next);
+    // How many frames old the order used by the last render is
+    uint64_t getSortLatency() const { return sortLatency; }
+    
+    // Throws if the GPU backend is requested on a context older than OpenGL 4.3.
+    // The GPU backend always sorts synchronously, so async sort is ignored.
+    void setSortBackend(SortBackend backend);
+    SortBackend getSortBackend() const { return gpuSort ? SortBackend::Gpu : SortBackend::Cpu; }
+    // Compare every new GPU order with SplatSort::sort and report differences (slow)
+    void setValidateSort(bool enabled) { validateSort = enabled; }
+    // GPU orders compared so far, and how many of them differed
+    size_t getValidatedSorts() const { return validatedSorts; }
+    size_t getMismatchedSorts() const { return mismatchedSorts; }
+    
+    // Per-phase CPU and GPU timings of render(); disabled until enabled here
+    FrameProfiler& getProfiler() { return profiler; }
+    
+    // Highest harmonic degree evaluated, up to what the scene has. Lower
+    // degrees read fewer texels per splat; 0 draws the baked base color.
+    void setShDegree(int degree);
+    int getShDegree() const { return std::min(shDegreeLimit, gaussianData.shDegree); }
+    
+    // Saturation, white point and sharpening after blending each splat, as
+    // the viewer has always drawn (default). Off selects a shader variant
+    // that writes the splat color unchanged, with no post-processing cost.
+    void setPostProcess(bool enabled);
+    bool isPostProcess() const { return postProcess; }
+    const ProgramCache& getProgramCache() const { return programCache; }
 
 private:
-    void initShaders();
+    // Shader variant for the current data and harmonic degree
+    std::string shaderDefines() const;
+    // (Re)build the splat program with defines, if they changed
+    void initShaders(const std::string& defines);
     void initBuffers();
-    void updateTextures();
-    void sortSplats(const glm::mat4& viewProj);
-    
-    GLuint compileShader(GLenum type, const char* source);
-    GLuint createProgram(const char* vertexSource, const char* fragmentSource);
+    // After splats were appended to gaussianData: shaders, texture, upload
+    // and sort state
+    void storeGrew();
+    void growTexture(size_t capacity);
+    // Positions the sorts read: world positions when instances are placed
+    const SoAPositions& sortPositions() const;
+    bool uploadPending();
+    bool sortSplats(const glm::mat4& viewProj);
+    bool sortLodCut(const Camera& camera);
+    void restartSortWorker();
+    void validateGpuOrder(const glm::mat4& viewProj);
     
     int width, height;
     
     // Shader program
+    ProgramCache programCache;
     GLuint program;
+    std::string programDefines;
     GLint u_projection, u_view, u_focal, u_viewport;
-    GLint u_texture;
+    GLint u_texture, u_chunks, u_sh, u_instances, u_cameraPosition;
+    int shDegreeLimit;
+    bool postProcess;
     
     // Textures
-    GLuint splatTexture;
+    SplatTexture splatTexture;
+    size_t uploadBudget;
     
     // Buffers
     GLuint vao;
     GLuint positionVBO;
     GLuint indexVBO;
+    // Persistently mapped index stream; null without buffer storage, in which
+    // case orders are uploaded to indexVBO
+    std::unique_ptr<IndexRing> indexRing;
     // Cached attribute locations
     GLint a_position = -1;
     GLint a_index = -1;
@@ -50,10 +204,43 @@ private:
     // Gaussian data
     GaussianData gaussianData;
     std::vector<uint32_t> depthIndex;
+    SplatSortContext sortContext;
+    SplatChunks chunks;
+    bool chunkedSort;
+    SceneInstances instances;
+    SplatEditor editor;
+    
+    // Background sorting
+    std::unique_ptr<SortWorker> sortWorker;
+    bool asyncSort;
+    // Set until the worker delivers its first order
+    bool awaitOrder;
+    // Frame and view of the sort queueSort posted ahead; frame 0 for none
+    uint64_t queuedFrame;
+    glm::mat4 queuedViewProj;
+    uint64_t frameIndex;
+    uint64_t sortedFrame;
+    uint64_t sortLatency;
+    
+    // GPU sorting; when set, the order lives in gpuSort's index buffer
+    std::unique_ptr<GpuSort> gpuSort;
+    bool validateSort;
+    size_t validatedSorts;
+    size_t mismatchedSorts;
+    // Prefix of gaussianData that is uploaded, sorted and drawn
     size_t splatCount;
+    size_t drawCount;
+    
+    // Level of detail. lodCut is the cut drawn, nextCut the one just
+    // selected; the cut's positions are gathered for the sort.
+    LodTree lodTree;
+    float lodError;
+    size_t lodBudget;
+    std::vector<uint32_t> lodCut;
+    std::vector<uint32_t> nextCut;
+    SoAPositions cutPositions;
     
-    // Texture dimensions
-    int textureWidth, textureHeight;
+    FrameProfiler profiler;
 };
 
 } // namespace gsplat
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace gsplat {
+
+// One scene of a composition and where it is placed
+struct ScenePlacement {
+    // Resolved against the composition file's directory
+    std::string path;
+    glm::mat4 transform;
+    bool visible;
+};
+
+// Compositions: a JSON array of objects with file and, optionally,
+// translation [x, y, z], rotation as a [w, x, y, z] quaternion, uniform
+// scale and visible. The transform scales, then rotates, then translates.
+// Errors throw std::runtime_error.
+class SceneComposition {
+public:
+    // By the .json extension, case-insensitive
+    static bool isComposition(const std::string& path);
+
+    static std::vector<ScenePlacement> load(const std::string& path);
+};
+
+} // namespace gsplat
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+
+#include "GaussianData.h"
+
+namespace gsplat {
+
+class ThreadPool;
+
+// Scene file layouts the viewer reads and the converter writes
+enum class SceneFormat {
+    Ply,     // 3DGS training output, float attributes
+    Splat,   // 32 bytes per splat: float position and scale, RGBA8, rotation as 4 bytes
+    KSplat,  // GaussianSplats3D section layout; compression levels 0 to 2 are read, 0 is written
+    Spz      // Niantic fixed-point layout, read and written without the gzip wrapper
+};
+
+const char* sceneFormatName(SceneFormat format);
+
+// Largest per-attribute difference between two loads of the same scene
+struct SceneDifference {
+    bool sameCount = true;
+    float position = 0.0f;   // World units
+    float scale = 0.0f;      // Relative
+    float rotation = 0.0f;   // Degrees
+    int color = 0;           // Of 255
+    int alpha = 0;
+    float harmonics = 0.0f;  // Over the bands both loads kept
+
+    // Whether every attribute is within tolerance's; NaN never is
+    bool within(const SceneDifference& tolerance) const;
+};
+
+// Loads and writes the scene formats other than the training PLY, which go
+// straight into GaussianData's source attributes, harmonics included (.splat
+// has none; .ksplat is written with at most 2 bands). Errors throw
+// std::runtime_error.
+class SceneFile {
+public:
+    // By file magic where the format has one (PLY, SPZ), otherwise by
+    // extension. Throws if neither identifies the file.
+    static SceneFormat detect(const std::string& path);
+    // .ply, .splat, .ksplat or .spz, case-insensitive
+    static bool formatFromExtension(const std::string& path, SceneFormat& format);
+
+    // Same contract as PLYLoader::load, for any detected format
+    static GaussianData load(const std::string& path, ThreadPool* pool = nullptr, bool keepSource = false,
+                             const SplatLayout& layout = SplatLayout(), bool spatialOrder = false);
+
+    // Write data's source attributes, which must be present
+    static void write(const std::string& path, const GaussianData& data, SceneFormat format);
+
+    // Compare the source attributes of two loads
+    static SceneDifference compare(const GaussianData& a, const GaussianData& b);
+    // Largest difference writing data in format and loading it back can
+    // introduce: the format's quantization plus float rounding. Scales past
+    // .spz's byte range are clamped and exceed it.
+    static SceneDifference roundTripTolerance(const GaussianData& data, SceneFormat format);
+};
+
+} // namespace gsplat
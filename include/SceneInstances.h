@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+
+#include "GaussianData.h"
+#include "MemoryReport.h"
+
+namespace gsplat {
+
+// A scene placed in the shared splat store: splats [first, first + count)
+// drawn under transform
+struct SplatInstance {
+    size_t first = 0;
+    size_t count = 0;
+    glm::mat4 transform = glm::mat4(1.0f);
+    bool visible = true;
+};
+
+// The scenes sharing the renderer's splat store, each a contiguous range
+// with its own model transform. Splats stay packed in their scene's space;
+// moving or hiding an instance rewrites its row of a small table texture the
+// shaders read, and the world positions the CPU sort reads, never the
+// splat data.
+//
+// Harmonics are evaluated for the view direction rotated back by the
+// transpose of the transform, which is exact for rotations with uniform
+// scale. Splats between instances (chunk padding) are never drawn.
+class SceneInstances {
+public:
+    SceneInstances();
+    ~SceneInstances();
+
+    SceneInstances(const SceneInstances&) = delete;
+    SceneInstances& operator=(const SceneInstances&) = delete;
+
+    void clear();
+    // Returns the new instance's index
+    size_t add(size_t first, size_t count, const glm::mat4& transform = glm::mat4(1.0f));
+    // Grow the last instance so it ends at end, for splats streamed into it
+    void extendLast(size_t end);
+    void setTransform(size_t instance, const glm::mat4& transform);
+    void setVisible(size_t instance, bool visible);
+
+    size_t size() const { return instances.size(); }
+    const SplatInstance& get(size_t instance) const { return instances[instance]; }
+
+    // Whether anything differs from a single untransformed scene; only then
+    // do the shaders and the sort need the table and world positions
+    bool isComposite() const;
+
+    // Bring the world positions up to date with local, the store's positions:
+    // new splats and moved instances are transformed. Released again when
+    // the instances are not composite.
+    void updatePositions(const SoAPositions& local);
+    // World positions of the splats; empty unless composite
+    const SoAPositions& getPositions() const { return world; }
+
+    // RGBA32UI, one row per instance: the transform's first three rows as
+    // float bits, then first, count and visibility. Uploaded here when
+    // changed; needs the context current.
+    GLuint getTexture();
+
+    void reportMemory(MemoryReport& report) const;
+
+private:
+    std::vector<SplatInstance> instances;
+    // Instances whose world positions are stale below transformed
+    std::vector<bool> moved;
+    SoAPositions world;
+    size_t transformed;
+
+    GLuint texture;
+    int textureRows;
+    bool tableDirty;
+};
+
+} // namespace gsplat
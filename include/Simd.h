@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+// Runtime-dispatched x86 kernels rely on GCC/Clang target attributes
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GSPLAT_X86_KERNELS 1
+#endif
+
+namespace gsplat {
+
+// Instruction sets with hand-written kernels, in increasing order
+enum class SimdLevel {
+    Scalar,
+    SSE41,
+    AVX2,
+    AVX512
+};
+
+// Best level supported by both this build and the running CPU
+SimdLevel detectSimdLevel();
+
+const char* simdLevelName(SimdLevel level);
+
+// Accepts the names printed by simdLevelName (case-insensitive) and "auto"
+bool parseSimdLevel(const std::string& name, SimdLevel& level);
+
+} // namespace gsplat
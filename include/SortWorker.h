@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "MemoryReport.h"
+
+namespace gsplat {
+
+// Runs the depth sort on a dedicated thread. The renderer posts the latest
+// view-projection every frame and picks up the newest finished order without
+// waiting for it. Orders move between three buffers: the one the worker is
+// writing, the last completed one, and the one the renderer is drawing with.
+class SortWorker {
+public:
+    // Returns false when the previous order is still exact and depthIndex was not written
+    using SortJob = std::function<bool(const glm::mat4& viewProj, std::vector<uint32_t>& depthIndex)>;
+
+    explicit SortWorker(SortJob job);
+    ~SortWorker();
+
+    SortWorker(const SortWorker&) = delete;
+    SortWorker& operator=(const SortWorker&) = delete;
+
+    // Queue a sort for this view. A request that has not started yet is replaced.
+    void request(const glm::mat4& viewProj, uint64_t frame);
+
+    // Swap the newest completed order into depthIndex. Returns false if nothing
+    // new finished since the last fetch, unless wait is set, in which case it
+    // blocks until a result is available. frame is set to the newest request
+    // the order in use is exact for, even when no new order was produced.
+    bool fetch(std::vector<uint32_t>& depthIndex, uint64_t& frame, bool wait = false);
+    
+    // Wait until no sort is running, add the worker's buffers to report, and
+    // call inspect while the job is guaranteed to stay idle
+    void reportMemory(MemoryReport& report, const std::function<void()>& inspect = nullptr);
+
+private:
+    void run();
+
+    SortJob job;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable requestCv;
+    std::condition_variable resultCv;
+
+    bool stopping;
+    bool hasRequest;
+    bool hasResult;
+    bool busy;
+
+    glm::mat4 pendingViewProj;
+    uint64_t pendingFrame;
+
+    std::vector<uint32_t> working;
+    std::vector<uint32_t> ready;
+    uint64_t completedFrame;
+};
+
+} // namespace gsplat
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+
+#include "GaussianData.h"
+
+namespace gsplat {
+
+// Binary cache of a packed scene, so later starts skip PLY parsing and
+// packing. The file stores packedData in texture layout, the sort positions,
+// the chunk data of compressed splats, the packed harmonics and the bounds,
+// each section page-aligned, and is read through mmap. Loading copies the
+// sections into the GaussianData vectors, which the renderer edits and
+// appends to, releasing the mapped pages as it goes so the scene is not
+// held twice.
+//
+// A cache belongs to one source file: it is reused when the source size
+// matches and either its modification time or a hash of its whole content
+// does; the hash is only computed when the modification time differs.
+class SplatCache {
+public:
+    // Bump whenever the packed layout or the loader's conversions change
+    static constexpr uint32_t kVersion = 6;
+    
+    // Cache file used for sourcePath: next to it, with a .gsplatcache suffix
+    static std::string pathFor(const std::string& sourcePath);
+    
+    // Fill data from the cache if it is valid for sourcePath and was written
+    // for layout. Returns false, leaving data untouched, when the cache is
+    // missing, stale, corrupt or in another layout.
+    static bool load(const std::string& cachePath, const std::string& sourcePath, const SplatLayout& layout,
+                     GaussianData& data);
+    
+    // Write data, loaded with layout, as the cache of sourcePath. Returns
+    // false (after logging) on failure; the cache is written to a temporary
+    // file and renamed into place.
+    static bool write(const std::string& cachePath, const std::string& sourcePath, const SplatLayout& layout,
+                      const GaussianData& data);
+};
+
+} // namespace gsplat
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "GaussianData.h"
+#include "MemoryReport.h"
+
+namespace gsplat {
+
+// Axis-aligned bounds of the splat centers in one chunk
+struct ChunkBounds {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// Bounds of each run of kSplatChunkSize consecutive splats, the same runs
+// compressed splats are quantized over. After GaussianData::sortSpatially
+// every run is a compact region, so the sort can cull and depth-order whole
+// chunks with one test each; any order stays correct, just less effective.
+class SplatChunks {
+public:
+    // Bring the bounds up to date with the first count positions. Complete
+    // chunks already covered are kept, so appending only visits new splats;
+    // clear() first when positions were replaced.
+    void update(const SoAPositions& positions, size_t count);
+    // Recompute the covered chunks overlapping splats [first, last), whose
+    // positions changed in place
+    void refresh(const SoAPositions& positions, size_t first, size_t last);
+    void clear();
+    
+    size_t chunkCount() const { return bounds.size(); }
+    // Splats the bounds cover
+    size_t splatCount() const { return covered; }
+    const std::vector<ChunkBounds>& getBounds() const { return bounds; }
+    
+    void reportMemory(MemoryReport& report) const;
+
+private:
+    void computeChunk(const SoAPositions& positions, size_t chunk, size_t count);
+    
+    std::vector<ChunkBounds> bounds;
+    size_t covered = 0;
+};
+
+} // namespace gsplat
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "GaussianData.h"
+#include "MemoryReport.h"
+
+namespace gsplat {
+
+class ThreadPool;
+
+// A region of space splats are selected by, tested against their centers
+struct SelectionShape {
+    enum class Type { Box, Sphere, Brush };
+    Type type = Type::Sphere;
+    // Box: world to box space, inside where every coordinate is within [-1, 1]
+    glm::mat4 worldToBox = glm::mat4(1.0f);
+    // Sphere: world space. Brush: radius in pixels.
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+    // Brush: splats in front of the camera whose center projects within
+    // radius of pixel, in window pixels from the top left
+    glm::mat4 viewProj = glm::mat4(1.0f);
+    glm::vec2 viewport = glm::vec2(0.0f);
+    glm::vec2 pixel = glm::vec2(0.0f);
+
+    static SelectionShape box(const glm::vec3& min, const glm::vec3& max);
+    static SelectionShape orientedBox(const glm::mat4& worldToBox);
+    static SelectionShape sphere(const glm::vec3& center, float radius);
+    static SelectionShape brush(const glm::mat4& viewProj, const glm::vec2& viewport, const glm::vec2& pixel,
+                                float radius);
+};
+
+enum class SelectionMode {
+    Replace,   // Exactly the splats inside
+    Add,
+    Subtract
+};
+
+// Selection and edits of packed splats in place. Whether a splat is selected
+// is the flag in its packed words: bit 0 of word 3 for full splats, bit 31 of
+// word 2 (above the quantized rotation and scale) for compressed ones. The
+// vertex shader tints selected splats and skips those with zero alpha, which
+// is how deleted and hidden splats are stored; hidden ones keep their color
+// here to be restored.
+//
+// Every pass runs on the thread pool in blocks of whole texture rows and
+// records the rows whose words changed, so an edit re-sends those rows
+// instead of the scene. Deleted and hidden splats cannot be selected.
+class SplatEditor {
+public:
+    explicit SplatEditor(GaussianData& data);
+
+    void setThreadPool(ThreadPool* pool) { this->pool = pool; }
+    // Forget hidden colors, dirty rows and the count, for a new scene
+    void reset();
+
+    // Select by the splats' positions, one per splat of the data (world
+    // positions for placed instances). Each returns the selected count.
+    size_t select(const SoAPositions& positions, const SelectionShape& shape, SelectionMode mode);
+    size_t clearSelection();
+    size_t invertSelection();
+    size_t getSelectedCount() const { return selected; }
+
+    // Edits of the selected splats; each returns how many splats changed
+    size_t deleteSelected();
+    // Hidden splats leave the selection, like deleted ones
+    size_t hideSelected();
+    size_t unhideAll();
+    // Replace the base color and keep alpha; harmonics still add to it
+    size_t recolorSelected(const glm::u8vec3& color);
+    // Whether any packed word changed since the last reset
+    bool hasEdits() const { return edited; }
+
+    // Splat ranges [first, last) of the texture rows changed since the last
+    // call, merged into runs
+    std::vector<std::pair<size_t, size_t>> takeDirtyRanges();
+
+    void reportMemory(MemoryReport& report) const;
+
+private:
+    // Call edit(words, i) for every splat, which returns whether it changed
+    // the splat; counts the selection afterwards
+    template <typename Edit>
+    size_t apply(const Edit& edit);
+    size_t splatsPerRow() const;
+
+    GaussianData& data;
+    ThreadPool* pool;
+    size_t selected;
+    bool edited;
+    // Per splat, the color a hidden splat had; 0 for the rest, as a splat
+    // is only hidden with nonzero alpha. Empty while nothing is hidden.
+    std::vector<uint32_t> hiddenColors;
+    // Per texture row of the splat texture
+    std::vector<uint8_t> dirtyRows;
+};
+
+} // namespace gsplat
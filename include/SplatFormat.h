@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+
+namespace gsplat {
+
+// GPU layout of GaussianData::packedData
+enum class SplatFormat {
+    Full,        // 32 bytes: float position, half covariance, RGBA8
+    Compressed   // 16 bytes: chunk-relative position, quantized rotation and scale, RGBA8
+};
+
+// Compressed splats are quantized against the bounds of consecutive runs of this many
+constexpr size_t kSplatChunkSize = 256;
+// uint32 words per chunk in GaussianData::chunkData: four xyz0 texels
+constexpr size_t kChunkWords = 16;
+
+// uint32 words per splat in packedData
+inline size_t splatWords(SplatFormat format) {
+    return format == SplatFormat::Compressed ? 4 : 8;
+}
+
+// Storage of the spherical harmonic coefficients past DC in GaussianData::shData
+enum class ShFormat {
+    Half,   // 16-bit floats
+    Byte    // 8 bits each against a per-splat half-float range
+};
+
+constexpr int kMaxShDegree = 3;
+constexpr size_t kMaxShCoefficients = 15;
+
+// Coefficients per color channel beyond the DC term
+inline size_t shCoefficients(int degree) {
+    return degree > 0 ? static_cast<size_t>((degree + 1) * (degree + 1) - 1) : 0;
+}
+
+// RGBA32UI texels per splat in shData; a splat may straddle a texture row
+inline size_t shTexels(int degree, ShFormat format) {
+    size_t values = 3 * shCoefficients(degree);
+    if (values == 0) return 0;
+    // The byte layout starts with the range as a half
+    return format == ShFormat::Byte ? (2 + values + 15) / 16 : (values + 7) / 8;
+}
+
+// Everything a loader needs to know to pack a scene
+struct SplatLayout {
+    SplatFormat format = SplatFormat::Full;
+    // Highest harmonic degree kept; files with fewer bands keep what they have
+    int shDegree = kMaxShDegree;
+    ShFormat shFormat = ShFormat::Half;
+};
+
+inline bool operator==(const SplatLayout& a, const SplatLayout& b) {
+    return a.format == b.format && a.shDegree == b.shDegree && a.shFormat == b.shFormat;
+}
+
+inline bool operator!=(const SplatLayout& a, const SplatLayout& b) {
+    return !(a == b);
+}
+
+} // namespace gsplat
@@ -1,17 +1,196 @@
 #pragma once
 
+#include <functional>
+#include <utility>
 #include <vector>
 #include <cstdint>
 
 #include "glm/glm.hpp"
 
+#include "DepthKeys.h"
+#include "MemoryReport.h"
+#include "Simd.h"
+#include "SplatChunks.h"
+
 namespace gsplat {
 
+class ThreadPool;
+
+// How the last call to SplatSortContext::sort produced its order
+enum class SortPath {
+    Skipped,      // Depth axis unchanged, previous order still exact
+    Incremental,  // Previous order refined with a bounded insertion sort
+    Full          // Radix sort from scratch
+};
+
+// Width of the quantized depth key used by the radix sort
+enum class SortKeyBits {
+    Bits16 = 16,  // Single counting pass, depth quantized over the frame's range
+    Bits32 = 32   // Three passes, exact ordering of the float depth
+};
+
+// Stateful depth sorter. Scratch buffers are kept between frames so the
+// per-frame sort does not allocate once the splat count has settled.
+//
+// With a thread pool, key computation and every radix pass are split into
+// contiguous blocks. Per-block histograms are prefixed digit-major then
+// block-minor, so the scatter stays stable and the output is identical
+// for any thread count.
+//
+// Consecutive frames are exploited: the order depends only on the direction
+// of the depth axis, so camera translation alone never re-sorts. Small
+// rotations refine the previous order, larger ones sort from scratch.
+//
+// With culling, splats outside the frustum splat.vert draws are dropped
+// while the keys are computed, and only the visible ones are sorted and
+// written. The visible set depends on the whole view, so only an unchanged
+// view-projection skips the sort. A refine covers the splats visible in both
+// views; those that came into view are sorted on their own and merged in.
+//
+// With chunks, 32-bit keys are computed chunk by chunk: chunks wholly
+// outside the frustum are skipped, wholly inside ones need no per-splat
+// test. Chunks are then grouped into clusters whose depth ranges overlap;
+// clusters are disjoint in depth, so each is radix sorted on its own and
+// they are concatenated near to far. The order equals the unchunked one.
+// Keys are laid out in cluster order, so a refine maps the previous order
+// through the visible splats as with culling.
+class SplatSortContext {
+public:
+    explicit SplatSortContext(SortKeyBits keyBits = SortKeyBits::Bits32);
+
+    void setKeyBits(SortKeyBits bits) { keyBits = bits; }
+    SortKeyBits getKeyBits() const { return keyBits; }
+
+    // nullptr sorts on the calling thread only
+    void setThreadPool(ThreadPool* pool) { threadPool = pool; }
+
+    // Defaults to the best level the CPU supports; all levels give identical keys
+    void setSimdLevel(SimdLevel level) { simdLevel = level; }
+    SimdLevel getSimdLevel() const { return simdLevel; }
+
+    // Rotation of the depth axis, in degrees, up to which the previous order is
+    // refined instead of re-sorted. 0 always sorts from scratch.
+    void setRefineAngle(float degrees) { refineAngle = degrees; }
+    float getRefineAngle() const { return refineAngle; }
+    
+    void setCulling(bool enabled) { culling = enabled; }
+    bool isCulling() const { return culling; }
+    // Indices the last sort produced; vertexCount without culling
+    uint32_t getVisibleCount() const { return visibleCount; }
+    
+    // Bounds of the positions passed to sort, or nullptr. Only used while
+    // they cover exactly vertexCount splats and keys are 32-bit.
+    void setChunks(const SplatChunks* splatChunks) { chunks = splatChunks; }
+    // Depth-disjoint groups of chunks the last chunked sort produced
+    uint32_t getClusterCount() const { return static_cast<uint32_t>(clusters.size()); }
+
+    // Forget the previous order, e.g. after the positions changed in place
+    void reset();
+
+    // Positions are structure-of-arrays x/y/z. Returns false when the previous
+    // order is still exact, in which case depthIndex is left untouched.
+    // depthIndex is resized to the visible count.
+    bool sort(
+        const glm::mat4& viewProj,
+        const float* x,
+        const float* y,
+        const float* z,
+        uint32_t vertexCount,
+        std::vector<uint32_t>& depthIndex
+    );
+    
+    // Same, writing getVisibleCount() indices to out, which must have room
+    // for vertexCount, e.g. a mapped GPU buffer
+    bool sort(
+        const glm::mat4& viewProj,
+        const float* x,
+        const float* y,
+        const float* z,
+        uint32_t vertexCount,
+        uint32_t* out
+    );
+
+    SortPath getLastPath() const { return lastPath; }
+    
+    void reportMemory(MemoryReport& report) const;
+
+private:
+    // Bring order up to date; false when the previous one is still exact
+    bool updateOrder(const glm::mat4& viewProj, const float* x, const float* y, const float* z,
+                     uint32_t vertexCount);
+    void writeOrder(uint32_t* out);
+    uint32_t blockCount(uint32_t vertexCount) const;
+    void forEachBlock(uint32_t blocks, const std::function<void(uint32_t)>& fn);
+    // Keys of the visible splats, packed to the front; sets visibleCount
+    void computeKeys(const glm::mat4& viewProj, const DepthAxis& axis, const float* x, const float* y,
+                     const float* z, uint32_t vertexCount);
+    void cullKeys(const glm::mat4& viewProj, const DepthAxis& axis, const float* x, const float* y,
+                  const float* z, uint32_t vertexCount);
+    // Keys of the visible splats, cluster by cluster; sets visibleCount and clusters
+    void chunkKeys(const glm::mat4& viewProj, const DepthAxis& axis, const float* x, const float* y,
+                   const float* z, uint32_t vertexCount);
+    bool refineOrder(uint32_t vertexCount);
+    // Refine for culled or chunked keys; leaves order as positions in visible
+    bool refineVisible(uint32_t vertexCount);
+    // Sort keys [first, first + count) into out, as positions from first
+    void radixSort(uint32_t first, uint32_t count, uint32_t* out);
+    void sortClusters(uint32_t* out);
+
+    SortKeyBits keyBits;
+    ThreadPool* threadPool;
+    SimdLevel simdLevel;
+    float refineAngle;
+    bool culling;
+    const SplatChunks* chunks;
+    SortPath lastPath;
+    uint32_t visibleCount;
+
+    // Previous frame, for temporal coherence. Splat indices near to far,
+    // whichever way the keys were laid out.
+    std::vector<uint32_t> order;
+    bool hasPrevious;
+    DepthAxis prevAxis;
+    const float* prevX;
+    uint32_t prevCount;
+    SortKeyBits prevKeyBits;
+    bool prevCulling;
+    bool prevChunked;
+    glm::mat4 prevViewProj;
+
+    // Scratch buffers reused across frames
+    std::vector<float> depths;
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> keysScratch;
+    std::vector<uint32_t> indexScratch;
+    std::vector<uint32_t> histogram;
+    std::vector<float> blockMin;
+    std::vector<float> blockMax;
+    std::vector<uint8_t> blockOk;
+    // With culling: splat index of each visible key, and visible splats per block
+    std::vector<uint32_t> visible;
+    std::vector<uint32_t> blockVisible;
+    // While refining culled keys: position of each splat in visible, and the
+    // positions of splats that came into view
+    std::vector<uint32_t> slots;
+    std::vector<uint32_t> entering;
+    // With chunks: per chunk visible splats and depth range, the chunks with
+    // any visible in near-to-far cluster order, and each cluster's key range
+    std::vector<uint32_t> visibleScratch;
+    std::vector<uint32_t> chunkVisible;
+    std::vector<float> chunkMin;
+    std::vector<float> chunkMax;
+    std::vector<uint32_t> liveChunks;
+    std::vector<std::pair<uint32_t, uint32_t>> clusters;
+};
+
 class SplatSort {
 public:
+    // One-shot sort with 32-bit keys; prefer SplatSortContext for per-frame use
     static void sort(
         const glm::mat4& viewProj,
-        const float* positions,
+        const float* x,
+        const float* y,
+        const float* z,
         uint32_t vertexCount,
         std::vector<uint32_t>& depthIndex
     );
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "glad/glad.h"
+
+#include "GaussianData.h"
+
+namespace gsplat {
+
+// The splat data texture. Rows are 2048 RGBA32UI texels, matching
+// GaussianData::packedData, so rows are uploaded without any reshuffling:
+// a full splat takes 2 texels (1024 per row), a compressed one 1 (2048 per
+// row). Compressed data adds a chunk texture with 4 texels per chunk, and
+// harmonics a third texture with shTexels() consecutive texels per splat.
+//
+// Each is a 2D array texture of 2048-row layers, so a scene is not limited
+// by GL_MAX_TEXTURE_SIZE rows but by GL_MAX_ARRAY_TEXTURE_LAYERS, and texel
+// t is at column t & 2047, row (t >> 11) & 2047 and layer t >> 22 on every
+// device. Scenes of up to 2048 rows take a single layer of just those rows.
+//
+// Storage is immutable and sized for a capacity. Data is streamed through a
+// small ring of orphaned pixel buffer objects in bounded chunks, so large
+// uploads never need a staging copy of the scene and can be spread over
+// several frames.
+class SplatTexture {
+public:
+    static constexpr int kWidth = 2048;
+    static constexpr int kLayerRows = 2048;
+    
+    // Most splats in layout the device's array textures hold, harmonics
+    // included; needs a current context
+    static size_t maxSplats(const SplatLayout& layout);
+    
+    SplatTexture();
+    ~SplatTexture();
+    
+    SplatTexture(const SplatTexture&) = delete;
+    SplatTexture& operator=(const SplatTexture&) = delete;
+    
+    // Recreate the textures with room for capacity splats in layout (with
+    // the data's actual harmonic degree). Contents are undefined until
+    // uploaded. Throws past maxSplats.
+    void allocate(size_t capacity, const SplatLayout& layout);
+    
+    // Copy splats [first, last) of data, which must be in the allocated
+    // layout, stopping once maxBytes have been sent (0 = no limit), harmonics
+    // included. At least one chunk is always sent. Returns the number of
+    // splats uploaded, a prefix of the range.
+    size_t upload(const GaussianData& data, size_t first, size_t last, size_t maxBytes = 0);
+    // Re-send the packed words of splats [first, last) after an edit;
+    // harmonics and chunks are left as they are
+    void update(const GaussianData& data, size_t first, size_t last);
+    
+    GLuint getTexture() const { return texture; }
+    // 0 unless the format is compressed
+    GLuint getChunkTexture() const { return chunkTexture; }
+    // 0 without harmonics
+    GLuint getShTexture() const { return shTexture; }
+    SplatFormat getFormat() const { return layout.format; }
+    const SplatLayout& getLayout() const { return layout; }
+    size_t getCapacity() const { return capacity; }
+    // Layers and rows of the splat texture and the device limit, for startup
+    std::string describe() const;
+    
+    // Splat and chunk textures
+    size_t textureBytes() const;
+    size_t shTextureBytes() const;
+    size_t stagingBytes() const;
+
+private:
+    // Rows per layer (all of them in a single layer) and layers of an array
+    struct Extent {
+        int rows = 0;
+        int layers = 0;
+    };
+    static Extent extentFor(size_t texels);
+    
+    // Upload texels [first, last) of data to tex, which holds kWidth texels
+    // per row; returns where it stopped
+    size_t uploadTexels(GLuint tex, const uint32_t* data, size_t first, size_t last, size_t maxBytes);
+    // Upload a rectangle of whole texels within one layer; texels are 4 uint32
+    void uploadRect(const uint32_t* data, int x, int y, int layer, int width, int rows);
+    
+    static constexpr int kPboCount = 3;
+    // Bound on a single transfer: 256 rows of 32 KB
+    static constexpr size_t kChunkBytes = 8u << 20;
+    
+    GLuint texture;
+    GLuint chunkTexture;
+    GLuint shTexture;
+    GLuint pbos[kPboCount];
+    int nextPbo;
+    SplatLayout layout;
+    size_t capacity;
+    Extent extent;
+    Extent chunkExtent;
+    Extent shExtent;
+};
+
+} // namespace gsplat
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <thread>
+
+#include "GaussianData.h"
+
+namespace gsplat {
+
+struct LoadProgress {
+    size_t loadedSplats;   // Parsed and packed so far
+    size_t totalSplats;    // 0 until the header has been read
+    uint64_t bytesRead;
+    uint64_t totalBytes;
+    double seconds;        // Since the load started
+    bool done;
+};
+
+// Loads a PLY file on a background thread in chunks of packed splats, so
+// the viewer can draw what has arrived while the rest is still loading.
+//
+// Binary little-endian files are parsed record by record straight from the
+// stream. Other layouts go through PLYLoader::load and arrive as one chunk.
+// Either way splats are put in spatial order within their chunk.
+class StreamingLoader {
+public:
+    static constexpr size_t kDefaultChunkSplats = 1 << 16;
+    
+    // Chunks are rounded up to whole kSplatChunkSize runs, so compressed ones
+    // can be appended and spatial order lines up with SplatChunks
+    explicit StreamingLoader(const std::string& path, size_t chunkSplats = kDefaultChunkSplats,
+                             const SplatLayout& layout = SplatLayout());
+    ~StreamingLoader();
+    
+    StreamingLoader(const StreamingLoader&) = delete;
+    StreamingLoader& operator=(const StreamingLoader&) = delete;
+    
+    // Move the oldest finished chunk into chunk. Returns false if none is
+    // ready; with wait set, blocks until one is or loading has ended.
+    // Rethrows a loading error as std::runtime_error.
+    bool poll(GaussianData& chunk, bool wait = false);
+    
+    // True once loading has ended and every chunk has been polled
+    bool isDone() const;
+    
+    LoadProgress getProgress() const;
+
+private:
+    void run();
+    bool streamBinary();
+    void publish(GaussianData&& chunk, uint64_t bytes);
+    
+    std::string path;
+    size_t chunkSplats;
+    SplatLayout layout;
+    std::chrono::steady_clock::time_point startTime;
+    
+    mutable std::mutex mutex;
+    std::condition_variable chunkCv;
+    std::deque<GaussianData> chunks;
+    std::string error;
+    bool finished;
+    std::atomic<bool> stopping;
+    
+    // Guarded by mutex
+    size_t loadedSplats;
+    size_t totalSplats;
+    uint64_t bytesRead;
+    uint64_t totalBytes;
+    double finishSeconds;
+    
+    std::thread thread;
+};
+
+} // namespace gsplat
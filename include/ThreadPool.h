@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gsplat {
+
+// Fixed set of worker threads for data-parallel loops. The calling thread
+// takes part in every batch, so a pool of size 1 has no background threads.
+class ThreadPool {
+public:
+    // threadCount 0 uses every hardware thread
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // Call task(i) for every i in [0, taskCount) and wait for all of them.
+    // Batches from different callers are serialized.
+    void run(uint32_t taskCount, const std::function<void(uint32_t)>& task);
+
+private:
+    void workerLoop();
+    void drain();
+
+    std::vector<std::thread> workers;
+
+    std::mutex runMutex;
+    std::mutex mutex;
+    std::condition_variable startCv;
+    std::condition_variable doneCv;
+
+    const std::function<void(uint32_t)>* current;
+    uint32_t taskCount;
+    std::atomic<uint32_t> nextTask;
+    unsigned pending;
+    uint64_t generation;
+    bool stopping;
+};
+
+} // namespace gsplat
@@ -18,36 +18,77 @@ inline std::string readFile(const std::string& path) {
     return buffer.str();
 }
 
-// Pack two 16-bit halfs into a 32-bit uint
+// Insert "#define NAME" lines right after the #version directive, for
+// shader variants compiled from one source. NAME=VALUE defines a value.
+inline std::string withDefines(const std::string& source, const std::string& names) {
+    std::string defines;
+    std::istringstream list(names);
+    std::string name;
+    while (list >> name) {
+        size_t equals = name.find('=');
+        if (equals != std::string::npos) {
+            name[equals] = ' ';
+        }
+        defines += "#define " + name + "\n";
+    }
+    size_t lineEnd = source.find('\n');
+    if (defines.empty() || lineEnd == std::string::npos) return source;
+    return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+}
+
+// Convert to half precision, rounding toward zero. Bit-identical to F16C's
+// vcvtps2ph with _MM_FROUND_TO_ZERO, so SIMD packing can use the instruction.
 inline uint16_t floatToHalf(float value) {
     // Avoid type-punning UB by using memcpy
     uint32_t f = 0;
     std::memcpy(&f, &value, sizeof(uint32_t));
-    uint32_t sign = (f >> 31) & 0x0001;
+    uint32_t sign = (f >> 16) & 0x8000;
     uint32_t exp = (f >> 23) & 0x00ff;
     uint32_t frac = f & 0x007fffff;
     
-    uint32_t newExp;
-    if (exp == 0) {
-        newExp = 0;
-    } else if (exp < 113) {
-        newExp = 0;
-        frac |= 0x00800000;
-        frac >>= (113 - exp);
-        if (frac & 0x01000000) {
-            newExp = 1;
-            frac = 0;
+    if (exp == 255) {
+        // Inf stays inf, NaN becomes a quiet NaN keeping the top payload bits
+        return static_cast<uint16_t>(sign | 0x7c00 | (frac ? 0x0200 | (frac >> 13) : 0));
+    }
+    if (exp > 142) {
+        // Beyond the half range: the largest finite half
+        return static_cast<uint16_t>(sign | 0x7bff);
+    }
+    if (exp >= 113) {
+        return static_cast<uint16_t>(sign | ((exp - 112) << 10) | (frac >> 13));
+    }
+    if (exp >= 103) {
+        // Subnormal half
+        return static_cast<uint16_t>(sign | ((frac | 0x00800000) >> (126 - exp)));
+    }
+    return static_cast<uint16_t>(sign);
+}
+
+// Exact widening of a half to float
+inline float halfToFloat(uint16_t half) {
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    uint32_t exp = (half >> 10) & 0x1f;
+    uint32_t frac = half & 0x03ff;
+    uint32_t f = sign;
+    if (exp == 31) {
+        f |= 0x7f800000 | (frac << 13);
+    } else if (exp != 0) {
+        f |= ((exp + 112) << 23) | (frac << 13);
+    } else if (frac != 0) {
+        // Subnormal half: normalize into the float exponent range
+        exp = 113;
+        while ((frac & 0x0400) == 0) {
+            frac <<= 1;
+            exp--;
         }
-    } else if (exp < 142) {
-        newExp = exp - 112;
-    } else {
-        newExp = 31;
-        frac = 0;
+        f |= (exp << 23) | ((frac & 0x03ff) << 13);
     }
-    
-    return (sign << 15) | (newExp << 10) | (frac >> 13);
+    float value;
+    std::memcpy(&value, &f, sizeof(float));
+    return value;
 }
 
+// Pack two 16-bit halfs into a 32-bit uint
 inline uint32_t packHalf2x16(float x, float y) {
     uint16_t hx = floatToHalf(x);
     uint16_t hy = floatToHalf(y);
@@ -57,7 +98,17 @@ inline uint32_t packHalf2x16(float x, float y) {
 // Spherical harmonics constant
 constexpr float SH_C0 = 0.28209479177387814f;
 
-// OpenGL error checking (defined in Renderer.cpp to avoid GL headers here)
+// OpenGL error checking (defined in Renderer.cpp to avoid GL headers here).
+// glGetError synchronizes with the driver, so it is only polled in builds
+// with the GSPLAT_GL_CHECKS option; use enableGLDebugOutput otherwise.
+#ifdef GSPLAT_GL_CHECKS
 void checkGLError(const char* context);
+#else
+inline void checkGLError(const char*) {}
+#endif
+
+// Report GL errors and warnings through an asynchronous debug-output
+// callback. False if the context has neither OpenGL 4.3 nor KHR_debug.
+bool enableGLDebugOutput();
 
 } // namespace gsplat
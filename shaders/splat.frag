@@ -5,6 +5,19 @@ in vec2 vPosition;
 
 out vec4 fragColor;
 
+#ifdef POST_PROCESS
+// Saturation (1.0 = original), white point (lower = brighter highlights) and
+// sharpening exponent; inject a define to override
+#ifndef POST_SATURATION
+#define POST_SATURATION 1.2
+#endif
+#ifndef POST_WHITE_POINT
+#define POST_WHITE_POINT 0.9
+#endif
+#ifndef POST_SHARPNESS
+#define POST_SHARPNESS 1.05
+#endif
+
 // Function to increase saturation
 vec3 adjustSaturation(vec3 color, float saturation) {
     const vec3 luminanceWeights = vec3(0.2126, 0.7152, 0.0722);
@@ -17,6 +30,7 @@ vec3 adjustWhitePoint(vec3 color, float whitePoint) {
     // Use Reinhard tone mapping variant
     return color * (1.0 + color / (whitePoint * whitePoint)) / (1.0 + color);
 }
+#endif
 
 void main() {
     float A = -dot(vPosition, vPosition);
@@ -33,15 +47,12 @@ void main() {
     
     vec3 color = B * vColor.rgb;
     
-    // Adjust saturation (1.0 = original, >1.0 = more saturated, <1.0 = desaturated)
-    color = adjustSaturation(color, 1.2);
-    
-    // Adjust white point (lower value = brighter highlights)
-    color = adjustWhitePoint(color, 0.9);
-    
+#ifdef POST_PROCESS
+    color = adjustSaturation(color, POST_SATURATION);
+    color = adjustWhitePoint(color, POST_WHITE_POINT);
     // Slight sharpening effect to enhance details
-    float sharpness = 1.05;
-    color = pow(color, vec3(1.0 / sharpness));
+    color = pow(color, vec3(1.0 / POST_SHARPNESS));
+#endif
     
     fragColor = vec4(color, B);
 }
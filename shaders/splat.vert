@@ -1,6 +1,6 @@
 #version 420 core
 
-uniform usampler2D u_texture;
+uniform usampler2DArray u_texture;
 uniform mat4 projection;
 uniform mat4 view;
 uniform vec2 focal;
@@ -12,12 +12,161 @@ in uint index;
 out vec4 vColor;
 out vec2 vPosition;
 
+// SplatTexture arrays: 2048 texels per row, 2048 rows per layer
+ivec3 splatTexel(uint t) {
+    return ivec3(t & 0x7ffu, (t >> 11) & 0x7ffu, t >> 22);
+}
+
+#ifdef INSTANCES
+// SceneInstances table: three transform rows as float bits, then first
+// splat, count and visibility
+uniform usampler2D u_instances;
+
+// Row of the last instance starting at or before splat i
+int findInstance(uint i) {
+    int lo = 0, hi = textureSize(u_instances, 0).y - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) >> 1;
+        if (texelFetch(u_instances, ivec2(3, mid), 0).x <= i) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return lo;
+}
+#endif
+
+#ifdef COMPRESSED_SPLATS
+// Per 256-splat chunk: position min, position step, log-scale min, log-scale step
+uniform usampler2DArray u_chunks;
+
+vec3 chunkTexel(uint chunk, uint k) {
+    return uintBitsToFloat(texelFetch(u_chunks, splatTexel((chunk << 2) | k), 0).xyz);
+}
+
+vec3 decodeCenter(uint i, uvec4 s) {
+    // Must match the CPU dequantization bit for bit, so no fma
+    precise vec3 center = chunkTexel(i >> 8, 0u) + vec3(uvec3(s.x & 0xffffu, s.x >> 16, s.y & 0xffffu)) * chunkTexel(i >> 8, 1u);
+    return center;
+}
+
+mat3 decodeCovariance(uint i, uvec4 s) {
+    vec3 logScale = chunkTexel(i >> 8, 2u) + vec3((uvec3(s.z >> 10, s.z >> 17, s.z >> 24)) & 0x7fu) * chunkTexel(i >> 8, 3u);
+    vec3 scale = exp(logScale);
+    
+    // Smallest three quaternion components; the largest is positive
+    vec3 abc = (vec3(uvec3(s.y >> 16, s.y >> 24, s.z) & 0xffu) / 127.5 - 1.0) * 0.70710678;
+    float largest = sqrt(max(0.0, 1.0 - dot(abc, abc)));
+    uint which = (s.z >> 8) & 3u;
+    vec4 q = which == 0u ? vec4(largest, abc) :
+             which == 1u ? vec4(abc.x, largest, abc.yz) :
+             which == 2u ? vec4(abc.xy, largest, abc.z) : vec4(abc, largest);
+    
+    // Rotation from (x, y, z, w), then R S S^T R^T
+    mat3 R = mat3(
+        1.0 - 2.0 * (q.y * q.y + q.z * q.z), 2.0 * (q.x * q.y + q.w * q.z), 2.0 * (q.x * q.z - q.w * q.y),
+        2.0 * (q.x * q.y - q.w * q.z), 1.0 - 2.0 * (q.x * q.x + q.z * q.z), 2.0 * (q.y * q.z + q.w * q.x),
+        2.0 * (q.x * q.z + q.w * q.y), 2.0 * (q.y * q.z - q.w * q.x), 1.0 - 2.0 * (q.x * q.x + q.y * q.y)
+    );
+    mat3 M = R * mat3(scale.x, 0.0, 0.0, 0.0, scale.y, 0.0, 0.0, 0.0, scale.z);
+    return M * transpose(M);
+}
+#endif
+
+#ifdef SH_DEGREE
+// Harmonics past DC, SH_STRIDE texels per splat, RGB triplets lowest band first
+uniform usampler2DArray u_sh;
+uniform vec3 cameraPosition;
+
+const uint kShCoefficients = SH_DEGREE == 1 ? 3u : SH_DEGREE == 2 ? 8u : 15u;
+#ifdef SH_BYTES
+// Range as a half, then a byte per value
+const uint kShWords = (2u + 3u * kShCoefficients + 3u) / 4u;
+#else
+const uint kShWords = (3u * kShCoefficients + 1u) / 2u;
+#endif
+
+// View-dependent color added to the baked DC color
+vec3 evalSH(uint i, vec3 dir) {
+    // Only the texels the evaluated bands need
+    uint words[kShWords];
+    for (uint t = 0u; t < (kShWords + 3u) / 4u; t++) {
+        uint texel = i * uint(SH_STRIDE) + t;
+        uvec4 v = texelFetch(u_sh, splatTexel(texel), 0);
+        for (uint c = 0u; c < 4u && 4u * t + c < kShWords; c++) {
+            words[4u * t + c] = v[c];
+        }
+    }
+    
+    vec3 sh[15];
+#ifdef SH_BYTES
+    float range = unpackHalf2x16(words[0]).x / 127.0;
+#endif
+    for (uint k = 0u; k < kShCoefficients; k++) {
+        for (uint c = 0u; c < 3u; c++) {
+            uint j = 3u * k + c;
+#ifdef SH_BYTES
+            uint b = j + 2u;
+            sh[k][c] = (float((words[b >> 2] >> ((b & 3u) * 8u)) & 0xffu) - 128.0) * range;
+#else
+            sh[k][c] = unpackHalf2x16(words[j >> 1])[j & 1u];
+#endif
+        }
+    }
+    
+    float x = dir.x, y = dir.y, z = dir.z;
+    vec3 result = 0.4886025 * (-y * sh[0] + z * sh[1] - x * sh[2]);
+#if SH_DEGREE > 1
+    float xx = x * x, yy = y * y, zz = z * z;
+    result += 1.0925484 * x * y * sh[3] -
+              1.0925484 * y * z * sh[4] +
+              0.3153916 * (2.0 * zz - xx - yy) * sh[5] -
+              1.0925484 * x * z * sh[6] +
+              0.5462742 * (xx - yy) * sh[7];
+#endif
+#if SH_DEGREE > 2
+    result += -0.5900436 * y * (3.0 * xx - yy) * sh[8] +
+              2.8906114 * x * y * z * sh[9] -
+              0.4570458 * y * (4.0 * zz - xx - yy) * sh[10] +
+              0.3731763 * z * (2.0 * zz - 3.0 * xx - 3.0 * yy) * sh[11] -
+              0.4570458 * x * (4.0 * zz - xx - yy) * sh[12] +
+              1.4453057 * z * (xx - yy) * sh[13] -
+              0.5900436 * x * (xx - 3.0 * yy) * sh[14];
+#endif
+    return result;
+}
+#endif
+
 void main() {
     // Fetch gaussian data from texture
-    uvec4 cen = texelFetch(u_texture, ivec2((uint(index) & 0x3ffu) << 1, uint(index) >> 10), 0);
+#ifdef COMPRESSED_SPLATS
+    uvec4 splat = texelFetch(u_texture, splatTexel(uint(index)), 0);
+    vec3 center = decodeCenter(uint(index), splat);
+#else
+    uvec4 cen = texelFetch(u_texture, splatTexel(uint(index) << 1), 0);
+    vec3 center = uintBitsToFloat(cen.xyz);
+#endif
+    
+#ifdef INSTANCES
+    // Hidden instances and the padding between instances are not drawn
+    int instance = findInstance(uint(index));
+    uvec4 range = texelFetch(u_instances, ivec2(3, instance), 0);
+    if (range.z == 0u || uint(index) - range.x >= range.y) {
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        return;
+    }
+    mat4 model = transpose(mat4(
+        uintBitsToFloat(texelFetch(u_instances, ivec2(0, instance), 0)),
+        uintBitsToFloat(texelFetch(u_instances, ivec2(1, instance), 0)),
+        uintBitsToFloat(texelFetch(u_instances, ivec2(2, instance), 0)),
+        vec4(0.0, 0.0, 0.0, 1.0)
+    ));
+    center = vec3(model * vec4(center, 1.0));
+#endif
     
     // Transform position to camera space
-    vec4 cam = view * vec4(uintBitsToFloat(cen.xyz), 1.0);
+    vec4 cam = view * vec4(center, 1.0);
     vec4 pos2d = projection * cam;
     
     // Frustum culling
@@ -29,8 +178,13 @@ void main() {
         return;
     }
     
+#ifdef COMPRESSED_SPLATS
+    mat3 Vrk = decodeCovariance(uint(index), splat);
+    uint rgba = splat.w;
+    bool selected = (splat.z & 0x80000000u) != 0u;
+#else
     // Fetch covariance data
-    uvec4 cov = texelFetch(u_texture, ivec2(((uint(index) & 0x3ffu) << 1) | 1u, uint(index) >> 10), 0);
+    uvec4 cov = texelFetch(u_texture, splatTexel((uint(index) << 1) | 1u), 0);
     
     // Unpack half-precision covariance
     vec2 u1 = unpackHalf2x16(cov.x);
@@ -41,6 +195,17 @@ void main() {
         u1.y, u2.y, u3.x,
         u2.x, u3.x, u3.y
     );
+    uint rgba = cov.w;
+    bool selected = (cen.w & 1u) != 0u;
+#endif
+    // Deleted and hidden splats (SplatEditor)
+    if ((rgba >> 24) == 0u) {
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        return;
+    }
+#ifdef INSTANCES
+    Vrk = mat3(model) * Vrk * transpose(mat3(model));
+#endif
     
     // Compute 2D covariance
     mat3 J = mat3(
@@ -75,11 +240,22 @@ void main() {
     
     // Unpack color
     vec4 color = vec4(
-        float((cov.w) & 0xffu),
-        float((cov.w >> 8) & 0xffu),
-        float((cov.w >> 16) & 0xffu),
-        float((cov.w >> 24) & 0xffu)
+        float(rgba & 0xffu),
+        float((rgba >> 8) & 0xffu),
+        float((rgba >> 16) & 0xffu),
+        float((rgba >> 24) & 0xffu)
     ) / 255.0;
+#ifdef SH_DEGREE
+    vec3 viewDir = center - cameraPosition;
+#ifdef INSTANCES
+    // Back into the scene's frame; exact for rotation and uniform scale
+    viewDir = transpose(mat3(model)) * viewDir;
+#endif
+    color.rgb = max(color.rgb + evalSH(uint(index), normalize(viewDir)), 0.0);
+#endif
+    if (selected) {
+        color.rgb = mix(color.rgb, vec3(1.0, 0.6, 0.1), 0.5);
+    }
     
     vColor = color;
     vPosition = position;
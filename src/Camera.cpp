@@ -28,7 +28,7 @@ void Camera::setSize(int w, int h) {
     fy = height / (2.0f * std::tan(fovRad / 2.0f));
     fx = fy; // Assume square pixels
     
-    projectionMatrix = glm::perspective(fovRad, aspect, nearPlane, farPlane);
+    updateProjection();
 }
 
 void Camera::setFov(float newFov) {
@@ -36,6 +36,27 @@ void Camera::setFov(float newFov) {
     setSize(width, height);
 }
 
+void Camera::setFocalLengths(float newFx, float newFy) {
+    fx = newFx;
+    fy = newFy;
+    fov = glm::degrees(2.0f * std::atan(height / (2.0f * fy)));
+    updateProjection();
+}
+
+void Camera::setClipPlanes(float newNear, float newFar) {
+    nearPlane = newNear;
+    farPlane = newFar;
+    updateProjection();
+}
+
+void Camera::updateProjection() {
+    projectionMatrix = glm::perspective(glm::radians(fov), aspect, nearPlane, farPlane);
+    // Non-square pixels: x is scaled by fx rather than by the vertical FOV
+    if (fx != fy) {
+        projectionMatrix[0][0] = 2.0f * fx / width;
+    }
+}
+
 void Camera::setPosition(const glm::vec3& pos) {
     position = pos;
 }
@@ -0,0 +1,94 @@
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "CameraSet.h"
+#include "Json.h"
+#include "Utils.h"
+
+namespace gsplat {
+
+namespace {
+
+double number(const JsonValue& entry, const char* key, size_t index, const std::string& path) {
+    const JsonValue* value = entry.find(key);
+    if (!value || value->type != JsonValue::Type::Number) {
+        throw std::runtime_error(path + ": camera " + std::to_string(index) + " has no number '" + key + "'");
+    }
+    return value->number;
+}
+
+// An array of count numbers
+std::vector<float> numbers(const JsonValue& value, size_t count, const char* key, size_t index,
+                           const std::string& path) {
+    if (value.type != JsonValue::Type::Array || value.items.size() != count) {
+        throw std::runtime_error(path + ": camera " + std::to_string(index) + " '" + key + "' must have " +
+                                 std::to_string(count) + " entries");
+    }
+    std::vector<float> out;
+    for (const JsonValue& item : value.items) {
+        if (item.type != JsonValue::Type::Number) {
+            throw std::runtime_error(path + ": camera " + std::to_string(index) + " '" + key + "' is not numeric");
+        }
+        out.push_back(static_cast<float>(item.number));
+    }
+    return out;
+}
+
+} // namespace
+
+std::vector<CameraView> CameraSet::load(const std::string& path) {
+    std::string text = readFile(path);
+    JsonValue root = parseJson(text, path);
+    if (root.type != JsonValue::Type::Array) {
+        throw std::runtime_error(path + ": expected an array of cameras");
+    }
+
+    std::vector<CameraView> views;
+    for (size_t i = 0; i < root.items.size(); i++) {
+        const JsonValue& entry = root.items[i];
+        if (entry.type != JsonValue::Type::Object) {
+            throw std::runtime_error(path + ": camera " + std::to_string(i) + " is not an object");
+        }
+        CameraView view;
+        const JsonValue* name = entry.find("img_name");
+        view.name = name && name->type == JsonValue::Type::String ? name->string : std::to_string(i);
+        view.width = static_cast<int>(number(entry, "width", i, path));
+        view.height = static_cast<int>(number(entry, "height", i, path));
+        view.fx = static_cast<float>(number(entry, "fx", i, path));
+        view.fy = static_cast<float>(number(entry, "fy", i, path));
+        if (view.width <= 0 || view.height <= 0 || !(view.fx > 0.0f) || !(view.fy > 0.0f)) {
+            throw std::runtime_error(path + ": camera " + std::to_string(i) + " has an invalid size or focal length");
+        }
+
+        const JsonValue* position = entry.find("position");
+        const JsonValue* rotation = entry.find("rotation");
+        if (!position || !rotation) {
+            throw std::runtime_error(path + ": camera " + std::to_string(i) + " needs position and rotation");
+        }
+        std::vector<float> p = numbers(*position, 3, "position", i, path);
+        view.position = glm::vec3(p[0], p[1], p[2]);
+        if (rotation->type != JsonValue::Type::Array || rotation->items.size() != 3) {
+            throw std::runtime_error(path + ": camera " + std::to_string(i) + " 'rotation' must have 3 rows");
+        }
+        for (int r = 0; r < 3; r++) {
+            std::vector<float> row = numbers(rotation->items[r], 3, "rotation", i, path);
+            for (int c = 0; c < 3; c++) {
+                view.rotation[c][r] = row[c];
+            }
+        }
+        views.push_back(std::move(view));
+    }
+    return views;
+}
+
+void CameraSet::apply(const CameraView& view, Camera& camera) {
+    camera.setSize(view.width, view.height);
+    camera.setFocalLengths(view.fx, view.fy);
+    // OpenGL looks down -z with y up: forward is the third column, up the negated second
+    camera.setPosition(view.position);
+    camera.setTarget(view.position + view.rotation[2]);
+    camera.setUp(-view.rotation[1]);
+}
+
+} // namespace gsplat
@@ -0,0 +1,539 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "DepthKeys.h"
+
+#if defined(GSPLAT_X86_KERNELS)
+#include <immintrin.h>
+#endif
+
+namespace gsplat {
+
+namespace {
+
+inline float scalarDepth(const DepthAxis& a, float x, float y, float z) {
+    return a.x * x + a.y * y + a.z * z + a.w;
+}
+
+// Map a float onto a uint32 whose unsigned order matches the float order
+inline uint32_t floatToSortableKey(float value) {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(uint32_t));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+inline uint32_t quantize16(float depth, float minDepth, float scale) {
+    const float maxKey = 65535.0f;
+    float q = (depth - minDepth) * scale;
+    // Written so NaN depths land in bucket 0
+    return q > 0.0f ? static_cast<uint32_t>(std::min(q, maxKey)) : 0;
+}
+
+void depthKeys32Scalar(const DepthAxis& a, const float* x, const float* y, const float* z,
+                       uint32_t begin, uint32_t count, uint32_t* keys) {
+    for (uint32_t i = begin; i < count; i++) {
+        keys[i] = floatToSortableKey(scalarDepth(a, x[i], y[i], z[i]));
+    }
+}
+
+void depthsScalar(const DepthAxis& a, const float* x, const float* y, const float* z,
+                  uint32_t begin, uint32_t count, float* depths, float& minDepth, float& maxDepth) {
+    for (uint32_t i = begin; i < count; i++) {
+        float depth = scalarDepth(a, x[i], y[i], z[i]);
+        depths[i] = depth;
+        minDepth = std::min(minDepth, depth);
+        maxDepth = std::max(maxDepth, depth);
+    }
+}
+
+void quantizeScalar(const float* depths, uint32_t begin, uint32_t count,
+                    float minDepth, float scale, uint32_t* keys) {
+    for (uint32_t i = begin; i < count; i++) {
+        keys[i] = quantize16(depths[i], minDepth, scale);
+    }
+}
+
+// Where the culling kernels write; exactly one of keys and depths is set
+struct CullOutput {
+    uint32_t* keys;
+    float* depths;
+    uint32_t* indices;
+    uint32_t written;
+    float minDepth;
+    float maxDepth;
+};
+
+inline void emitVisible(CullOutput& out, float depth, uint32_t index) {
+    if (out.keys) {
+        out.keys[out.written] = floatToSortableKey(depth);
+    } else {
+        out.depths[out.written] = depth;
+        out.minDepth = std::min(out.minDepth, depth);
+        out.maxDepth = std::max(out.maxDepth, depth);
+    }
+    out.indices[out.written++] = index;
+}
+
+// NaN positions fail every comparison and are culled
+inline bool insideFrustum(const ClipRows& c, float x, float y, float z) {
+    float cx = scalarDepth(c.x, x, y, z);
+    float cy = scalarDepth(c.y, x, y, z);
+    float cz = scalarDepth(c.z, x, y, z);
+    float cw = scalarDepth(c.w, x, y, z);
+    float limit = kCullMargin * cw;
+    return cz >= -cw && cz <= cw && cx >= -limit && cx <= limit && cy >= -limit && cy <= limit;
+}
+
+void cullScalar(const ClipRows& c, const DepthAxis& a, const float* x, const float* y, const float* z,
+                uint32_t begin, uint32_t count, uint32_t base, CullOutput& out) {
+    for (uint32_t i = begin; i < count; i++) {
+        if (insideFrustum(c, x[i], y[i], z[i])) {
+            emitVisible(out, scalarDepth(a, x[i], y[i], z[i]), base + i);
+        }
+    }
+}
+
+#if defined(GSPLAT_X86_KERNELS)
+
+// Operation order mirrors scalarDepth, and no kernel enables FMA, so every
+// level rounds identically. min/max take the new value first so a NaN lane
+// keeps the running value, matching std::min/std::max in the scalar loop.
+
+__attribute__((target("sse4.1")))
+uint32_t depthKeys32SSE41(const DepthAxis& a, const float* x, const float* y, const float* z,
+                          uint32_t count, uint32_t* keys) {
+    const __m128 ax = _mm_set1_ps(a.x), ay = _mm_set1_ps(a.y), az = _mm_set1_ps(a.z), aw = _mm_set1_ps(a.w);
+    const __m128i signBit = _mm_set1_epi32(static_cast<int>(0x80000000u));
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(ax, _mm_loadu_ps(x + i)), _mm_mul_ps(ay, _mm_loadu_ps(y + i))),
+            _mm_mul_ps(az, _mm_loadu_ps(z + i))), aw);
+        __m128i bits = _mm_castps_si128(d);
+        __m128i flip = _mm_or_si128(_mm_srai_epi32(bits, 31), signBit);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(keys + i), _mm_xor_si128(bits, flip));
+    }
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+uint32_t depthsSSE41(const DepthAxis& a, const float* x, const float* y, const float* z,
+                     uint32_t count, float* depths, float& minDepth, float& maxDepth) {
+    const __m128 ax = _mm_set1_ps(a.x), ay = _mm_set1_ps(a.y), az = _mm_set1_ps(a.z), aw = _mm_set1_ps(a.w);
+    __m128 vmin = _mm_set1_ps(minDepth), vmax = _mm_set1_ps(maxDepth);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(ax, _mm_loadu_ps(x + i)), _mm_mul_ps(ay, _mm_loadu_ps(y + i))),
+            _mm_mul_ps(az, _mm_loadu_ps(z + i))), aw);
+        _mm_storeu_ps(depths + i, d);
+        vmin = _mm_min_ps(d, vmin);
+        vmax = _mm_max_ps(d, vmax);
+    }
+    alignas(16) float lanesMin[4], lanesMax[4];
+    _mm_store_ps(lanesMin, vmin);
+    _mm_store_ps(lanesMax, vmax);
+    for (int l = 0; l < 4; l++) {
+        minDepth = std::min(minDepth, lanesMin[l]);
+        maxDepth = std::max(maxDepth, lanesMax[l]);
+    }
+    return i;
+}
+
+__attribute__((target("sse4.1")))
+uint32_t quantizeSSE41(const float* depths, uint32_t count, float minDepth, float scale, uint32_t* keys) {
+    const __m128 vmin = _mm_set1_ps(minDepth), vscale = _mm_set1_ps(scale);
+    const __m128 zero = _mm_setzero_ps(), maxKey = _mm_set1_ps(65535.0f);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 q = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(depths + i), vmin), vscale);
+        q = _mm_min_ps(_mm_max_ps(q, zero), maxKey);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(keys + i), _mm_cvttps_epi32(q));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+uint32_t depthKeys32AVX2(const DepthAxis& a, const float* x, const float* y, const float* z,
+                         uint32_t count, uint32_t* keys) {
+    const __m256 ax = _mm256_set1_ps(a.x), ay = _mm256_set1_ps(a.y), az = _mm256_set1_ps(a.z), aw = _mm256_set1_ps(a.w);
+    const __m256i signBit = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+            _mm256_mul_ps(ax, _mm256_loadu_ps(x + i)), _mm256_mul_ps(ay, _mm256_loadu_ps(y + i))),
+            _mm256_mul_ps(az, _mm256_loadu_ps(z + i))), aw);
+        __m256i bits = _mm256_castps_si256(d);
+        __m256i flip = _mm256_or_si256(_mm256_srai_epi32(bits, 31), signBit);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys + i), _mm256_xor_si256(bits, flip));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+uint32_t depthsAVX2(const DepthAxis& a, const float* x, const float* y, const float* z,
+                    uint32_t count, float* depths, float& minDepth, float& maxDepth) {
+    const __m256 ax = _mm256_set1_ps(a.x), ay = _mm256_set1_ps(a.y), az = _mm256_set1_ps(a.z), aw = _mm256_set1_ps(a.w);
+    __m256 vmin = _mm256_set1_ps(minDepth), vmax = _mm256_set1_ps(maxDepth);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+            _mm256_mul_ps(ax, _mm256_loadu_ps(x + i)), _mm256_mul_ps(ay, _mm256_loadu_ps(y + i))),
+            _mm256_mul_ps(az, _mm256_loadu_ps(z + i))), aw);
+        _mm256_storeu_ps(depths + i, d);
+        vmin = _mm256_min_ps(d, vmin);
+        vmax = _mm256_max_ps(d, vmax);
+    }
+    alignas(32) float lanesMin[8], lanesMax[8];
+    _mm256_store_ps(lanesMin, vmin);
+    _mm256_store_ps(lanesMax, vmax);
+    for (int l = 0; l < 8; l++) {
+        minDepth = std::min(minDepth, lanesMin[l]);
+        maxDepth = std::max(maxDepth, lanesMax[l]);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+uint32_t quantizeAVX2(const float* depths, uint32_t count, float minDepth, float scale, uint32_t* keys) {
+    const __m256 vmin = _mm256_set1_ps(minDepth), vscale = _mm256_set1_ps(scale);
+    const __m256 zero = _mm256_setzero_ps(), maxKey = _mm256_set1_ps(65535.0f);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 q = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(depths + i), vmin), vscale);
+        q = _mm256_min_ps(_mm256_max_ps(q, zero), maxKey);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys + i), _mm256_cvttps_epi32(q));
+    }
+    return i;
+}
+
+__attribute__((target("avx512f")))
+uint32_t depthKeys32AVX512(const DepthAxis& a, const float* x, const float* y, const float* z,
+                           uint32_t count, uint32_t* keys) {
+    const __m512 ax = _mm512_set1_ps(a.x), ay = _mm512_set1_ps(a.y), az = _mm512_set1_ps(a.z), aw = _mm512_set1_ps(a.w);
+    const __m512i signBit = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 d = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(
+            _mm512_mul_ps(ax, _mm512_loadu_ps(x + i)), _mm512_mul_ps(ay, _mm512_loadu_ps(y + i))),
+            _mm512_mul_ps(az, _mm512_loadu_ps(z + i))), aw);
+        __m512i bits = _mm512_castps_si512(d);
+        __m512i flip = _mm512_or_si512(_mm512_srai_epi32(bits, 31), signBit);
+        _mm512_storeu_si512(keys + i, _mm512_xor_si512(bits, flip));
+    }
+    return i;
+}
+
+__attribute__((target("avx512f")))
+uint32_t depthsAVX512(const DepthAxis& a, const float* x, const float* y, const float* z,
+                      uint32_t count, float* depths, float& minDepth, float& maxDepth) {
+    const __m512 ax = _mm512_set1_ps(a.x), ay = _mm512_set1_ps(a.y), az = _mm512_set1_ps(a.z), aw = _mm512_set1_ps(a.w);
+    __m512 vmin = _mm512_set1_ps(minDepth), vmax = _mm512_set1_ps(maxDepth);
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 d = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(
+            _mm512_mul_ps(ax, _mm512_loadu_ps(x + i)), _mm512_mul_ps(ay, _mm512_loadu_ps(y + i))),
+            _mm512_mul_ps(az, _mm512_loadu_ps(z + i))), aw);
+        _mm512_storeu_ps(depths + i, d);
+        vmin = _mm512_min_ps(d, vmin);
+        vmax = _mm512_max_ps(d, vmax);
+    }
+    alignas(64) float lanesMin[16], lanesMax[16];
+    _mm512_store_ps(lanesMin, vmin);
+    _mm512_store_ps(lanesMax, vmax);
+    for (int l = 0; l < 16; l++) {
+        minDepth = std::min(minDepth, lanesMin[l]);
+        maxDepth = std::max(maxDepth, lanesMax[l]);
+    }
+    return i;
+}
+
+__attribute__((target("avx512f")))
+uint32_t quantizeAVX512(const float* depths, uint32_t count, float minDepth, float scale, uint32_t* keys) {
+    const __m512 vmin = _mm512_set1_ps(minDepth), vscale = _mm512_set1_ps(scale);
+    const __m512 zero = _mm512_setzero_ps(), maxKey = _mm512_set1_ps(65535.0f);
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 q = _mm512_mul_ps(_mm512_sub_ps(_mm512_loadu_ps(depths + i), vmin), vscale);
+        q = _mm512_min_ps(_mm512_max_ps(q, zero), maxKey);
+        _mm512_storeu_si512(keys + i, _mm512_cvttps_epi32(q));
+    }
+    return i;
+}
+
+// The culling kernels test a full register of splats at once and emit the
+// visible lanes in order; the comparisons are ordered like the scalar ones,
+// so NaN lanes are culled everywhere.
+
+__attribute__((target("sse4.1")))
+inline __m128 rowSSE41(const DepthAxis& r, __m128 x, __m128 y, __m128 z) {
+    return _mm_add_ps(_mm_add_ps(_mm_add_ps(
+        _mm_mul_ps(_mm_set1_ps(r.x), x), _mm_mul_ps(_mm_set1_ps(r.y), y)),
+        _mm_mul_ps(_mm_set1_ps(r.z), z)), _mm_set1_ps(r.w));
+}
+
+__attribute__((target("sse4.1")))
+uint32_t cullSSE41(const ClipRows& c, const DepthAxis& a, const float* x, const float* y, const float* z,
+                   uint32_t count, uint32_t base, CullOutput& out) {
+    const __m128 margin = _mm_set1_ps(kCullMargin), sign = _mm_set1_ps(-0.0f);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+        __m128 cx = rowSSE41(c.x, vx, vy, vz), cy = rowSSE41(c.y, vx, vy, vz);
+        __m128 cz = rowSSE41(c.z, vx, vy, vz), cw = rowSSE41(c.w, vx, vy, vz);
+        __m128 limit = _mm_mul_ps(margin, cw);
+        __m128 negLimit = _mm_xor_ps(limit, sign);
+        __m128 inside = _mm_and_ps(_mm_cmpge_ps(cz, _mm_xor_ps(cw, sign)), _mm_cmple_ps(cz, cw));
+        inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(cx, negLimit), _mm_cmple_ps(cx, limit)));
+        inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(cy, negLimit), _mm_cmple_ps(cy, limit)));
+        int mask = _mm_movemask_ps(inside);
+        if (mask == 0) continue;
+        alignas(16) float depth[4];
+        _mm_store_ps(depth, rowSSE41(a, vx, vy, vz));
+        for (; mask != 0; mask &= mask - 1) {
+            int lane = __builtin_ctz(mask);
+            emitVisible(out, depth[lane], base + i + lane);
+        }
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline __m256 rowAVX2(const DepthAxis& r, __m256 x, __m256 y, __m256 z) {
+    return _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+        _mm256_mul_ps(_mm256_set1_ps(r.x), x), _mm256_mul_ps(_mm256_set1_ps(r.y), y)),
+        _mm256_mul_ps(_mm256_set1_ps(r.z), z)), _mm256_set1_ps(r.w));
+}
+
+__attribute__((target("avx2")))
+uint32_t cullAVX2(const ClipRows& c, const DepthAxis& a, const float* x, const float* y, const float* z,
+                  uint32_t count, uint32_t base, CullOutput& out) {
+    const __m256 margin = _mm256_set1_ps(kCullMargin), sign = _mm256_set1_ps(-0.0f);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i), vz = _mm256_loadu_ps(z + i);
+        __m256 cx = rowAVX2(c.x, vx, vy, vz), cy = rowAVX2(c.y, vx, vy, vz);
+        __m256 cz = rowAVX2(c.z, vx, vy, vz), cw = rowAVX2(c.w, vx, vy, vz);
+        __m256 limit = _mm256_mul_ps(margin, cw);
+        __m256 negLimit = _mm256_xor_ps(limit, sign);
+        __m256 inside = _mm256_and_ps(_mm256_cmp_ps(cz, _mm256_xor_ps(cw, sign), _CMP_GE_OQ),
+                                      _mm256_cmp_ps(cz, cw, _CMP_LE_OQ));
+        inside = _mm256_and_ps(inside, _mm256_and_ps(_mm256_cmp_ps(cx, negLimit, _CMP_GE_OQ),
+                                                     _mm256_cmp_ps(cx, limit, _CMP_LE_OQ)));
+        inside = _mm256_and_ps(inside, _mm256_and_ps(_mm256_cmp_ps(cy, negLimit, _CMP_GE_OQ),
+                                                     _mm256_cmp_ps(cy, limit, _CMP_LE_OQ)));
+        int mask = _mm256_movemask_ps(inside);
+        if (mask == 0) continue;
+        alignas(32) float depth[8];
+        _mm256_store_ps(depth, rowAVX2(a, vx, vy, vz));
+        for (; mask != 0; mask &= mask - 1) {
+            int lane = __builtin_ctz(mask);
+            emitVisible(out, depth[lane], base + i + lane);
+        }
+    }
+    return i;
+}
+
+__attribute__((target("avx512f")))
+inline __m512 rowAVX512(const DepthAxis& r, __m512 x, __m512 y, __m512 z) {
+    return _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(
+        _mm512_mul_ps(_mm512_set1_ps(r.x), x), _mm512_mul_ps(_mm512_set1_ps(r.y), y)),
+        _mm512_mul_ps(_mm512_set1_ps(r.z), z)), _mm512_set1_ps(r.w));
+}
+
+__attribute__((target("avx512f")))
+inline __m512 negateAVX512(__m512 v) {
+    return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), _mm512_set1_epi32(static_cast<int>(0x80000000u))));
+}
+
+// Compress-stores the visible lanes instead of walking the mask
+__attribute__((target("avx512f")))
+uint32_t cullAVX512(const ClipRows& c, const DepthAxis& a, const float* x, const float* y, const float* z,
+                    uint32_t count, uint32_t base, CullOutput& out) {
+    const __m512 margin = _mm512_set1_ps(kCullMargin);
+    const __m512i signBit = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m512 vmin = _mm512_set1_ps(out.minDepth), vmax = _mm512_set1_ps(out.maxDepth);
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 vx = _mm512_loadu_ps(x + i), vy = _mm512_loadu_ps(y + i), vz = _mm512_loadu_ps(z + i);
+        __m512 cx = rowAVX512(c.x, vx, vy, vz), cy = rowAVX512(c.y, vx, vy, vz);
+        __m512 cz = rowAVX512(c.z, vx, vy, vz), cw = rowAVX512(c.w, vx, vy, vz);
+        __m512 limit = _mm512_mul_ps(margin, cw);
+        __m512 negLimit = negateAVX512(limit);
+        __mmask16 inside = _mm512_cmp_ps_mask(cz, negateAVX512(cw), _CMP_GE_OQ) & _mm512_cmp_ps_mask(cz, cw, _CMP_LE_OQ) &
+                           _mm512_cmp_ps_mask(cx, negLimit, _CMP_GE_OQ) & _mm512_cmp_ps_mask(cx, limit, _CMP_LE_OQ) &
+                           _mm512_cmp_ps_mask(cy, negLimit, _CMP_GE_OQ) & _mm512_cmp_ps_mask(cy, limit, _CMP_LE_OQ);
+        if (inside == 0) continue;
+        __m512 d = rowAVX512(a, vx, vy, vz);
+        if (out.keys) {
+            __m512i bits = _mm512_castps_si512(d);
+            __m512i flip = _mm512_or_si512(_mm512_srai_epi32(bits, 31), signBit);
+            _mm512_mask_compressstoreu_epi32(out.keys + out.written, inside, _mm512_xor_si512(bits, flip));
+        } else {
+            _mm512_mask_compressstoreu_ps(out.depths + out.written, inside, d);
+            vmin = _mm512_mask_min_ps(vmin, inside, d, vmin);
+            vmax = _mm512_mask_max_ps(vmax, inside, d, vmax);
+        }
+        __m512i index = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(base + i)), lanes);
+        _mm512_mask_compressstoreu_epi32(out.indices + out.written, inside, index);
+        out.written += static_cast<uint32_t>(__builtin_popcount(inside));
+    }
+    alignas(64) float lanesMin[16], lanesMax[16];
+    _mm512_store_ps(lanesMin, vmin);
+    _mm512_store_ps(lanesMax, vmax);
+    for (int l = 0; l < 16; l++) {
+        out.minDepth = std::min(out.minDepth, lanesMin[l]);
+        out.maxDepth = std::max(out.maxDepth, lanesMax[l]);
+    }
+    return i;
+}
+
+#endif // GSPLAT_X86_KERNELS
+
+uint32_t cull(SimdLevel level, const ClipRows& clip, const DepthAxis& axis,
+              const float* x, const float* y, const float* z, uint32_t count, uint32_t base, CullOutput& out) {
+    uint32_t done = 0;
+#if defined(GSPLAT_X86_KERNELS)
+    switch (level) {
+        case SimdLevel::AVX512: done = cullAVX512(clip, axis, x, y, z, count, base, out); break;
+        case SimdLevel::AVX2: done = cullAVX2(clip, axis, x, y, z, count, base, out); break;
+        case SimdLevel::SSE41: done = cullSSE41(clip, axis, x, y, z, count, base, out); break;
+        default: break;
+    }
+#else
+    (void)level;
+#endif
+    cullScalar(clip, axis, x, y, z, done, count, base, out);
+    return out.written;
+}
+
+} // namespace
+
+DepthAxis depthAxisFromViewProj(const glm::mat4& viewProj) {
+    // glm is column-major: row r is (m[0][r], m[1][r], m[2][r], m[3][r])
+    int row = 3;
+    float wx = viewProj[0][3], wy = viewProj[1][3], wz = viewProj[2][3];
+    if (wx * wx + wy * wy + wz * wz < 1e-12f) {
+        row = 2;
+    }
+    return DepthAxis{viewProj[0][row], viewProj[1][row], viewProj[2][row], viewProj[3][row]};
+}
+
+ClipRows clipRowsFromViewProj(const glm::mat4& viewProj) {
+    auto row = [&](int r) { return DepthAxis{viewProj[0][r], viewProj[1][r], viewProj[2][r], viewProj[3][r]}; };
+    return ClipRows{row(0), row(1), row(2), row(3)};
+}
+
+void computeDepthKeys32(SimdLevel level, const DepthAxis& axis,
+                        const float* x, const float* y, const float* z,
+                        uint32_t count, uint32_t* keys) {
+    uint32_t done = 0;
+#if defined(GSPLAT_X86_KERNELS)
+    switch (level) {
+        case SimdLevel::AVX512: done = depthKeys32AVX512(axis, x, y, z, count, keys); break;
+        case SimdLevel::AVX2: done = depthKeys32AVX2(axis, x, y, z, count, keys); break;
+        case SimdLevel::SSE41: done = depthKeys32SSE41(axis, x, y, z, count, keys); break;
+        default: break;
+    }
+#else
+    (void)level;
+#endif
+    depthKeys32Scalar(axis, x, y, z, done, count, keys);
+}
+
+void computeDepths(SimdLevel level, const DepthAxis& axis,
+                   const float* x, const float* y, const float* z,
+                   uint32_t count, float* depths, float& minDepth, float& maxDepth) {
+    uint32_t done = 0;
+#if defined(GSPLAT_X86_KERNELS)
+    switch (level) {
+        case SimdLevel::AVX512: done = depthsAVX512(axis, x, y, z, count, depths, minDepth, maxDepth); break;
+        case SimdLevel::AVX2: done = depthsAVX2(axis, x, y, z, count, depths, minDepth, maxDepth); break;
+        case SimdLevel::SSE41: done = depthsSSE41(axis, x, y, z, count, depths, minDepth, maxDepth); break;
+        default: break;
+    }
+#else
+    (void)level;
+#endif
+    depthsScalar(axis, x, y, z, done, count, depths, minDepth, maxDepth);
+}
+
+uint32_t cullDepthKeys32(SimdLevel level, const ClipRows& clip, const DepthAxis& axis,
+                         const float* x, const float* y, const float* z,
+                         uint32_t count, uint32_t base, uint32_t* keys, uint32_t* indices) {
+    CullOutput out = {keys, nullptr, indices, 0, 0.0f, 0.0f};
+    return cull(level, clip, axis, x, y, z, count, base, out);
+}
+
+uint32_t cullDepths(SimdLevel level, const ClipRows& clip, const DepthAxis& axis,
+                    const float* x, const float* y, const float* z,
+                    uint32_t count, uint32_t base, float* depths, uint32_t* indices,
+                    float& minDepth, float& maxDepth) {
+    CullOutput out = {nullptr, depths, indices, 0, minDepth, maxDepth};
+    cull(level, clip, axis, x, y, z, count, base, out);
+    minDepth = out.minDepth;
+    maxDepth = out.maxDepth;
+    return out.written;
+}
+
+BoxVisibility classifyBox(const ClipRows& clip, const glm::vec3& boxMin, const glm::vec3& boxMax) {
+    // The six planes as a * row + b * other, each kept >= 0 by visible points
+    struct Plane {
+        const DepthAxis& a;
+        float as;
+        const DepthAxis& b;
+        float bs;
+    };
+    const Plane planes[] = {
+        {clip.w, 1.0f, clip.z, 1.0f}, {clip.w, 1.0f, clip.z, -1.0f},
+        {clip.w, kCullMargin, clip.x, 1.0f}, {clip.w, kCullMargin, clip.x, -1.0f},
+        {clip.w, kCullMargin, clip.y, 1.0f}, {clip.w, kCullMargin, clip.y, -1.0f},
+    };
+    const glm::vec3 extent = glm::max(glm::abs(boxMin), glm::abs(boxMax));
+    bool inside = true;
+    for (const Plane& p : planes) {
+        const DepthAxis plane = {p.as * p.a.x + p.bs * p.b.x, p.as * p.a.y + p.bs * p.b.y,
+                                 p.as * p.a.z + p.bs * p.b.z, p.as * p.a.w + p.bs * p.b.w};
+        float highest = 0.0f, lowest = 0.0f;
+        boxDepthRange(plane, boxMin, boxMax, lowest, highest);
+        // Rounding of the per-splat test is relative to its terms, which can
+        // be much larger than the plane value when they cancel
+        float terms = (std::abs(p.as * p.a.x) + std::abs(p.b.x)) * extent.x +
+                      (std::abs(p.as * p.a.y) + std::abs(p.b.y)) * extent.y +
+                      (std::abs(p.as * p.a.z) + std::abs(p.b.z)) * extent.z +
+                      std::abs(p.as * p.a.w) + std::abs(p.b.w);
+        float tolerance = 1e-5f * terms;
+        if (highest < -tolerance) return BoxVisibility::Outside;
+        // Written so a NaN bound makes the box Partial
+        if (!(lowest > tolerance)) inside = false;
+    }
+    return inside ? BoxVisibility::Inside : BoxVisibility::Partial;
+}
+
+void boxDepthRange(const DepthAxis& axis, const glm::vec3& boxMin, const glm::vec3& boxMax,
+                   float& minDepth, float& maxDepth) {
+    minDepth = scalarDepth(axis, axis.x >= 0.0f ? boxMin.x : boxMax.x, axis.y >= 0.0f ? boxMin.y : boxMax.y,
+                           axis.z >= 0.0f ? boxMin.z : boxMax.z);
+    maxDepth = scalarDepth(axis, axis.x >= 0.0f ? boxMax.x : boxMin.x, axis.y >= 0.0f ? boxMax.y : boxMin.y,
+                           axis.z >= 0.0f ? boxMax.z : boxMin.z);
+}
+
+void quantizeDepths16(SimdLevel level, const float* depths, uint32_t count,
+                      float minDepth, float scale, uint32_t* keys) {
+    uint32_t done = 0;
+#if defined(GSPLAT_X86_KERNELS)
+    switch (level) {
+        case SimdLevel::AVX512: done = quantizeAVX512(depths, count, minDepth, scale, keys); break;
+        case SimdLevel::AVX2: done = quantizeAVX2(depths, count, minDepth, scale, keys); break;
+        case SimdLevel::SSE41: done = quantizeSSE41(depths, count, minDepth, scale, keys); break;
+        default: break;
+    }
+#else
+    (void)level;
+#endif
+    quantizeScalar(depths, done, count, minDepth, scale, keys);
+}
+
+} // namespace gsplat
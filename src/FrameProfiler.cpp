@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "FrameProfiler.h"
+
+namespace gsplat {
+
+const char* profilePhaseName(ProfilePhase phase) {
+    switch (phase) {
+        case ProfilePhase::SplatUpload: return "Splat upload";
+        case ProfilePhase::Camera: return "Camera";
+        case ProfilePhase::Sort: return "Sort";
+        case ProfilePhase::IndexUpload: return "Index upload";
+        case ProfilePhase::Uniforms: return "Uniforms";
+        case ProfilePhase::Draw: return "Draw";
+        case ProfilePhase::Frame: return "Frame";
+        default: return "Unknown";
+    }
+}
+
+FrameProfiler::FrameProfiler()
+    : enabled(false)
+    , recording(false)
+    , hasQueries(false)
+    , epoch(std::chrono::steady_clock::now())
+    , frame(0)
+    , current(0)
+    , phase(-1)
+    , phaseStartUs(0.0)
+    , droppedGpuFrames(0)
+{
+}
+
+FrameProfiler::~FrameProfiler() {
+    if (hasQueries) {
+        for (Slot& slot : slots) {
+            glDeleteQueries(static_cast<GLsizei>(kPhases), slot.queries);
+        }
+    }
+}
+
+void FrameProfiler::setEnabled(bool enable) {
+    if (enable && !hasQueries) {
+        for (Slot& slot : slots) {
+            glGenQueries(static_cast<GLsizei>(kPhases), slot.queries);
+        }
+        hasQueries = true;
+    }
+    if (!enable) {
+        end();
+    }
+    enabled = enable;
+}
+
+double FrameProfiler::nowUs() const {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void FrameProfiler::beginFrame() {
+    if (!enabled) return;
+    frame++;
+    current = static_cast<int>(frame % kLatency);
+    collect(current);
+
+    Slot& slot = slots[current];
+    slot.record = FrameRecord();
+    slot.record.frame = frame;
+    std::fill(std::begin(slot.record.gpuMs), std::end(slot.record.gpuMs), -1.0f);
+    std::fill(std::begin(slot.issued), std::end(slot.issued), false);
+    slot.record.cpuStartUs[static_cast<size_t>(ProfilePhase::Frame)] = nowUs();
+    phase = -1;
+}
+
+void FrameProfiler::endFrame() {
+    if (!enabled) return;
+    end();
+    Slot& slot = slots[current];
+    const size_t f = static_cast<size_t>(ProfilePhase::Frame);
+    float ms = static_cast<float>((nowUs() - slot.record.cpuStartUs[f]) / 1000.0);
+    slot.record.cpuMs[f] = ms;
+    slot.record.timed[f] = true;
+    addSample(cpuWindows[f], ms);
+    slot.pending = true;
+}
+
+void FrameProfiler::begin(ProfilePhase p) {
+    if (!enabled) return;
+    end();
+    phase = static_cast<int>(p);
+    phaseStartUs = nowUs();
+    Slot& slot = slots[current];
+    glBeginQuery(GL_TIME_ELAPSED, slot.queries[phase]);
+    slot.issued[phase] = true;
+}
+
+void FrameProfiler::end() {
+    if (!enabled || phase < 0) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    FrameRecord& record = slots[current].record;
+    float ms = static_cast<float>((nowUs() - phaseStartUs) / 1000.0);
+    record.cpuStartUs[phase] = phaseStartUs;
+    record.cpuMs[phase] = ms;
+    record.timed[phase] = true;
+    addSample(cpuWindows[phase], ms);
+    phase = -1;
+}
+
+void FrameProfiler::flush() {
+    if (!enabled) return;
+    glFinish();
+    collect((current + 1) % kLatency);
+}
+
+void FrameProfiler::collect(int reuse) {
+    for (int k = 0; k < kLatency; k++) {
+        Slot& slot = slots[(reuse + k) % kLatency];
+        if (!slot.pending) continue;
+
+        bool ready = true;
+        for (size_t p = 0; p < kPhases && ready; p++) {
+            if (!slot.issued[p]) continue;
+            GLint available = 0;
+            glGetQueryObjectiv(slot.queries[p], GL_QUERY_RESULT_AVAILABLE, &available);
+            ready = available != 0;
+        }
+        // Later frames finish later; only the slot being reused has to give up
+        if (!ready && k > 0) break;
+
+        if (ready) {
+            // Some drivers report nonsense for a context's first queries; no
+            // phase can have taken longer than the time since its frame began
+            const size_t f = static_cast<size_t>(ProfilePhase::Frame);
+            double limitMs = (nowUs() - slot.record.cpuStartUs[f]) / 1000.0;
+            float total = 0.0f;
+            for (size_t p = 0; p < kPhases; p++) {
+                if (!slot.issued[p]) continue;
+                GLuint64 ns = 0;
+                glGetQueryObjectui64v(slot.queries[p], GL_QUERY_RESULT, &ns);
+                float ms = static_cast<float>(ns / 1e6);
+                if (ms > limitMs) continue;
+                slot.record.gpuMs[p] = ms;
+                addSample(gpuWindows[p], ms);
+                total += ms;
+            }
+            slot.record.gpuMs[f] = total;
+            addSample(gpuWindows[f], total);
+        } else {
+            droppedGpuFrames++;
+        }
+        slot.pending = false;
+        if (recording) {
+            records.push_back(slot.record);
+        }
+    }
+}
+
+void FrameProfiler::addSample(Window& window, float ms) {
+    if (window.samples.size() < kWindow) {
+        window.samples.push_back(ms);
+    } else {
+        window.samples[window.next] = ms;
+    }
+    window.next = (window.next + 1) % kWindow;
+}
+
+Percentiles FrameProfiler::percentiles(const Window& window) {
+    Percentiles result;
+    if (window.samples.empty()) return result;
+    std::vector<float> sorted = window.samples;
+    std::sort(sorted.begin(), sorted.end());
+    // Nearest rank
+    auto rank = [&](double q) {
+        size_t k = static_cast<size_t>(std::ceil(q * sorted.size()));
+        return static_cast<double>(sorted[std::min(std::max<size_t>(k, 1), sorted.size()) - 1]);
+    };
+    result.p50 = rank(0.50);
+    result.p95 = rank(0.95);
+    result.p99 = rank(0.99);
+    return result;
+}
+
+Percentiles FrameProfiler::getCpuPercentiles(ProfilePhase p) const {
+    return percentiles(cpuWindows[static_cast<size_t>(p)]);
+}
+
+Percentiles FrameProfiler::getGpuPercentiles(ProfilePhase p) const {
+    return percentiles(gpuWindows[static_cast<size_t>(p)]);
+}
+
+void FrameProfiler::printSummary(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+
+    out << "Frame timings over the last " << cpuWindows[static_cast<size_t>(ProfilePhase::Frame)].samples.size()
+        << " frames (ms, p50 / p95 / p99):" << std::endl;
+    for (size_t p = 0; p < kPhases; p++) {
+        Percentiles cpu = percentiles(cpuWindows[p]);
+        Percentiles gpu = percentiles(gpuWindows[p]);
+        out << "  " << std::left << std::setw(14) << profilePhaseName(static_cast<ProfilePhase>(p)) << std::right
+            << "CPU " << std::setw(9) << cpu.p50 << std::setw(9) << cpu.p95 << std::setw(9) << cpu.p99
+            << "   GPU " << std::setw(9) << gpu.p50 << std::setw(9) << gpu.p95 << std::setw(9) << gpu.p99
+            << std::endl;
+    }
+    if (droppedGpuFrames > 0) {
+        out << "  " << droppedGpuFrames << " frames without GPU times (results not ready in time)" << std::endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void FrameProfiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Failed to write trace file: " + path);
+    }
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n"
+        << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"CPU\"}},\n"
+        << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 2, \"args\": {\"name\": \"GPU\"}}";
+    for (const FrameRecord& record : records) {
+        for (size_t p = 0; p < kPhases; p++) {
+            if (!record.timed[p]) continue;
+            const char* name = profilePhaseName(static_cast<ProfilePhase>(p));
+            out << ",\n{\"name\": \"" << name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": "
+                << record.cpuStartUs[p] << ", \"dur\": " << record.cpuMs[p] * 1000.0
+                << ", \"args\": {\"frame\": " << record.frame << "}}";
+            // The GPU frame total would overlap its own phases on the track
+            if (record.gpuMs[p] >= 0.0f && p != static_cast<size_t>(ProfilePhase::Frame)) {
+                out << ",\n{\"name\": \"" << name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": 2, \"ts\": "
+                    << record.cpuStartUs[p] << ", \"dur\": " << record.gpuMs[p] * 1000.0
+                    << ", \"args\": {\"frame\": " << record.frame << "}}";
+            }
+        }
+    }
+    out << "\n]}\n";
+    if (!out) {
+        throw std::runtime_error("Failed to write trace file: " + path);
+    }
+}
+
+void FrameProfiler::writeCsv(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Failed to write trace file: " + path);
+    }
+    out << std::fixed << std::setprecision(3);
+    out << "frame,phase,cpu_start_us,cpu_ms,gpu_ms\n";
+    for (const FrameRecord& record : records) {
+        for (size_t p = 0; p < kPhases; p++) {
+            if (!record.timed[p]) continue;
+            out << record.frame << "," << profilePhaseName(static_cast<ProfilePhase>(p)) << ","
+                << record.cpuStartUs[p] << "," << record.cpuMs[p] << ",";
+            if (record.gpuMs[p] >= 0.0f) {
+                out << record.gpuMs[p];
+            }
+            out << "\n";
+        }
+    }
+    if (!out) {
+        throw std::runtime_error("Failed to write trace file: " + path);
+    }
+}
+
+} // namespace gsplat
@@ -1,64 +1,115 @@
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
 #include "GaussianData.h"
 
-#include "Utils.h"
+#include "PackKernels.h"
+#include "ThreadPool.h"
 
 namespace gsplat {
 
-void GaussianData::pack() {
+namespace {
+
+// Splats per parallel pack block
+constexpr size_t kPackBlockSize = 1 << 14;
+
+// Ranges split on the calling thread before the rest is shared out, per thread
+constexpr size_t kSplitRangesPerThread = 4;
+
+// Split [begin, end) of perm after its first half of chunks, by the longest
+// axis of its bounds; returns the split point
+size_t splitAtChunkMedian(std::vector<uint32_t>& perm, const std::vector<glm::vec3>& positions,
+                          size_t begin, size_t end) {
+    glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+    for (size_t i = begin; i < end; i++) {
+        lo = glm::min(lo, positions[perm[i]]);
+        hi = glm::max(hi, positions[perm[i]]);
+    }
+    glm::vec3 extent = hi - lo;
+    int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+    size_t chunks = (end - begin + kSplatChunkSize - 1) / kSplatChunkSize;
+    size_t mid = begin + chunks / 2 * kSplatChunkSize;
+    std::nth_element(perm.begin() + begin, perm.begin() + mid, perm.begin() + end,
+                     [&](uint32_t a, uint32_t b) { return positions[a][axis] < positions[b][axis]; });
+    return mid;
+}
+
+void splitIntoChunks(std::vector<uint32_t>& perm, const std::vector<glm::vec3>& positions,
+                     size_t begin, size_t end) {
+    if (end - begin <= kSplatChunkSize) return;
+    size_t mid = splitAtChunkMedian(perm, positions, begin, end);
+    splitIntoChunks(perm, positions, begin, mid);
+    splitIntoChunks(perm, positions, mid, end);
+}
+
+template <typename T>
+void applyPermutation(std::vector<T>& values, const std::vector<uint32_t>& perm, size_t stride) {
+    std::vector<T> sorted(values.size());
+    for (size_t i = 0; i < perm.size(); i++) {
+        std::copy_n(values.begin() + perm[i] * stride, stride, sorted.begin() + i * stride);
+    }
+    values.swap(sorted);
+}
+
+} // namespace
+
+void GaussianData::pack(ThreadPool* pool, SimdLevel level) {
     size_t n = positions.size();
+    bool compressed = format == SplatFormat::Compressed;
+    size_t chunks = (n + kSplatChunkSize - 1) / kSplatChunkSize;
+    
+    packedData.resize(n * splatWords(format));
+    chunkData.assign(compressed ? chunks * kChunkWords : 0, 0);
+    size_t shWords = shTexels(shDegree, shFormat) * 4;
+    shData.resize(n * shWords);
+    worldPositions.resize(n);
+    
+    // Contiguous blocks, a few per thread so uneven progress evens out
+    size_t blocks = 1;
+    if (pool && n >= 2 * kPackBlockSize) {
+        blocks = std::min((n + kPackBlockSize - 1) / kPackBlockSize, static_cast<size_t>(pool->size()) * 4);
+    }
+    std::vector<glm::vec3> blockMin(blocks, glm::vec3(FLT_MAX));
+    std::vector<glm::vec3> blockMax(blocks, glm::vec3(-FLT_MAX));
     
-    // Allocate packed data - 2 uvec4 per gaussian
-    packedData.resize(n * 8); // 8 uint32 per gaussian (2 uvec4)
-    worldPositions.resize(n * 3);
+    PackInput in = {positions.data(), scales.data(), rotations.data(), colors.data()};
+    auto packBlock = [&](uint32_t b) {
+        size_t begin = n * b / blocks;
+        size_t end = n * (b + 1) / blocks;
+        if (compressed) {
+            // Compressed blocks split at chunk boundaries
+            begin = std::min(n, chunks * b / blocks * kSplatChunkSize);
+            end = std::min(n, chunks * (b + 1) / blocks * kSplatChunkSize);
+            compressSplats(in, begin, end, packedData.data(), chunkData.data(),
+                           worldPositions.x.data(), worldPositions.y.data(), worldPositions.z.data());
+        } else {
+            packSplats(level, in, begin, end, packedData.data(),
+                       worldPositions.x.data(), worldPositions.y.data(), worldPositions.z.data());
+        }
+        if (shWords > 0) {
+            packSH(shDegree, shFormat, shRest.data(), begin, end, shData.data());
+        }
+        for (size_t i = begin; i < end; i++) {
+            blockMin[b] = glm::min(blockMin[b], positions[i]);
+            blockMax[b] = glm::max(blockMax[b], positions[i]);
+        }
+    };
+    if (blocks > 1) {
+        pool->run(static_cast<uint32_t>(blocks), packBlock);
+    } else {
+        packBlock(0);
+    }
     
-    for (size_t i = 0; i < n; i++) {
-        const glm::vec3& pos = positions[i];
-        const glm::vec3& scale = scales[i];
-        const glm::quat& rot = rotations[i];
-        const glm::u8vec4& color = colors[i];
-        
-        // First uvec4: position (xyz as floats reinterpreted as uint) + selection flag (w)
-        // Safe bit copy without violating strict aliasing
-        uint32_t ux, uy, uz;
-        std::memcpy(&ux, &pos.x, sizeof(uint32_t));
-        std::memcpy(&uy, &pos.y, sizeof(uint32_t));
-        std::memcpy(&uz, &pos.z, sizeof(uint32_t));
-        packedData[i * 8 + 0] = ux;
-        packedData[i * 8 + 1] = uy;
-        packedData[i * 8 + 2] = uz;
-        packedData[i * 8 + 3] = 0; // selection flag (0 = not selected)
-        
-        worldPositions[i * 3 + 0] = pos.x;
-        worldPositions[i * 3 + 1] = pos.y;
-        worldPositions[i * 3 + 2] = pos.z;
-        
-        // Convert quaternion to matrix for covariance
-        glm::mat3 rotMat = glm::mat3_cast(rot);
-        glm::mat3 scaleMat(0.0f);
-        scaleMat[0][0] = scale.x;
-        scaleMat[1][1] = scale.y;
-        scaleMat[2][2] = scale.z;
-        
-        glm::mat3 M = rotMat * scaleMat;
-        
-        // Compute 3D covariance (symmetric)
-        float sigma[6];
-        sigma[0] = M[0][0] * M[0][0] + M[1][0] * M[1][0] + M[2][0] * M[2][0]; // xx
-        sigma[1] = M[0][0] * M[0][1] + M[1][0] * M[1][1] + M[2][0] * M[2][1]; // xy
-        sigma[2] = M[0][0] * M[0][2] + M[1][0] * M[1][2] + M[2][0] * M[2][2]; // xz
-        sigma[3] = M[0][1] * M[0][1] + M[1][1] * M[1][1] + M[2][1] * M[2][1]; // yy
-        sigma[4] = M[0][1] * M[0][2] + M[1][1] * M[1][2] + M[2][1] * M[2][2]; // yz
-        sigma[5] = M[0][2] * M[0][2] + M[1][2] * M[1][2] + M[2][2] * M[2][2]; // zz
-        
-        // Second uvec4: covariance (xyz as half2) + color (w as packed RGBA)
-        // Pack covariance as half-precision floats: xy, xz|yy, yz|zz
-        packedData[i * 8 + 4] = packHalf2x16(sigma[0], sigma[1]); // xx, xy
-        packedData[i * 8 + 5] = packHalf2x16(sigma[2], sigma[3]); // xz, yy
-        packedData[i * 8 + 6] = packHalf2x16(sigma[4], sigma[5]); // yz, zz
-        
-        // Pack color as RGBA in a single uint32
-        uint32_t packedColor = color.r | (color.g << 8) | (color.b << 16) | (color.a << 24);
-        packedData[i * 8 + 7] = packedColor;
+    boundsMin = glm::vec3(n > 0 ? FLT_MAX : 0.0f);
+    boundsMax = glm::vec3(n > 0 ? -FLT_MAX : 0.0f);
+    if (n > 0) {
+        for (size_t b = 0; b < blocks; b++) {
+            boundsMin = glm::min(boundsMin, blockMin[b]);
+            boundsMax = glm::max(boundsMax, blockMax[b]);
+        }
     }
 }
 
@@ -67,8 +118,126 @@ void GaussianData::clear() {
     scales.clear();
     rotations.clear();
     colors.clear();
+    shRest.clear();
     packedData.clear();
+    chunkData.clear();
+    shData.clear();
+    shDegree = 0;
     worldPositions.clear();
+    boundsMin = glm::vec3(0.0f);
+    boundsMax = glm::vec3(0.0f);
+}
+
+void GaussianData::sortSpatially(ThreadPool* pool) {
+    size_t n = positions.size();
+    if (n <= kSplatChunkSize) return;
+    
+    std::vector<uint32_t> perm(n);
+    std::iota(perm.begin(), perm.end(), 0u);
+    
+    // Top splits breadth first, until there are enough ranges to share out.
+    // Only chunk boundaries are split, so the first range of every split
+    // holds whole chunks and a partial chunk can only come last.
+    std::vector<std::pair<size_t, size_t>> ranges = {{0, n}};
+    size_t wanted = pool ? pool->size() * kSplitRangesPerThread : 1;
+    while (ranges.size() < wanted) {
+        std::vector<std::pair<size_t, size_t>> next;
+        for (const auto& range : ranges) {
+            if (range.second - range.first <= kSplatChunkSize) {
+                next.push_back(range);
+                continue;
+            }
+            size_t mid = splitAtChunkMedian(perm, positions, range.first, range.second);
+            next.emplace_back(range.first, mid);
+            next.emplace_back(mid, range.second);
+        }
+        if (next.size() == ranges.size()) break;
+        ranges.swap(next);
+    }
+    auto splitRange = [&](uint32_t r) { splitIntoChunks(perm, positions, ranges[r].first, ranges[r].second); };
+    if (pool && ranges.size() > 1) {
+        pool->run(static_cast<uint32_t>(ranges.size()), splitRange);
+    } else {
+        for (uint32_t r = 0; r < ranges.size(); r++) splitRange(r);
+    }
+    
+    applyPermutation(positions, perm, 1);
+    applyPermutation(scales, perm, 1);
+    applyPermutation(rotations, perm, 1);
+    applyPermutation(colors, perm, 1);
+    if (!shRest.empty()) {
+        applyPermutation(shRest, perm, shRest.size() / n);
+    }
+}
+
+void GaussianData::releaseSource() {
+    // Swap with empties so the capacity is actually returned
+    std::vector<glm::vec3>().swap(positions);
+    std::vector<glm::vec3>().swap(scales);
+    std::vector<glm::quat>().swap(rotations);
+    std::vector<glm::u8vec4>().swap(colors);
+    std::vector<float>().swap(shRest);
+}
+
+void GaussianData::reportMemory(MemoryReport& report) const {
+    report.add("source attributes", vectorBytes(positions) + vectorBytes(scales) +
+                                    vectorBytes(rotations) + vectorBytes(colors) + vectorBytes(shRest));
+    report.add("packed splats", vectorBytes(packedData) + vectorBytes(chunkData));
+    report.add("packed harmonics", vectorBytes(shData));
+    report.add("sort positions", vectorBytes(worldPositions.x) + vectorBytes(worldPositions.y) +
+                                 vectorBytes(worldPositions.z));
+}
+
+void GaussianData::appendPacked(const GaussianData& other) {
+    if (other.count() == 0) return;
+    
+    if (count() == 0) {
+        format = other.format;
+        shDegree = other.shDegree;
+        shFormat = other.shFormat;
+        boundsMin = other.boundsMin;
+        boundsMax = other.boundsMax;
+    } else {
+        checkAppendable(other);
+        if (format == SplatFormat::Compressed && count() % kSplatChunkSize != 0) {
+            throw std::runtime_error("Compressed splats can only be appended at a chunk boundary");
+        }
+        boundsMin = glm::min(boundsMin, other.boundsMin);
+        boundsMax = glm::max(boundsMax, other.boundsMax);
+    }
+    
+    packedData.insert(packedData.end(), other.packedData.begin(), other.packedData.end());
+    chunkData.insert(chunkData.end(), other.chunkData.begin(), other.chunkData.end());
+    shData.insert(shData.end(), other.shData.begin(), other.shData.end());
+    worldPositions.x.insert(worldPositions.x.end(), other.worldPositions.x.begin(), other.worldPositions.x.end());
+    worldPositions.y.insert(worldPositions.y.end(), other.worldPositions.y.begin(), other.worldPositions.y.end());
+    worldPositions.z.insert(worldPositions.z.end(), other.worldPositions.z.begin(), other.worldPositions.z.end());
+}
+
+void GaussianData::checkAppendable(const GaussianData& other) const {
+    if (count() == 0 || other.count() == 0) return;
+    if (other.format != format) {
+        throw std::runtime_error("Cannot append splats in a different format");
+    }
+    if (other.shDegree != shDegree || (shDegree > 0 && other.shFormat != shFormat)) {
+        throw std::runtime_error("Cannot append splats with different spherical harmonics");
+    }
+}
+
+void GaussianData::padToChunk() {
+    size_t n = count();
+    if (format != SplatFormat::Compressed || n % kSplatChunkSize == 0) return;
+    
+    // The chunk's quantization range is already in chunkData. Zeroed splats
+    // dequantize to the chunk's position min, which the sorts must agree on.
+    size_t pad = kSplatChunkSize - n % kSplatChunkSize;
+    packedData.resize(packedData.size() + pad * splatWords(format), 0);
+    shData.resize(shData.size() + pad * shTexels(shDegree, shFormat) * 4, 0);
+    float chunkMin[3];
+    std::memcpy(chunkMin, chunkData.data() + (n / kSplatChunkSize) * kChunkWords, sizeof(chunkMin));
+    worldPositions.x.resize(n + pad, chunkMin[0]);
+    worldPositions.y.resize(n + pad, chunkMin[1]);
+    worldPositions.z.resize(n + pad, chunkMin[2]);
 }
 
 } // namespace gsplat
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "GpuSort.h"
+#include "Utils.h"
+
+namespace gsplat {
+
+namespace {
+
+// Must match the constants in the sort_*.comp shaders
+constexpr uint32_t kWorkGroupSize = 256;
+constexpr uint32_t kBlockSize = kWorkGroupSize * 16;
+constexpr uint32_t kRadixBits = 4;
+constexpr uint32_t kRadix = 1u << kRadixBits;
+// An even count, so the result lands back in the first index buffer
+constexpr uint32_t kPassCount = 32 / kRadixBits;
+// Minimum GL_MAX_COMPUTE_WORK_GROUP_COUNT guaranteed by the spec
+constexpr uint32_t kMaxWorkGroups = 65535;
+
+GLuint createComputeProgram(ProgramCache& programs, const std::string& name, const std::string& defines = "") {
+    return programs.build({{GL_COMPUTE_SHADER, withDefines(readShader(name), defines), name}});
+}
+
+void allocateBuffer(GLuint buffer, size_t bytes) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(bytes, 4), nullptr, GL_DYNAMIC_COPY);
+}
+
+} // namespace
+
+GpuSort::KeyProgram GpuSort::createKeyProgram(ProgramCache& programs, const std::string& defines) {
+    KeyProgram keys;
+    keys.program = createComputeProgram(programs, "sort_keys.comp", defines);
+    keys.u_texture = glGetUniformLocation(keys.program, "u_texture");
+    keys.u_chunks = glGetUniformLocation(keys.program, "u_chunks");
+    keys.u_instances = glGetUniformLocation(keys.program, "u_instances");
+    keys.u_axis = glGetUniformLocation(keys.program, "axis");
+    keys.u_count = glGetUniformLocation(keys.program, "count");
+    return keys;
+}
+
+GpuSort::GpuSort(ProgramCache* programCache)
+    : programCount(0)
+    , programScan(0)
+    , programScatter(0)
+    , keyBuffers{0, 0}
+    , indexBuffers{0, 0}
+    , histogramBuffer(0)
+    , splatCount(0)
+    , blockCount(0)
+    , hasPrevious(false)
+    , prevAxis{0.0f, 0.0f, 0.0f, 0.0f}
+{
+    ProgramCache uncached;
+    ProgramCache& programs = programCache ? *programCache : uncached;
+    keyPrograms[0] = createKeyProgram(programs, "");
+    keyPrograms[1] = createKeyProgram(programs, "COMPRESSED_SPLATS");
+    keyPrograms[2] = createKeyProgram(programs, "INSTANCES");
+    keyPrograms[3] = createKeyProgram(programs, "COMPRESSED_SPLATS INSTANCES");
+    programCount = createComputeProgram(programs, "sort_count.comp");
+    programScan = createComputeProgram(programs, "sort_scan.comp");
+    programScatter = createComputeProgram(programs, "sort_scatter.comp");
+    bool keysOk = std::all_of(std::begin(keyPrograms), std::end(keyPrograms),
+                              [](const KeyProgram& keys) { return keys.program != 0; });
+    if (!keysOk || programCount == 0 || programScan == 0 || programScatter == 0) {
+        for (const KeyProgram& keys : keyPrograms) {
+            glDeleteProgram(keys.program);
+        }
+        glDeleteProgram(programCount);
+        glDeleteProgram(programScan);
+        glDeleteProgram(programScatter);
+        throw std::runtime_error("Failed to create GPU sort programs");
+    }
+    
+    u_countCount = glGetUniformLocation(programCount, "count");
+    u_countShift = glGetUniformLocation(programCount, "shift");
+    u_countBlockCount = glGetUniformLocation(programCount, "blockCount");
+    u_scanSize = glGetUniformLocation(programScan, "size");
+    u_scatterCount = glGetUniformLocation(programScatter, "count");
+    u_scatterShift = glGetUniformLocation(programScatter, "shift");
+    u_scatterBlockCount = glGetUniformLocation(programScatter, "blockCount");
+    u_scatterFirstPass = glGetUniformLocation(programScatter, "firstPass");
+    
+    glGenBuffers(2, keyBuffers);
+    glGenBuffers(2, indexBuffers);
+    glGenBuffers(1, &histogramBuffer);
+    resize(0);
+}
+
+GpuSort::~GpuSort() {
+    for (const KeyProgram& keys : keyPrograms) {
+        glDeleteProgram(keys.program);
+    }
+    glDeleteProgram(programCount);
+    glDeleteProgram(programScan);
+    glDeleteProgram(programScatter);
+    glDeleteBuffers(2, keyBuffers);
+    glDeleteBuffers(2, indexBuffers);
+    glDeleteBuffers(1, &histogramBuffer);
+}
+
+bool GpuSort::isSupported() {
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    return major > 4 || (major == 4 && minor >= 3);
+}
+
+void GpuSort::resize(uint32_t count) {
+    splatCount = count;
+    blockCount = (count + kBlockSize - 1) / kBlockSize;
+    hasPrevious = false;
+    
+    size_t bytes = static_cast<size_t>(count) * sizeof(uint32_t);
+    for (int i = 0; i < 2; i++) {
+        allocateBuffer(keyBuffers[i], bytes);
+        allocateBuffer(indexBuffers[i], bytes);
+    }
+    allocateBuffer(histogramBuffer, static_cast<size_t>(kRadix) * blockCount * sizeof(uint32_t));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    checkGLError("Allocate GPU sort buffers");
+}
+
+bool GpuSort::sort(const glm::mat4& viewProj, const SplatTexture& splats, GLuint instances) {
+    if (splatCount == 0) return false;
+    
+    // As on the CPU, the order only depends on the depth axis
+    DepthAxis axis = depthAxisFromViewProj(viewProj);
+    if (hasPrevious && std::memcmp(&axis, &prevAxis, sizeof(DepthAxis)) == 0) {
+        return false;
+    }
+    
+    // Keys
+    const KeyProgram& keys =
+        keyPrograms[(splats.getFormat() == SplatFormat::Compressed ? 1 : 0) + (instances != 0 ? 2 : 0)];
+    glUseProgram(keys.program);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, splats.getTexture());
+    glUniform1i(keys.u_texture, 0);
+    if (splats.getChunkTexture()) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, splats.getChunkTexture());
+        glUniform1i(keys.u_chunks, 1);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    if (instances != 0) {
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, instances);
+        glUniform1i(keys.u_instances, 3);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    glUniform4f(keys.u_axis, axis.x, axis.y, axis.z, axis.w);
+    glUniform1ui(keys.u_count, splatCount);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, keyBuffers[0]);
+    uint32_t keyGroups = std::min((splatCount + kWorkGroupSize - 1) / kWorkGroupSize, kMaxWorkGroups);
+    glDispatchCompute(keyGroups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    
+    // Radix passes, least significant digit first
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, histogramBuffer);
+    for (uint32_t pass = 0; pass < kPassCount; pass++) {
+        uint32_t src = pass & 1;
+        uint32_t dst = src ^ 1;
+        uint32_t shift = pass * kRadixBits;
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, keyBuffers[src]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, keyBuffers[dst]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, indexBuffers[src]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, indexBuffers[dst]);
+        
+        glUseProgram(programCount);
+        glUniform1ui(u_countCount, splatCount);
+        glUniform1ui(u_countShift, shift);
+        glUniform1ui(u_countBlockCount, blockCount);
+        glDispatchCompute(blockCount, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        
+        glUseProgram(programScan);
+        glUniform1ui(u_scanSize, kRadix * blockCount);
+        glDispatchCompute(1, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        
+        glUseProgram(programScatter);
+        glUniform1ui(u_scatterCount, splatCount);
+        glUniform1ui(u_scatterShift, shift);
+        glUniform1ui(u_scatterBlockCount, blockCount);
+        glUniform1i(u_scatterFirstPass, pass == 0);
+        glDispatchCompute(blockCount, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+    
+    for (GLuint binding = 0; binding <= 4; binding++) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+    }
+    // The order is consumed as a vertex attribute next
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    checkGLError("GPU sort");
+    
+    prevAxis = axis;
+    hasPrevious = true;
+    return true;
+}
+
+void GpuSort::reportMemory(MemoryReport& report) const {
+    size_t bytes = static_cast<size_t>(splatCount) * sizeof(uint32_t);
+    report.add("GPU sort indices", 2 * bytes, true);
+    report.add("GPU sort keys", 2 * bytes + static_cast<size_t>(kRadix) * blockCount * sizeof(uint32_t), true);
+}
+
+void GpuSort::readIndices(std::vector<uint32_t>& out) {
+    out.resize(splatCount);
+    if (splatCount == 0) return;
+    
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, indexBuffers[0]);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, splatCount * sizeof(uint32_t), out.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+} // namespace gsplat
@@ -0,0 +1,124 @@
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "glad/glad.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "HeadlessContext.h"
+
+namespace gsplat {
+
+namespace {
+
+bool hasExtension(const char* extensions, const char* name) {
+    if (!extensions) return false;
+    size_t length = std::strlen(name);
+    for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + length, name)) {
+        if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0')) return true;
+    }
+    return false;
+}
+
+// Displays to try, most capable first, with a name for each
+std::vector<std::pair<EGLDisplay, std::string>> candidateDisplays() {
+    std::vector<std::pair<EGLDisplay, std::string>> displays;
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+    if (getPlatformDisplay && hasExtension(clientExtensions, "EGL_EXT_platform_device")) {
+        auto queryDevices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(eglGetProcAddress("eglQueryDevicesEXT"));
+        EGLDeviceEXT devices[16];
+        EGLint deviceCount = 0;
+        if (queryDevices && queryDevices(16, devices, &deviceCount)) {
+            for (EGLint i = 0; i < deviceCount; i++) {
+                EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, devices[i], nullptr);
+                if (display != EGL_NO_DISPLAY) {
+                    displays.emplace_back(display, "EGL device " + std::to_string(i));
+                }
+            }
+        }
+    }
+    if (getPlatformDisplay && hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY) {
+            displays.emplace_back(display, "EGL surfaceless");
+        }
+    }
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY) {
+        displays.emplace_back(display, "EGL default display");
+    }
+    return displays;
+}
+
+// A current context on display, or EGL_NO_CONTEXT
+EGLContext createContext(EGLDisplay display, int major, int minor) {
+    const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (!hasExtension(extensions, "EGL_KHR_surfaceless_context") || !eglBindAPI(EGL_OPENGL_API)) {
+        return EGL_NO_CONTEXT;
+    }
+    EGLConfig config = nullptr;
+    if (!hasExtension(extensions, "EGL_KHR_no_config_context")) {
+        const EGLint configAttribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+        EGLint configCount = 0;
+        if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0) {
+            return EGL_NO_CONTEXT;
+        }
+    }
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, major,
+        EGL_CONTEXT_MINOR_VERSION, minor,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) return EGL_NO_CONTEXT;
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        eglDestroyContext(display, context);
+        return EGL_NO_CONTEXT;
+    }
+    return context;
+}
+
+} // namespace
+
+HeadlessContext::HeadlessContext(int major, int minor)
+    : display(EGL_NO_DISPLAY)
+    , context(EGL_NO_CONTEXT)
+{
+    for (const auto& candidate : candidateDisplays()) {
+        if (!eglInitialize(candidate.first, nullptr, nullptr)) continue;
+        EGLContext created = createContext(candidate.first, major, minor);
+        if (created == EGL_NO_CONTEXT) {
+            eglTerminate(candidate.first);
+            continue;
+        }
+        display = candidate.first;
+        context = created;
+        const char* vendor = eglQueryString(candidate.first, EGL_VENDOR);
+        description = candidate.second + (vendor ? std::string(", ") + vendor : std::string());
+        break;
+    }
+    if (context == EGL_NO_CONTEXT) {
+        throw std::runtime_error("No EGL platform gives an OpenGL " + std::to_string(major) + "." +
+                                 std::to_string(minor) + " core context");
+    }
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress))) {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+        throw std::runtime_error("Failed to load OpenGL functions through EGL");
+    }
+}
+
+HeadlessContext::~HeadlessContext() {
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+}
+
+} // namespace gsplat
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "ImageWriter.h"
+
+namespace gsplat {
+
+namespace {
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void appendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void writeChunk(std::ofstream& file, const char type[4], const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    appendBigEndian(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    appendBigEndian(chunk, crc32(chunk.data() + 4, data.size() + 4));
+    file.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+}
+
+} // namespace
+
+ImageWriter::ImageWriter(size_t maxQueued)
+    : maxQueued(std::max<size_t>(maxQueued, 1))
+    , stopping(false)
+    , busy(false)
+    , written(0)
+{
+    thread = std::thread(&ImageWriter::run, this);
+}
+
+ImageWriter::~ImageWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queueCv.notify_all();
+    thread.join();
+}
+
+void ImageWriter::write(const std::string& path, int width, int height, std::vector<uint8_t>&& rgb) {
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCv.wait(lock, [this] { return queue.size() < maxQueued || !error.empty(); });
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+    queue.push_back({path, width, height, std::move(rgb)});
+    lock.unlock();
+    queueCv.notify_one();
+}
+
+void ImageWriter::finish() {
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCv.wait(lock, [this] { return (queue.empty() && !busy) || !error.empty(); });
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+}
+
+size_t ImageWriter::getWrittenCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return written;
+}
+
+void ImageWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        queueCv.wait(lock, [this] { return !queue.empty() || stopping; });
+        // Queued images are still written when stopping
+        if (queue.empty() || !error.empty()) return;
+
+        Image image = std::move(queue.front());
+        queue.pop_front();
+        busy = true;
+        doneCv.notify_all();
+
+        lock.unlock();
+        std::string failure;
+        try {
+            writePng(image.path, image.width, image.height, image.rgb.data());
+        } catch (const std::exception& e) {
+            failure = e.what();
+        }
+        lock.lock();
+
+        busy = false;
+        if (failure.empty()) {
+            written++;
+        } else {
+            error = failure;
+        }
+        doneCv.notify_all();
+    }
+}
+
+void ImageWriter::writePng(const std::string& path, int width, int height, const uint8_t* rgb) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to create image file: " + path);
+    }
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    std::vector<uint8_t> header;
+    appendBigEndian(header, static_cast<uint32_t>(width));
+    appendBigEndian(header, static_cast<uint32_t>(height));
+    header.insert(header.end(), {8, 2, 0, 0, 0});  // 8-bit RGB, no interlace
+    writeChunk(file, "IHDR", header);
+
+    // Rows with filter type 0, as a zlib stream of stored deflate blocks
+    const size_t rowBytes = static_cast<size_t>(width) * 3;
+    std::vector<uint8_t> raw;
+    raw.reserve((rowBytes + 1) * height);
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb + y * rowBytes, rgb + (y + 1) * rowBytes);
+    }
+    std::vector<uint8_t> zlib = {0x78, 0x01};
+    zlib.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    uint32_t a = 1, b = 0;
+    size_t offset = 0;
+    do {
+        size_t block = std::min<size_t>(raw.size() - offset, 65535);
+        bool final = offset + block == raw.size();
+        zlib.push_back(final ? 1 : 0);
+        zlib.push_back(static_cast<uint8_t>(block));
+        zlib.push_back(static_cast<uint8_t>(block >> 8));
+        zlib.push_back(static_cast<uint8_t>(~block));
+        zlib.push_back(static_cast<uint8_t>(~block >> 8));
+        // Adler-32; 5552 bytes is the most that cannot overflow between reductions
+        for (size_t i = offset; i < offset + block;) {
+            for (size_t end = std::min(i + 5552, offset + block); i < end; i++) {
+                a += raw[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + block);
+        offset += block;
+    } while (offset < raw.size());
+    appendBigEndian(zlib, (b << 16) | a);
+    writeChunk(file, "IDAT", zlib);
+    writeChunk(file, "IEND", {});
+
+    if (!file) {
+        throw std::runtime_error("Failed to write image file: " + path);
+    }
+}
+
+} // namespace gsplat
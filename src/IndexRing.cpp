@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "IndexRing.h"
+#include "Utils.h"
+
+namespace gsplat {
+
+IndexRing::IndexRing()
+    : buffer(0)
+    , mapped(nullptr)
+    , capacity(0)
+    , current(0)
+    , fences{nullptr, nullptr, nullptr}
+{
+}
+
+IndexRing::~IndexRing() {
+    for (GLsync& sync : fences) {
+        if (sync) glDeleteSync(sync);
+    }
+    if (buffer) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glDeleteBuffers(1, &buffer);
+    }
+}
+
+bool IndexRing::isSupported() {
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major > 4 || (major == 4 && minor >= 4)) return true;
+    
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions; i++) {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && std::strcmp(name, "GL_ARB_buffer_storage") == 0) return true;
+    }
+    return false;
+}
+
+void IndexRing::allocate(size_t count) {
+    // Every region may still be read by a queued draw
+    for (int i = 0; i < kSlots; i++) {
+        waitSlot(i);
+    }
+    if (buffer) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glDeleteBuffers(1, &buffer);
+    }
+    
+    capacity = count;
+    current = 0;
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr bytes = static_cast<GLsizeiptr>(kSlots * capacity * sizeof(uint32_t));
+    
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, flags);
+    mapped = static_cast<uint32_t*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags));
+    checkGLError("Allocate index ring");
+    if (!mapped) {
+        throw std::runtime_error("Failed to map index ring buffer");
+    }
+}
+
+void IndexRing::waitSlot(int slot) {
+    GLsync& sync = fences[slot];
+    if (!sync) return;
+    
+    // Flush on the first wait so the fence is guaranteed to signal
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (glClientWaitSync(sync, flags, 1000000000) == GL_TIMEOUT_EXPIRED) {
+        flags = 0;
+    }
+    glDeleteSync(sync);
+    sync = nullptr;
+}
+
+uint32_t* IndexRing::beginWrite(size_t count) {
+    if (count > capacity) {
+        // Grow with headroom so streamed scenes do not reallocate every chunk
+        allocate(std::max(count, capacity * 3 / 2));
+    }
+    int next = (current + 1) % kSlots;
+    waitSlot(next);
+    return mapped + static_cast<size_t>(next) * capacity;
+}
+
+void IndexRing::endWrite() {
+    current = (current + 1) % kSlots;
+}
+
+void IndexRing::fence() {
+    if (!buffer) return;
+    if (fences[current]) glDeleteSync(fences[current]);
+    fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+} // namespace gsplat
@@ -0,0 +1,143 @@
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "Json.h"
+
+namespace gsplat {
+
+namespace {
+
+class JsonParser {
+public:
+    JsonParser(const std::string& text, const std::string& path) : text(text), path(path), pos(0) {}
+
+    JsonValue parseDocument() {
+        JsonValue value = parseValue();
+        skipSpace();
+        if (pos != text.size()) fail("trailing characters");
+        return value;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("Invalid JSON in " + path + " at byte " + std::to_string(pos) + ": " + what);
+    }
+
+    void skipSpace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+            pos++;
+        }
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) fail(std::string("expected '") + c + "'");
+    }
+
+    bool consumeWord(const char* word) {
+        size_t length = std::strlen(word);
+        if (text.compare(pos, length, word) != 0) return false;
+        pos += length;
+        return true;
+    }
+
+    JsonValue parseValue() {
+        skipSpace();
+        if (pos >= text.size()) fail("unexpected end");
+        JsonValue value;
+        char c = text[pos];
+        if (c == '{') {
+            pos++;
+            value.type = JsonValue::Type::Object;
+            if (consume('}')) return value;
+            do {
+                skipSpace();
+                std::string key = parseString();
+                expect(':');
+                value.members.emplace_back(std::move(key), parseValue());
+            } while (consume(','));
+            expect('}');
+        } else if (c == '[') {
+            pos++;
+            value.type = JsonValue::Type::Array;
+            if (consume(']')) return value;
+            do {
+                value.items.push_back(parseValue());
+            } while (consume(','));
+            expect(']');
+        } else if (c == '"') {
+            value.type = JsonValue::Type::String;
+            value.string = parseString();
+        } else if (consumeWord("true")) {
+            value.type = JsonValue::Type::Bool;
+            value.number = 1.0;
+        } else if (consumeWord("false")) {
+            value.type = JsonValue::Type::Bool;
+        } else if (consumeWord("null")) {
+            value.type = JsonValue::Type::Null;
+        } else {
+            const char* begin = text.c_str() + pos;
+            char* end = nullptr;
+            value.number = std::strtod(begin, &end);
+            if (end == begin) fail("unexpected character");
+            value.type = JsonValue::Type::Number;
+            pos += end - begin;
+        }
+        return value;
+    }
+
+    std::string parseString() {
+        if (pos >= text.size() || text[pos] != '"') fail("expected a string");
+        pos++;
+        std::string out;
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) break;
+            char escaped = text[pos++];
+            switch (escaped) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    if (pos + 4 > text.size()) fail("short \\u escape");
+                    unsigned code = static_cast<unsigned>(std::strtoul(text.substr(pos, 4).c_str(), nullptr, 16));
+                    pos += 4;
+                    // Names only need to survive as file names; keep ASCII, replace the rest
+                    out += code < 0x80 ? static_cast<char>(code) : '_';
+                    break;
+                }
+                default: out += escaped; break;
+            }
+        }
+        if (pos >= text.size()) fail("unterminated string");
+        pos++;
+        return out;
+    }
+
+    const std::string& text;
+    const std::string& path;
+    size_t pos;
+};
+
+} // namespace
+
+JsonValue parseJson(const std::string& text, const std::string& path) {
+    return JsonParser(text, path).parseDocument();
+}
+
+} // namespace gsplat
@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include "LodTree.h"
+
+namespace gsplat {
+
+namespace {
+
+// Source splats below a node, as a range of the build permutation
+struct SplatRange {
+    uint32_t begin;
+    uint32_t end;
+};
+
+// Weighted moments of the source splats below a node
+struct Moments {
+    float weight;          // Sum of opacity * area
+    glm::vec3 mean;
+    float cov[6];          // xx, xy, xz, yy, yz, zz
+    glm::vec3 color;       // Weighted mean, 0 to 255
+};
+
+// Split range into up to 2^levels parts at the median of the longest axis
+void splitRange(std::vector<uint32_t>& perm, const std::vector<glm::vec3>& positions, SplatRange range,
+                int levels, std::vector<SplatRange>& parts) {
+    if (levels == 0 || range.end - range.begin == 1) {
+        parts.push_back(range);
+        return;
+    }
+    glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+    for (uint32_t i = range.begin; i < range.end; i++) {
+        lo = glm::min(lo, positions[perm[i]]);
+        hi = glm::max(hi, positions[perm[i]]);
+    }
+    glm::vec3 extent = hi - lo;
+    int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+    uint32_t mid = range.begin + (range.end - range.begin) / 2;
+    std::nth_element(perm.begin() + range.begin, perm.begin() + mid, perm.begin() + range.end,
+                     [&](uint32_t a, uint32_t b) { return positions[a][axis] < positions[b][axis]; });
+    splitRange(perm, positions, {range.begin, mid}, levels - 1, parts);
+    splitRange(perm, positions, {mid, range.end}, levels - 1, parts);
+}
+
+// Projected-area proxy of a Gaussian: its largest cross-section
+float crossSection(const glm::vec3& scale) {
+    float smallest = std::min(scale.x, std::min(scale.y, scale.z));
+    return 3.14159265f * scale.x * scale.y * scale.z / std::max(smallest, 1e-20f);
+}
+
+// Eigen-decomposition of a symmetric 3x3 matrix by cyclic Jacobi rotations.
+// vectors holds the eigenvectors as columns.
+void eigenSymmetric(const float cov[6], glm::vec3& values, glm::mat3& vectors) {
+    double a[3][3] = {{cov[0], cov[1], cov[2]}, {cov[1], cov[3], cov[4]}, {cov[2], cov[4], cov[5]}};
+    double v[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    for (int sweep = 0; sweep < 16; sweep++) {
+        double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        if (off < 1e-30) break;
+        for (int p = 0; p < 2; p++) {
+            for (int q = p + 1; q < 3; q++) {
+                if (a[p][q] == 0.0) continue;
+                double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0), s = t * c;
+                for (int k = 0; k < 3; k++) {
+                    double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double vkp = v[k][p], vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    for (int c = 0; c < 3; c++) {
+        values[c] = static_cast<float>(a[c][c]);
+        for (int r = 0; r < 3; r++) {
+            vectors[c][r] = static_cast<float>(v[r][c]);
+        }
+    }
+}
+
+// Scale and rotation whose R S S^T R^T is cov
+void decomposeCovariance(const float cov[6], glm::vec3& scale, glm::quat& rotation) {
+    glm::vec3 values;
+    glm::mat3 vectors;
+    eigenSymmetric(cov, values, vectors);
+    // A proper rotation: flip one axis of a reflection
+    if (glm::dot(glm::cross(vectors[0], vectors[1]), vectors[2]) < 0.0f) {
+        vectors[2] = -vectors[2];
+    }
+    for (int c = 0; c < 3; c++) {
+        scale[c] = std::sqrt(std::max(values[c], 1e-20f));
+    }
+    rotation = glm::normalize(glm::quat_cast(vectors));
+}
+
+} // namespace
+
+LodTree LodTree::build(GaussianData& data, ThreadPool* pool) {
+    LodTree tree;
+    size_t n = data.positions.size();
+    if (n == 0) {
+        if (data.count() > 0) {
+            throw std::runtime_error("LOD tree needs the scene's source attributes");
+        }
+        return tree;
+    }
+    if (n >= UINT32_MAX / 2) {
+        throw std::runtime_error("Scene too large for a LOD tree");
+    }
+
+    // Topology, breadth first: children of each node are appended together
+    std::vector<uint32_t> perm(n);
+    std::iota(perm.begin(), perm.end(), 0u);
+    std::vector<SplatRange> ranges = {{0, static_cast<uint32_t>(n)}};
+    std::vector<SplatRange> parts;
+    tree.nodes.push_back({});
+    for (size_t k = 0; k < tree.nodes.size(); k++) {
+        SplatRange range = ranges[k];
+        uint32_t count = range.end - range.begin;
+        if (count == 1) continue;
+        parts.clear();
+        if (count <= kFanout) {
+            for (uint32_t i = range.begin; i < range.end; i++) {
+                parts.push_back({i, i + 1});
+            }
+        } else {
+            splitRange(perm, data.positions, range, 3, parts);
+        }
+        tree.nodes[k].firstChild = static_cast<uint32_t>(tree.nodes.size());
+        tree.nodes[k].childCount = static_cast<uint32_t>(parts.size());
+        for (const SplatRange& part : parts) {
+            tree.nodes.push_back({});
+            ranges.push_back(part);
+        }
+    }
+
+    // Moments bottom up; children always follow their parent
+    size_t nodeCount = tree.nodes.size();
+    size_t coefficients = shCoefficients(data.shDegree) * 3;
+    GaussianData out;
+    out.format = data.format;
+    out.shDegree = data.shDegree;
+    out.shFormat = data.shFormat;
+    out.positions.resize(nodeCount);
+    out.scales.resize(nodeCount);
+    out.rotations.resize(nodeCount);
+    out.colors.resize(nodeCount);
+    out.shRest.resize(nodeCount * coefficients);
+    std::vector<Moments> moments(nodeCount);
+
+    for (size_t k = nodeCount; k-- > 0;) {
+        LodNode& node = tree.nodes[k];
+        Moments& m = moments[k];
+        if (node.childCount == 0) {
+            // A source splat, kept exactly
+            uint32_t s = perm[ranges[k].begin];
+            out.positions[k] = data.positions[s];
+            out.scales[k] = data.scales[s];
+            out.rotations[k] = data.rotations[s];
+            out.colors[k] = data.colors[s];
+            std::copy_n(data.shRest.begin() + s * coefficients, coefficients, out.shRest.begin() + k * coefficients);
+
+            const glm::vec3& scale = data.scales[s];
+            m.weight = std::max(data.colors[s].a / 255.0f * crossSection(scale), 1e-30f);
+            m.mean = data.positions[s];
+            glm::mat3 r = glm::mat3_cast(data.rotations[s]);
+            r[0] *= scale.x;
+            r[1] *= scale.y;
+            r[2] *= scale.z;
+            glm::mat3 sigma = r * glm::transpose(r);
+            m.cov[0] = sigma[0][0]; m.cov[1] = sigma[0][1]; m.cov[2] = sigma[0][2];
+            m.cov[3] = sigma[1][1]; m.cov[4] = sigma[1][2]; m.cov[5] = sigma[2][2];
+            m.color = glm::vec3(data.colors[s].r, data.colors[s].g, data.colors[s].b);
+            node.center = m.mean;
+            node.radius = 3.0f * std::max(scale.x, std::max(scale.y, scale.z));
+            continue;
+        }
+
+        // Merged Gaussian: weighted mean, and covariance including the spread of the children
+        m.weight = 0.0f;
+        m.mean = glm::vec3(0.0f);
+        m.color = glm::vec3(0.0f);
+        std::fill(m.cov, m.cov + 6, 0.0f);
+        float* rest = out.shRest.data() + k * coefficients;
+        for (uint32_t c = node.firstChild; c < node.firstChild + node.childCount; c++) {
+            m.weight += moments[c].weight;
+            m.mean += moments[c].weight * moments[c].mean;
+        }
+        m.mean /= m.weight;
+        for (uint32_t c = node.firstChild; c < node.firstChild + node.childCount; c++) {
+            const Moments& child = moments[c];
+            float w = child.weight / m.weight;
+            glm::vec3 d = child.mean - m.mean;
+            m.cov[0] += w * (child.cov[0] + d.x * d.x);
+            m.cov[1] += w * (child.cov[1] + d.x * d.y);
+            m.cov[2] += w * (child.cov[2] + d.x * d.z);
+            m.cov[3] += w * (child.cov[3] + d.y * d.y);
+            m.cov[4] += w * (child.cov[4] + d.y * d.z);
+            m.cov[5] += w * (child.cov[5] + d.z * d.z);
+            m.color += w * child.color;
+            const float* childRest = out.shRest.data() + c * coefficients;
+            for (size_t j = 0; j < coefficients; j++) {
+                rest[j] += w * childRest[j];
+            }
+        }
+
+        glm::vec3 scale;
+        decomposeCovariance(m.cov, scale, out.rotations[k]);
+        out.positions[k] = m.mean;
+        out.scales[k] = scale;
+        // Opacity spreads the children's covered area over the parent's
+        float alpha = std::min(1.0f, m.weight / crossSection(scale));
+        auto toByte = [](float v) { return static_cast<uint8_t>(std::lround(std::clamp(v, 0.0f, 255.0f))); };
+        out.colors[k] = glm::u8vec4(toByte(m.color.r), toByte(m.color.g), toByte(m.color.b), toByte(alpha * 255.0f));
+
+        node.center = m.mean;
+        node.radius = 0.0f;
+        for (uint32_t c = node.firstChild; c < node.firstChild + node.childCount; c++) {
+            const LodNode& child = tree.nodes[c];
+            node.radius = std::max(node.radius, glm::length(child.center - node.center) + child.radius);
+        }
+    }
+
+    out.pack(pool);
+    data = std::move(out);
+    return tree;
+}
+
+void LodTree::selectCut(const glm::vec3& eye, float focal, float pixelError, size_t budget, size_t resident,
+                        std::vector<uint32_t>& cut) {
+    cut.clear();
+    heap.clear();
+    if (nodes.empty() || resident == 0) return;
+
+    // Radius in pixels of a node's bounds; unbounded with the eye inside them
+    auto projected = [&](uint32_t k) {
+        float distance = glm::length(nodes[k].center - eye) - nodes[k].radius;
+        return distance > 0.0f ? focal * nodes[k].radius / distance : FLT_MAX;
+    };
+
+    heap.emplace_back(projected(0), 0u);
+    size_t drawn = 1;
+    while (!heap.empty() && heap.front().first > pixelError) {
+        std::pop_heap(heap.begin(), heap.end());
+        uint32_t k = heap.back().second;
+        heap.pop_back();
+        const LodNode& node = nodes[k];
+        bool fits = budget == 0 || drawn - 1 + node.childCount <= budget;
+        if (node.childCount == 0 || !fits || node.firstChild + node.childCount > resident) {
+            cut.push_back(k);
+            continue;
+        }
+        drawn += node.childCount - 1;
+        for (uint32_t c = node.firstChild; c < node.firstChild + node.childCount; c++) {
+            if (nodes[c].childCount == 0) {
+                cut.push_back(c);
+            } else {
+                heap.emplace_back(projected(c), c);
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+    }
+    for (const auto& entry : heap) {
+        cut.push_back(entry.second);
+    }
+}
+
+void LodTree::reportMemory(MemoryReport& report) const {
+    report.add("LOD tree", vectorBytes(nodes) + vectorBytes(heap));
+}
+
+} // namespace gsplat
@@ -0,0 +1,40 @@
+#include <iomanip>
+
+#include "MemoryReport.h"
+
+namespace gsplat {
+
+void MemoryReport::add(const std::string& name, size_t bytes, bool gpu) {
+    entries.push_back({name, bytes, gpu});
+}
+
+size_t MemoryReport::totalBytes(bool gpu) const {
+    size_t total = 0;
+    for (const Entry& entry : entries) {
+        if (entry.gpu == gpu) total += entry.bytes;
+    }
+    return total;
+}
+
+void MemoryReport::print(std::ostream& out) const {
+    auto megabytes = [](size_t bytes) { return bytes / (1024.0 * 1024.0); };
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    
+    for (bool gpu : {false, true}) {
+        out << (gpu ? "GPU memory:" : "CPU memory:") << std::endl;
+        for (const Entry& entry : entries) {
+            if (entry.gpu != gpu || entry.bytes == 0) continue;
+            out << "  " << std::left << std::setw(28) << entry.name << std::right
+                << std::setw(10) << megabytes(entry.bytes) << " MB" << std::endl;
+        }
+        out << "  " << std::left << std::setw(28) << "total" << std::right
+            << std::setw(10) << megabytes(totalBytes(gpu)) << " MB" << std::endl;
+    }
+    
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace gsplat
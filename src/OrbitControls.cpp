@@ -29,6 +29,7 @@ OrbitControls::OrbitControls(GLFWwindow* window, Camera* camera)
     , rotating(false)
     , panning(false)
     , distance(5.0f)
+    , maxDistance(100.0f)
     , theta(0.0f)
     , phi(M_PI / 4.0f)
     , targetPos(0.0f, 0.0f, 0.0f)
@@ -59,9 +60,16 @@ void OrbitControls::reset() {
     targetPos = glm::vec3(0.0f, 0.0f, 0.0f);
 }
 
-void OrbitControls::handleMouseButton(int button, int action, [[maybe_unused]] int mods) {
+void OrbitControls::frame(const glm::vec3& target, float distance) {
+    targetPos = target;
+    this->distance = distance;
+    maxDistance = std::max(100.0f, distance * 4.0f);
+}
+
+void OrbitControls::handleMouseButton(int button, int action, int mods) {
     if (button == GLFW_MOUSE_BUTTON_LEFT) {
-        if (action == GLFW_PRESS) {
+        // Shift-drag paints the selection instead
+        if (action == GLFW_PRESS && !(mods & GLFW_MOD_SHIFT)) {
             rotating = true;
             glfwGetCursorPos(window, &lastX, &lastY);
         } else if (action == GLFW_RELEASE) {
@@ -106,7 +114,7 @@ void OrbitControls::handleMouseMove(double xpos, double ypos) {
 
 void OrbitControls::handleScroll([[maybe_unused]] double xoffset, double yoffset) {
     distance -= yoffset * zoomSpeed * distance;
-    distance = std::max(0.1f, std::min(100.0f, distance));
+    distance = std::max(0.1f, std::min(maxDistance, distance));
 }
 
 } // namespace gsplat
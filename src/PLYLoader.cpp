@@ -7,7 +7,8 @@
 
 namespace gsplat {
 
-GaussianData PLYLoader::load(const std::string& path) {
+GaussianData PLYLoader::load(const std::string& path, ThreadPool* pool, bool keepSource, const SplatLayout& layout,
+                             bool spatialOrder) {
     std::ifstream ss(path, std::ios::binary);
     if (!ss.is_open()) {
         throw std::runtime_error("Failed to open PLY file: " + path);
@@ -91,6 +92,25 @@ GaussianData PLYLoader::load(const std::string& path) {
         // Default full opacity
     }
     
+    // Higher harmonic bands, f_rest_0 onwards, all channels in one buffer
+    std::shared_ptr<tinyply::PlyData> rest;
+    size_t restCount = 0;
+    for (const tinyply::PlyElement& element : file.get_elements()) {
+        if (element.name != "vertex") continue;
+        while (std::any_of(element.properties.begin(), element.properties.end(),
+                           [&](const tinyply::PlyProperty& p) { return p.name == "f_rest_" + std::to_string(restCount); })) {
+            restCount++;
+        }
+    }
+    int shDegree = hasSH ? std::min(layout.shDegree, shDegreeFor(restCount)) : 0;
+    if (shDegree > 0) {
+        std::vector<std::string> names;
+        for (size_t k = 0; k < restCount; k++) {
+            names.push_back("f_rest_" + std::to_string(k));
+        }
+        rest = file.request_properties_from_element("vertex", names);
+    }
+    
     file.read(ss);
     
     size_t vertexCount = vertices_x->count;
@@ -98,6 +118,9 @@ GaussianData PLYLoader::load(const std::string& path) {
     data.scales.resize(vertexCount);
     data.rotations.resize(vertexCount);
     data.colors.resize(vertexCount);
+    data.shDegree = shDegree;
+    data.shFormat = layout.shFormat;
+    data.shRest.resize(vertexCount * 3 * shCoefficients(shDegree));
     
     const float* x_data = reinterpret_cast<const float*>(vertices_x->buffer.get());
     const float* y_data = reinterpret_cast<const float*>(vertices_y->buffer.get());
@@ -121,53 +144,115 @@ GaussianData PLYLoader::load(const std::string& path) {
     const int* blue_data = hasRGB ? reinterpret_cast<const int*>(blue->buffer.get()) : nullptr;
     
     const float* opacity_data = opacity ? reinterpret_cast<const float*>(opacity->buffer.get()) : nullptr;
+    const float* rest_data = rest ? reinterpret_cast<const float*>(rest->buffer.get()) : nullptr;
+    size_t restPerChannel = restCount / 3;
+    size_t keptCoefficients = shCoefficients(shDegree);
     
+    PLYVertex v = {};
+    v.hasSH = hasSH;
+    v.hasRGB = hasRGB;
+    v.hasOpacity = opacity_data != nullptr;
     for (size_t i = 0; i < vertexCount; i++) {
-        // Position
-        data.positions[i] = glm::vec3(x_data[i], y_data[i], z_data[i]);
-        
-        // Scale (exponential)
-        data.scales[i] = glm::vec3(
-            std::exp(scale_0_data[i]),
-            std::exp(scale_1_data[i]),
-            std::exp(scale_2_data[i])
-        );
-        
-        // Rotation (quaternion - note: different convention)
-        glm::quat q(rot_0_data[i], rot_1_data[i], rot_2_data[i], rot_3_data[i]);
-        data.rotations[i] = glm::normalize(q);
-        
-        // Color
-        uint8_t r, g, b, a;
-        
+        v.x = x_data[i];
+        v.y = y_data[i];
+        v.z = z_data[i];
+        v.scale[0] = scale_0_data[i];
+        v.scale[1] = scale_1_data[i];
+        v.scale[2] = scale_2_data[i];
+        v.rot[0] = rot_0_data[i];
+        v.rot[1] = rot_1_data[i];
+        v.rot[2] = rot_2_data[i];
+        v.rot[3] = rot_3_data[i];
         if (hasSH) {
-            // Spherical harmonics to RGB
-            r = static_cast<uint8_t>(std::clamp((0.5f + SH_C0 * f_dc_0_data[i]) * 255.0f, 0.0f, 255.0f));
-            g = static_cast<uint8_t>(std::clamp((0.5f + SH_C0 * f_dc_1_data[i]) * 255.0f, 0.0f, 255.0f));
-            b = static_cast<uint8_t>(std::clamp((0.5f + SH_C0 * f_dc_2_data[i]) * 255.0f, 0.0f, 255.0f));
+            v.color[0] = f_dc_0_data[i];
+            v.color[1] = f_dc_1_data[i];
+            v.color[2] = f_dc_2_data[i];
         } else if (hasRGB) {
-            r = static_cast<uint8_t>(std::clamp(red_data[i], 0, 255));
-            g = static_cast<uint8_t>(std::clamp(green_data[i], 0, 255));
-            b = static_cast<uint8_t>(std::clamp(blue_data[i], 0, 255));
-        } else {
-            r = g = b = 255;
+            v.color[0] = static_cast<float>(red_data[i]);
+            v.color[1] = static_cast<float>(green_data[i]);
+            v.color[2] = static_cast<float>(blue_data[i]);
         }
-        
-        // Opacity (sigmoid)
         if (opacity_data) {
-            float op = 1.0f / (1.0f + std::exp(-opacity_data[i]));
-            a = static_cast<uint8_t>(std::clamp(op * 255.0f, 0.0f, 255.0f));
-        } else {
-            a = 255;
+            v.opacity = opacity_data[i];
+        }
+        for (size_t c = 0; c < 3 && rest_data; c++) {
+            for (size_t k = 0; k < keptCoefficients; k++) {
+                v.shRest[c][k] = rest_data[i * restCount + c * restPerChannel + k];
+            }
         }
-        
-        data.colors[i] = glm::u8vec4(r, g, b, a);
+        convertVertex(v, data, i);
     }
     
     // Pack data for GPU
-    data.pack();
+    data.format = layout.format;
+    if (spatialOrder) {
+        data.sortSpatially(pool);
+    }
+    data.pack(pool);
+    if (!keepSource) {
+        data.releaseSource();
+    }
     
     return data;
 }
 
+void PLYLoader::convertVertex(const PLYVertex& v, GaussianData& data, size_t i) {
+    // Position
+    data.positions[i] = glm::vec3(v.x, v.y, v.z);
+    
+    // Scale (exponential)
+    data.scales[i] = glm::vec3(
+        std::exp(v.scale[0]),
+        std::exp(v.scale[1]),
+        std::exp(v.scale[2])
+    );
+    
+    // Rotation (quaternion - note: different convention)
+    glm::quat q(v.rot[0], v.rot[1], v.rot[2], v.rot[3]);
+    data.rotations[i] = glm::normalize(q);
+    
+    // Color
+    uint8_t r, g, b, a;
+    
+    if (v.hasSH) {
+        // Spherical harmonics to RGB
+        r = static_cast<uint8_t>(std::clamp((0.5f + SH_C0 * v.color[0]) * 255.0f, 0.0f, 255.0f));
+        g = static_cast<uint8_t>(std::clamp((0.5f + SH_C0 * v.color[1]) * 255.0f, 0.0f, 255.0f));
+        b = static_cast<uint8_t>(std::clamp((0.5f + SH_C0 * v.color[2]) * 255.0f, 0.0f, 255.0f));
+    } else if (v.hasRGB) {
+        r = static_cast<uint8_t>(std::clamp(v.color[0], 0.0f, 255.0f));
+        g = static_cast<uint8_t>(std::clamp(v.color[1], 0.0f, 255.0f));
+        b = static_cast<uint8_t>(std::clamp(v.color[2], 0.0f, 255.0f));
+    } else {
+        r = g = b = 255;
+    }
+    
+    // Opacity (sigmoid)
+    if (v.hasOpacity) {
+        float op = 1.0f / (1.0f + std::exp(-v.opacity));
+        a = static_cast<uint8_t>(std::clamp(op * 255.0f, 0.0f, 255.0f));
+    } else {
+        a = 255;
+    }
+    
+    data.colors[i] = glm::u8vec4(r, g, b, a);
+    
+    // Higher bands, stored as RGB triplets per coefficient
+    size_t coefficients = shCoefficients(data.shDegree);
+    float* rest = data.shRest.data() + i * 3 * coefficients;
+    for (size_t k = 0; k < coefficients; k++) {
+        for (size_t c = 0; c < 3; c++) {
+            rest[k * 3 + c] = v.shRest[c][k];
+        }
+    }
+}
+
+int PLYLoader::shDegreeFor(size_t restCount) {
+    int degree = 0;
+    while (degree < kMaxShDegree && shCoefficients(degree + 1) * 3 <= restCount) {
+        degree++;
+    }
+    return degree;
+}
+
 } // namespace gsplat
@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "PackKernels.h"
+#include "Utils.h"
+
+#if defined(GSPLAT_X86_KERNELS)
+#include <immintrin.h>
+#endif
+
+namespace gsplat {
+
+namespace {
+
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "vec3 must be tightly packed");
+static_assert(sizeof(glm::quat) == 4 * sizeof(float), "quat must be tightly packed");
+static_assert(sizeof(glm::u8vec4) == sizeof(uint32_t), "u8vec4 must be 4 bytes");
+
+void packScalar(const PackInput& in, size_t begin, size_t end,
+                uint32_t* packed, float* x, float* y, float* z) {
+    for (size_t i = begin; i < end; i++) {
+        const glm::vec3& pos = in.positions[i];
+        const glm::vec3& scale = in.scales[i];
+        const glm::quat& rot = in.rotations[i];
+        uint32_t* out = packed + i * 8;
+        
+        // First uvec4: position (xyz as floats reinterpreted as uint) + selection flag (w)
+        std::memcpy(&out[0], &pos.x, sizeof(uint32_t));
+        std::memcpy(&out[1], &pos.y, sizeof(uint32_t));
+        std::memcpy(&out[2], &pos.z, sizeof(uint32_t));
+        out[3] = 0; // selection flag (0 = not selected)
+        
+        x[i] = pos.x;
+        y[i] = pos.y;
+        z[i] = pos.z;
+        
+        // Rotation matrix from the quaternion, as glm::mat3_cast; r[c][r]
+        float qxx = rot.x * rot.x, qyy = rot.y * rot.y, qzz = rot.z * rot.z;
+        float qxz = rot.x * rot.z, qxy = rot.x * rot.y, qyz = rot.y * rot.z;
+        float qwx = rot.w * rot.x, qwy = rot.w * rot.y, qwz = rot.w * rot.z;
+        float r00 = 1.0f - 2.0f * (qyy + qzz), r01 = 2.0f * (qxy + qwz), r02 = 2.0f * (qxz - qwy);
+        float r10 = 2.0f * (qxy - qwz), r11 = 1.0f - 2.0f * (qxx + qzz), r12 = 2.0f * (qyz + qwx);
+        float r20 = 2.0f * (qxz + qwy), r21 = 2.0f * (qyz - qwx), r22 = 1.0f - 2.0f * (qxx + qyy);
+        
+        // M = R * S scales column c by scale[c]
+        float m00 = r00 * scale.x, m01 = r01 * scale.x, m02 = r02 * scale.x;
+        float m10 = r10 * scale.y, m11 = r11 * scale.y, m12 = r12 * scale.y;
+        float m20 = r20 * scale.z, m21 = r21 * scale.z, m22 = r22 * scale.z;
+        
+        // 3D covariance M * M^T (symmetric)
+        float s0 = m00 * m00 + m10 * m10 + m20 * m20; // xx
+        float s1 = m00 * m01 + m10 * m11 + m20 * m21; // xy
+        float s2 = m00 * m02 + m10 * m12 + m20 * m22; // xz
+        float s3 = m01 * m01 + m11 * m11 + m21 * m21; // yy
+        float s4 = m01 * m02 + m11 * m12 + m21 * m22; // yz
+        float s5 = m02 * m02 + m12 * m12 + m22 * m22; // zz
+        
+        // Second uvec4: covariance (xx, xy | xz, yy | yz, zz as half2) + color (w as packed RGBA)
+        out[4] = packHalf2x16(s0, s1);
+        out[5] = packHalf2x16(s2, s3);
+        out[6] = packHalf2x16(s4, s5);
+        std::memcpy(&out[7], &in.colors[i], sizeof(uint32_t));
+    }
+}
+
+#if defined(GSPLAT_X86_KERNELS)
+
+bool cpuHasF16C() {
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("f16c") != 0;
+    }();
+    return supported;
+}
+
+// Rows r[0..7] hold one field for 8 splats; afterwards row k holds splat k's 8 fields
+__attribute__((target("avx2")))
+inline void transpose8x8(__m256 r[8]) {
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]), t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]), t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+    r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+    r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+    r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+    r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+    r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+    r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+    r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+
+// The covariance below mirrors packScalar operation for operation. No kernel
+// enables FMA, and the file is built without contraction, so every level
+// rounds identically.
+
+__attribute__((target("avx2")))
+inline __m256 dot3AVX2(__m256 a0, __m256 b0, __m256 a1, __m256 b1, __m256 a2, __m256 b2) {
+    return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a0, b0), _mm256_mul_ps(a1, b1)), _mm256_mul_ps(a2, b2));
+}
+
+// Truncate to half and interleave into half2 words, 4 splats per 128-bit lane
+__attribute__((target("avx2,f16c")))
+inline __m256 half2AVX2(__m256 a, __m256 b) {
+    __m128i ha = _mm256_cvtps_ph(a, _MM_FROUND_TO_ZERO), hb = _mm256_cvtps_ph(b, _MM_FROUND_TO_ZERO);
+    __m128i lo = _mm_unpacklo_epi16(ha, hb), hi = _mm_unpackhi_epi16(ha, hb);
+    return _mm256_castsi256_ps(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1));
+}
+
+__attribute__((target("avx512f")))
+inline __m512 dot3AVX512(__m512 a0, __m512 b0, __m512 a1, __m512 b1, __m512 a2, __m512 b2) {
+    return _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(a0, b0), _mm512_mul_ps(a1, b1)), _mm512_mul_ps(a2, b2));
+}
+
+// Half2 words for splats 0-7 in lo and 8-15 in hi; unpack works within 128-bit lanes
+__attribute__((target("avx512f")))
+inline void half2AVX512(__m512 a, __m512 b, __m256& lo, __m256& hi) {
+    const int toZero = _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC;
+    __m256i ha = _mm512_cvtps_ph(a, toZero), hb = _mm512_cvtps_ph(b, toZero);
+    __m256i l = _mm256_unpacklo_epi16(ha, hb), h = _mm256_unpackhi_epi16(ha, hb);
+    lo = _mm256_castsi256_ps(_mm256_permute2x128_si256(l, h, 0x20));
+    hi = _mm256_castsi256_ps(_mm256_permute2x128_si256(l, h, 0x31));
+}
+
+__attribute__((target("avx512f")))
+inline void splitAVX512(__m512 v, __m256& lo, __m256& hi) {
+    lo = _mm512_castps512_ps256(v);
+    hi = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1));
+}
+
+__attribute__((target("avx2,f16c")))
+size_t packAVX2(const PackInput& in, size_t begin, size_t end,
+                uint32_t* packed, float* x, float* y, float* z) {
+    const __m256i idx3 = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+    const __m256i idx4 = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+    const __m256 one = _mm256_set1_ps(1.0f), two = _mm256_set1_ps(2.0f);
+    
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 px = _mm256_i32gather_ps(&in.positions[i].x, idx3, 4);
+        __m256 py = _mm256_i32gather_ps(&in.positions[i].y, idx3, 4);
+        __m256 pz = _mm256_i32gather_ps(&in.positions[i].z, idx3, 4);
+        __m256 sx = _mm256_i32gather_ps(&in.scales[i].x, idx3, 4);
+        __m256 sy = _mm256_i32gather_ps(&in.scales[i].y, idx3, 4);
+        __m256 sz = _mm256_i32gather_ps(&in.scales[i].z, idx3, 4);
+        __m256 qx = _mm256_i32gather_ps(&in.rotations[i].x, idx4, 4);
+        __m256 qy = _mm256_i32gather_ps(&in.rotations[i].y, idx4, 4);
+        __m256 qz = _mm256_i32gather_ps(&in.rotations[i].z, idx4, 4);
+        __m256 qw = _mm256_i32gather_ps(&in.rotations[i].w, idx4, 4);
+        
+        _mm256_storeu_ps(x + i, px);
+        _mm256_storeu_ps(y + i, py);
+        _mm256_storeu_ps(z + i, pz);
+        
+        __m256 qxx = _mm256_mul_ps(qx, qx), qyy = _mm256_mul_ps(qy, qy), qzz = _mm256_mul_ps(qz, qz);
+        __m256 qxz = _mm256_mul_ps(qx, qz), qxy = _mm256_mul_ps(qx, qy), qyz = _mm256_mul_ps(qy, qz);
+        __m256 qwx = _mm256_mul_ps(qw, qx), qwy = _mm256_mul_ps(qw, qy), qwz = _mm256_mul_ps(qw, qz);
+        __m256 r00 = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qyy, qzz)));
+        __m256 r01 = _mm256_mul_ps(two, _mm256_add_ps(qxy, qwz));
+        __m256 r02 = _mm256_mul_ps(two, _mm256_sub_ps(qxz, qwy));
+        __m256 r10 = _mm256_mul_ps(two, _mm256_sub_ps(qxy, qwz));
+        __m256 r11 = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qxx, qzz)));
+        __m256 r12 = _mm256_mul_ps(two, _mm256_add_ps(qyz, qwx));
+        __m256 r20 = _mm256_mul_ps(two, _mm256_add_ps(qxz, qwy));
+        __m256 r21 = _mm256_mul_ps(two, _mm256_sub_ps(qyz, qwx));
+        __m256 r22 = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qxx, qyy)));
+        
+        __m256 m00 = _mm256_mul_ps(r00, sx), m01 = _mm256_mul_ps(r01, sx), m02 = _mm256_mul_ps(r02, sx);
+        __m256 m10 = _mm256_mul_ps(r10, sy), m11 = _mm256_mul_ps(r11, sy), m12 = _mm256_mul_ps(r12, sy);
+        __m256 m20 = _mm256_mul_ps(r20, sz), m21 = _mm256_mul_ps(r21, sz), m22 = _mm256_mul_ps(r22, sz);
+        
+        __m256 s0 = dot3AVX2(m00, m00, m10, m10, m20, m20);
+        __m256 s1 = dot3AVX2(m00, m01, m10, m11, m20, m21);
+        __m256 s2 = dot3AVX2(m00, m02, m10, m12, m20, m22);
+        __m256 s3 = dot3AVX2(m01, m01, m11, m11, m21, m21);
+        __m256 s4 = dot3AVX2(m01, m02, m11, m12, m21, m22);
+        __m256 s5 = dot3AVX2(m02, m02, m12, m12, m22, m22);
+        
+        __m256 rows[8] = {
+            px, py, pz, _mm256_setzero_ps(),
+            half2AVX2(s0, s1), half2AVX2(s2, s3), half2AVX2(s4, s5),
+            _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.colors + i)))
+        };
+        transpose8x8(rows);
+        float* out = reinterpret_cast<float*>(packed + i * 8);
+        for (int k = 0; k < 8; k++) {
+            _mm256_storeu_ps(out + k * 8, rows[k]);
+        }
+    }
+    return i;
+}
+
+__attribute__((target("avx512f")))
+size_t packAVX512(const PackInput& in, size_t begin, size_t end,
+                  uint32_t* packed, float* x, float* y, float* z) {
+    const __m512i idx3 = _mm512_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 33, 36, 39, 42, 45);
+    const __m512i idx4 = _mm512_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 44, 48, 52, 56, 60);
+    const __m512 one = _mm512_set1_ps(1.0f), two = _mm512_set1_ps(2.0f);
+    
+    size_t i = begin;
+    for (; i + 16 <= end; i += 16) {
+        __m512 px = _mm512_i32gather_ps(idx3, &in.positions[i].x, 4);
+        __m512 py = _mm512_i32gather_ps(idx3, &in.positions[i].y, 4);
+        __m512 pz = _mm512_i32gather_ps(idx3, &in.positions[i].z, 4);
+        __m512 sx = _mm512_i32gather_ps(idx3, &in.scales[i].x, 4);
+        __m512 sy = _mm512_i32gather_ps(idx3, &in.scales[i].y, 4);
+        __m512 sz = _mm512_i32gather_ps(idx3, &in.scales[i].z, 4);
+        __m512 qx = _mm512_i32gather_ps(idx4, &in.rotations[i].x, 4);
+        __m512 qy = _mm512_i32gather_ps(idx4, &in.rotations[i].y, 4);
+        __m512 qz = _mm512_i32gather_ps(idx4, &in.rotations[i].z, 4);
+        __m512 qw = _mm512_i32gather_ps(idx4, &in.rotations[i].w, 4);
+        
+        _mm512_storeu_ps(x + i, px);
+        _mm512_storeu_ps(y + i, py);
+        _mm512_storeu_ps(z + i, pz);
+        
+        __m512 qxx = _mm512_mul_ps(qx, qx), qyy = _mm512_mul_ps(qy, qy), qzz = _mm512_mul_ps(qz, qz);
+        __m512 qxz = _mm512_mul_ps(qx, qz), qxy = _mm512_mul_ps(qx, qy), qyz = _mm512_mul_ps(qy, qz);
+        __m512 qwx = _mm512_mul_ps(qw, qx), qwy = _mm512_mul_ps(qw, qy), qwz = _mm512_mul_ps(qw, qz);
+        __m512 r00 = _mm512_sub_ps(one, _mm512_mul_ps(two, _mm512_add_ps(qyy, qzz)));
+        __m512 r01 = _mm512_mul_ps(two, _mm512_add_ps(qxy, qwz));
+        __m512 r02 = _mm512_mul_ps(two, _mm512_sub_ps(qxz, qwy));
+        __m512 r10 = _mm512_mul_ps(two, _mm512_sub_ps(qxy, qwz));
+        __m512 r11 = _mm512_sub_ps(one, _mm512_mul_ps(two, _mm512_add_ps(qxx, qzz)));
+        __m512 r12 = _mm512_mul_ps(two, _mm512_add_ps(qyz, qwx));
+        __m512 r20 = _mm512_mul_ps(two, _mm512_add_ps(qxz, qwy));
+        __m512 r21 = _mm512_mul_ps(two, _mm512_sub_ps(qyz, qwx));
+        __m512 r22 = _mm512_sub_ps(one, _mm512_mul_ps(two, _mm512_add_ps(qxx, qyy)));
+        
+        __m512 m00 = _mm512_mul_ps(r00, sx), m01 = _mm512_mul_ps(r01, sx), m02 = _mm512_mul_ps(r02, sx);
+        __m512 m10 = _mm512_mul_ps(r10, sy), m11 = _mm512_mul_ps(r11, sy), m12 = _mm512_mul_ps(r12, sy);
+        __m512 m20 = _mm512_mul_ps(r20, sz), m21 = _mm512_mul_ps(r21, sz), m22 = _mm512_mul_ps(r22, sz);
+        
+        __m512 s0 = dot3AVX512(m00, m00, m10, m10, m20, m20);
+        __m512 s1 = dot3AVX512(m00, m01, m10, m11, m20, m21);
+        __m512 s2 = dot3AVX512(m00, m02, m10, m12, m20, m22);
+        __m512 s3 = dot3AVX512(m01, m01, m11, m11, m21, m21);
+        __m512 s4 = dot3AVX512(m01, m02, m11, m12, m21, m22);
+        __m512 s5 = dot3AVX512(m02, m02, m12, m12, m22, m22);
+        
+        __m256 lo[8], hi[8];
+        splitAVX512(px, lo[0], hi[0]);
+        splitAVX512(py, lo[1], hi[1]);
+        splitAVX512(pz, lo[2], hi[2]);
+        lo[3] = hi[3] = _mm256_setzero_ps();
+        half2AVX512(s0, s1, lo[4], hi[4]);
+        half2AVX512(s2, s3, lo[5], hi[5]);
+        half2AVX512(s4, s5, lo[6], hi[6]);
+        lo[7] = _mm256_loadu_ps(reinterpret_cast<const float*>(in.colors + i));
+        hi[7] = _mm256_loadu_ps(reinterpret_cast<const float*>(in.colors + i + 8));
+        
+        transpose8x8(lo);
+        transpose8x8(hi);
+        float* out = reinterpret_cast<float*>(packed + i * 8);
+        for (int k = 0; k < 8; k++) {
+            _mm256_storeu_ps(out + k * 8, lo[k]);
+            _mm256_storeu_ps(out + 64 + k * 8, hi[k]);
+        }
+    }
+    return i;
+}
+
+#endif // GSPLAT_X86_KERNELS
+
+} // namespace
+
+void packSplats(SimdLevel level, const PackInput& in, size_t begin, size_t end,
+                uint32_t* packed, float* x, float* y, float* z) {
+    size_t done = begin;
+#if defined(GSPLAT_X86_KERNELS)
+    switch (level) {
+        case SimdLevel::AVX512: done = packAVX512(in, begin, end, packed, x, y, z); break;
+        case SimdLevel::AVX2: done = cpuHasF16C() ? packAVX2(in, begin, end, packed, x, y, z) : begin; break;
+        default: break;
+    }
+#else
+    (void)level;
+#endif
+    packScalar(in, done, end, packed, x, y, z);
+}
+
+namespace {
+
+constexpr float kPositionSteps = 65535.0f;
+constexpr float kScaleSteps = 127.0f;
+constexpr float kSqrt2 = 1.41421356f;
+
+uint32_t floatBits(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+float bitsFloat(uint32_t bits) {
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// Round (value - min) / step to [0, maxStep]; NaN and a zero step give 0
+uint32_t quantize(float value, float min, float step, float maxStep) {
+    float t = (value - min) / step;
+    if (!(t >= 0.0f)) return 0;
+    return t < maxStep ? static_cast<uint32_t>(t + 0.5f) : static_cast<uint32_t>(maxStep);
+}
+
+float logScale(float scale) {
+    return std::log(std::max(scale, 1e-30f));
+}
+
+// CPU mirror of the decode in splat.vert
+void decodeCompressed(const uint32_t* packed, const uint32_t* chunks, size_t i,
+                      glm::vec3& pos, glm::vec3& scale, glm::quat& rot) {
+    const uint32_t* s = packed + i * 4;
+    const uint32_t* c = chunks + (i / kSplatChunkSize) * kChunkWords;
+    uint32_t qp[3] = {s[0] & 0xffffu, s[0] >> 16, s[1] & 0xffffu};
+    uint32_t qs[3] = {(s[2] >> 10) & 0x7fu, (s[2] >> 17) & 0x7fu, (s[2] >> 24) & 0x7fu};
+    for (int k = 0; k < 3; k++) {
+        pos[k] = bitsFloat(c[k]) + static_cast<float>(qp[k]) * bitsFloat(c[4 + k]);
+        scale[k] = std::exp(bitsFloat(c[8 + k]) + static_cast<float>(qs[k]) * bitsFloat(c[12 + k]));
+    }
+    
+    uint32_t qr[3] = {(s[1] >> 16) & 0xffu, s[1] >> 24, s[2] & 0xffu};
+    uint32_t largest = (s[2] >> 8) & 3u;
+    float q[4];
+    float sum = 0.0f;
+    for (uint32_t k = 0, j = 0; k < 4; k++) {
+        if (k == largest) continue;
+        q[k] = (static_cast<float>(qr[j++]) / 127.5f - 1.0f) / kSqrt2;
+        sum += q[k] * q[k];
+    }
+    q[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+    rot = glm::quat(q[3], q[0], q[1], q[2]);
+}
+
+// Upper triangle of R S S^T R^T, as packScalar computes it
+void covariance(const glm::vec3& scale, const glm::quat& rot, float out[6]) {
+    glm::mat3 m = glm::mat3_cast(rot);
+    m[0] *= scale.x;
+    m[1] *= scale.y;
+    m[2] *= scale.z;
+    glm::mat3 sigma = m * glm::transpose(m);
+    out[0] = sigma[0][0]; out[1] = sigma[0][1]; out[2] = sigma[0][2];
+    out[3] = sigma[1][1]; out[4] = sigma[1][2]; out[5] = sigma[2][2];
+}
+
+} // namespace
+
+void compressSplats(const PackInput& in, size_t begin, size_t end,
+                    uint32_t* packed, uint32_t* chunks, float* x, float* y, float* z) {
+    for (size_t first = begin; first < end; first += kSplatChunkSize) {
+        size_t last = std::min(end, first + kSplatChunkSize);
+        
+        glm::vec3 posMin(INFINITY), posMax(-INFINITY), logMin(INFINITY), logMax(-INFINITY);
+        for (size_t i = first; i < last; i++) {
+            for (int k = 0; k < 3; k++) {
+                float p = in.positions[i][k];
+                float l = logScale(in.scales[i][k]);
+                if (p < posMin[k]) posMin[k] = p;
+                if (p > posMax[k]) posMax[k] = p;
+                if (l < logMin[k]) logMin[k] = l;
+                if (l > logMax[k]) logMax[k] = l;
+            }
+        }
+        
+        uint32_t* chunk = chunks + (first / kSplatChunkSize) * kChunkWords;
+        glm::vec3 posStep, logStep;
+        for (int k = 0; k < 3; k++) {
+            // A chunk without finite values decodes to zero
+            if (!(posMin[k] <= posMax[k])) posMin[k] = posMax[k] = 0.0f;
+            if (!(logMin[k] <= logMax[k])) logMin[k] = logMax[k] = 0.0f;
+            posStep[k] = (posMax[k] - posMin[k]) / kPositionSteps;
+            logStep[k] = (logMax[k] - logMin[k]) / kScaleSteps;
+            chunk[k] = floatBits(posMin[k]);
+            chunk[4 + k] = floatBits(posStep[k]);
+            chunk[8 + k] = floatBits(logMin[k]);
+            chunk[12 + k] = floatBits(logStep[k]);
+        }
+        chunk[3] = chunk[7] = chunk[11] = chunk[15] = 0;
+        
+        for (size_t i = first; i < last; i++) {
+            uint32_t qp[3], qs[3];
+            for (int k = 0; k < 3; k++) {
+                qp[k] = quantize(in.positions[i][k], posMin[k], posStep[k], kPositionSteps);
+                qs[k] = quantize(logScale(in.scales[i][k]), logMin[k], logStep[k], kScaleSteps);
+            }
+            
+            // Smallest three: drop the largest component, made positive since q and -q agree
+            const glm::quat& rot = in.rotations[i];
+            float q[4] = {rot.x, rot.y, rot.z, rot.w};
+            uint32_t largest = 0;
+            for (uint32_t k = 1; k < 4; k++) {
+                if (std::fabs(q[k]) > std::fabs(q[largest])) largest = k;
+            }
+            float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+            uint32_t qr[3];
+            for (uint32_t k = 0, j = 0; k < 4; k++) {
+                if (k == largest) continue;
+                // Components other than the largest lie in [-1/sqrt(2), 1/sqrt(2)]
+                qr[j++] = quantize(q[k] * sign * kSqrt2, -1.0f, 1.0f / 127.5f, 255.0f);
+            }
+            
+            uint32_t* out = packed + i * 4;
+            out[0] = qp[0] | (qp[1] << 16);
+            out[1] = qp[2] | (qr[0] << 16) | (qr[1] << 24);
+            // Bit 31 is left clear for the selection flag
+            out[2] = qr[2] | (largest << 8) | (qs[0] << 10) | (qs[1] << 17) | (qs[2] << 24);
+            std::memcpy(&out[3], &in.colors[i], sizeof(uint32_t));
+            
+            // Dequantized exactly like the shaders: one multiply, one add
+            x[i] = posMin.x + static_cast<float>(qp[0]) * posStep.x;
+            y[i] = posMin.y + static_cast<float>(qp[1]) * posStep.y;
+            z[i] = posMin.z + static_cast<float>(qp[2]) * posStep.z;
+        }
+    }
+}
+
+void packSH(int degree, ShFormat format, const float* rest, size_t begin, size_t end, uint32_t* out) {
+    size_t values = 3 * shCoefficients(degree);
+    size_t words = shTexels(degree, format) * 4;
+    for (size_t i = begin; i < end; i++) {
+        const float* v = rest + i * values;
+        uint32_t* dst = out + i * words;
+        std::fill(dst, dst + words, 0u);
+        if (format == ShFormat::Half) {
+            for (size_t j = 0; j < values; j++) {
+                dst[j >> 1] |= static_cast<uint32_t>(floatToHalf(v[j])) << ((j & 1) * 16);
+            }
+            continue;
+        }
+        
+        float range = 0.0f;
+        for (size_t j = 0; j < values; j++) {
+            range = std::max(range, std::abs(v[j]));
+        }
+        // Halves truncate, so step up when that lost any of the range
+        uint16_t rangeHalf = floatToHalf(range);
+        if (halfToFloat(rangeHalf) < range) {
+            rangeHalf++;
+        }
+        float scale = rangeHalf ? 127.0f / halfToFloat(rangeHalf) : 0.0f;
+        dst[0] = rangeHalf;
+        for (size_t j = 0; j < values; j++) {
+            float q = std::clamp(std::round(v[j] * scale), -127.0f, 127.0f) + 128.0f;
+            size_t byte = j + 2;
+            dst[byte >> 2] |= static_cast<uint32_t>(q) << ((byte & 3) * 8);
+        }
+    }
+}
+
+CompressionError measureCompression(const PackInput& in, size_t begin, size_t end,
+                                    const uint32_t* packed, const uint32_t* chunks) {
+    CompressionError error = {};
+    double sumSquares = 0.0;
+    for (size_t i = begin; i < end; i++) {
+        glm::vec3 pos, scale;
+        glm::quat rot;
+        decodeCompressed(packed, chunks, i, pos, scale, rot);
+        
+        glm::vec3 dp = glm::abs(pos - in.positions[i]);
+        error.maxPosition = std::max(error.maxPosition, std::max(dp.x, std::max(dp.y, dp.z)));
+        for (int k = 0; k < 3; k++) {
+            if (in.scales[i][k] > 0.0f) {
+                error.maxScale = std::max(error.maxScale, std::fabs(scale[k] / in.scales[i][k] - 1.0f));
+            }
+        }
+        float dot = std::min(1.0f, std::fabs(glm::dot(rot, in.rotations[i])));
+        error.maxRotationDeg = std::max(error.maxRotationDeg, glm::degrees(2.0f * std::acos(dot)));
+        
+        float expected[6], actual[6];
+        covariance(in.scales[i], in.rotations[i], expected);
+        covariance(scale, rot, actual);
+        // Off-diagonal terms appear twice in the full matrix
+        float diff = 0.0f, norm = 0.0f;
+        for (int k = 0; k < 6; k++) {
+            float weight = (k == 0 || k == 3 || k == 5) ? 1.0f : 2.0f;
+            diff += weight * (actual[k] - expected[k]) * (actual[k] - expected[k]);
+            norm += weight * expected[k] * expected[k];
+        }
+        if (norm > 0.0f) {
+            float relative = std::sqrt(diff / norm);
+            sumSquares += static_cast<double>(relative) * relative;
+            error.maxCovariance = std::max(error.maxCovariance, relative);
+        }
+    }
+    if (end > begin) {
+        error.rmsCovariance = static_cast<float>(std::sqrt(sumSquares / static_cast<double>(end - begin)));
+    }
+    return error;
+}
+
+} // namespace gsplat
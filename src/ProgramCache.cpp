@@ -0,0 +1,244 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "ProgramCache.h"
+#include "Utils.h"
+
+namespace gsplat {
+
+namespace {
+
+const char kMagic[4] = {'G', 'S', 'P', 'B'};
+constexpr uint32_t kVersion = 1;
+
+struct BinaryHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t length;
+};
+
+// FNV-1a, continued from hash
+uint64_t mix(uint64_t hash, const std::string& text) {
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    // Separator, so adjacent strings cannot run together
+    hash ^= 0xff;
+    hash *= 1099511628211ull;
+    return hash;
+}
+
+std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+} // namespace
+
+std::string readShader(const std::string& name) {
+    std::vector<std::filesystem::path> directories;
+    if (const char* dir = std::getenv("GSPLAT_SHADER_DIR")) {
+        directories.emplace_back(dir);
+    }
+    directories.emplace_back("shaders");
+#ifdef GSPLAT_BUILD_SHADER_DIR
+    directories.emplace_back(GSPLAT_BUILD_SHADER_DIR);
+#endif
+    for (const std::filesystem::path& dir : directories) {
+        std::error_code error;
+        if (std::filesystem::is_regular_file(dir / name, error)) {
+            return readFile((dir / name).string());
+        }
+    }
+    throw std::runtime_error("Shader not found: " + name + " (set GSPLAT_SHADER_DIR to the shaders directory)");
+}
+
+ProgramCache::ProgramCache(std::string directory)
+    : directory(std::move(directory))
+    , binaryFormats(-1)
+    , hits(0)
+    , misses(0)
+{
+}
+
+std::string ProgramCache::defaultDirectory() {
+    if (const char* cache = std::getenv("XDG_CACHE_HOME"); cache && *cache) {
+        return (std::filesystem::path(cache) / "gsplat" / "programs").string();
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return (std::filesystem::path(home) / ".cache" / "gsplat" / "programs").string();
+    }
+    return "";
+}
+
+GLuint ProgramCache::build(const std::vector<ShaderStage>& stages, const std::vector<std::string>& attributes) {
+    if (binaryFormats < 0) {
+        binaryFormats = 0;
+        if (!directory.empty()) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+        }
+    }
+    if (binaryFormats == 0) {
+        misses++;
+        return compileAndLink(stages, attributes, false);
+    }
+
+    uint64_t key = 14695981039346656037ull;
+    key = mix(key, glString(GL_VENDOR));
+    key = mix(key, glString(GL_RENDERER));
+    key = mix(key, glString(GL_VERSION));
+    for (const ShaderStage& stage : stages) {
+        key = mix(key, std::to_string(stage.type));
+        key = mix(key, stage.source);
+    }
+    for (const std::string& attribute : attributes) {
+        key = mix(key, attribute);
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    std::string path = (std::filesystem::path(directory) / name).string();
+
+    GLuint program = loadBinary(path, key);
+    if (program != 0) {
+        hits++;
+        return program;
+    }
+    misses++;
+    program = compileAndLink(stages, attributes, true);
+    if (program != 0) {
+        saveBinary(program, path, key);
+    }
+    return program;
+}
+
+GLuint ProgramCache::compileAndLink(const std::vector<ShaderStage>& stages, const std::vector<std::string>& attributes,
+                                    bool retrievable) {
+    GLuint program = glCreateProgram();
+    std::vector<GLuint> shaders;
+    bool ok = true;
+    for (const ShaderStage& stage : stages) {
+        GLuint shader = glCreateShader(stage.type);
+        const char* source = stage.source.c_str();
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+            std::cerr << "Shader compilation failed (" << stage.name << "):\n" << infoLog << std::endl;
+            ok = false;
+        }
+        glAttachShader(program, shader);
+        shaders.push_back(shader);
+    }
+
+    if (ok) {
+        // Fixed attribute locations, so a rebuilt program fits the same VAO
+        for (size_t i = 0; i < attributes.size(); i++) {
+            glBindAttribLocation(program, static_cast<GLuint>(i), attributes[i].c_str());
+        }
+        if (retrievable) {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        glLinkProgram(program);
+
+        GLint success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetProgramInfoLog(program, 512, nullptr, infoLog);
+            std::cerr << "Program linking failed (" << stages.front().name << "):\n" << infoLog << std::endl;
+            ok = false;
+        }
+    }
+
+    for (GLuint shader : shaders) {
+        glDetachShader(program, shader);
+        glDeleteShader(shader);
+    }
+    if (!ok) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+GLuint ProgramCache::loadBinary(const std::string& path, uint64_t key) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return 0;
+
+    BinaryHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.key != key) {
+        return 0;
+    }
+    // The length is read from disk; a truncated or corrupt entry must not
+    // size the allocation
+    std::error_code error;
+    uint64_t fileSize = std::filesystem::file_size(path, error);
+    if (error || header.length > fileSize - sizeof(header)) {
+        return 0;
+    }
+    std::vector<char> binary(header.length);
+    if (!file.read(binary.data(), static_cast<std::streamsize>(binary.size()))) {
+        return 0;
+    }
+
+    // Drivers may refuse their own older binaries; that is a miss, not an error
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void ProgramCache::saveBinary(GLuint program, const std::string& path, uint64_t key) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    BinaryHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.key = key;
+    header.length = static_cast<uint32_t>(length);
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(program, length, nullptr, &binaryFormat, binary.data());
+    header.binaryFormat = binaryFormat;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    // Per process, so concurrent runs storing the same program do not write
+    // into one temporary file
+    std::string tempPath = path + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream file(tempPath, std::ios::binary);
+    bool ok = file && file.write(reinterpret_cast<const char*>(&header), sizeof(header)) &&
+              file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+    file.close();
+    if (!ok || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Not caching program binary: cannot write " << path << std::endl;
+        std::remove(tempPath.c_str());
+        // Compiling still works; stop trying for this run
+        binaryFormats = 0;
+    }
+}
+
+} // namespace gsplat
@@ -1,37 +1,57 @@
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 #include "glm/gtc/type_ptr.hpp"
 
 #include "Renderer.h"
 #include "Utils.h"
-#include "SplatSort.h"
 
 namespace gsplat {
 
-Renderer::Renderer(int width, int height)
+Renderer::Renderer(int width, int height, const std::string& programCacheDir)
     : width(width)
     , height(height)
+    , programCache(programCacheDir)
     , program(0)
-    , splatTexture(0)
+    , shDegreeLimit(kMaxShDegree)
+    , postProcess(true)
+    , uploadBudget(0)
     , vao(0)
     , positionVBO(0)
     , indexVBO(0)
+    , chunkedSort(true)
+    , editor(gaussianData)
+    , asyncSort(false)
+    , awaitOrder(false)
+    , queuedFrame(0)
+    , queuedViewProj(1.0f)
+    , frameIndex(0)
+    , sortedFrame(0)
+    , sortLatency(0)
+    , validateSort(false)
+    , validatedSorts(0)
+    , mismatchedSorts(0)
     , splatCount(0)
-    , textureWidth(0)
-    , textureHeight(0)
+    , drawCount(0)
+    , lodError(1.0f)
+    , lodBudget(0)
 {
-    initShaders();
+    initShaders(shaderDefines());
     initBuffers();
 }
 
 Renderer::~Renderer() {
+    sortWorker.reset();
+    gpuSort.reset();
+    indexRing.reset();
     glDeleteProgram(program);
-    glDeleteTextures(1, &splatTexture);
     glDeleteBuffers(1, &positionVBO);
     glDeleteBuffers(1, &indexVBO);
     glDeleteVertexArrays(1, &vao);
 }
 
+#ifdef GSPLAT_GL_CHECKS
 // Define GL error check here to keep Utils.h light
 void checkGLError(const char* context) {
     GLenum err;
@@ -39,64 +59,75 @@ void checkGLError(const char* context) {
         std::cerr << "OpenGL error in " << context << ": 0x" << std::hex << err << std::dec << std::endl;
     }
 }
+#endif
 
-GLuint Renderer::compileShader(GLenum type, const char* source) {
-    GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, nullptr);
-    glCompileShader(shader);
-    
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        std::cerr << "Shader compilation failed:\n" << infoLog << std::endl;
-        glDeleteShader(shader);
-        return 0;
+namespace {
+
+void APIENTRY printDebugMessage(GLenum, GLenum type, GLuint, GLenum severity, GLsizei, const GLchar* message,
+                                const void*) {
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION) return;
+    std::cerr << "OpenGL " << (type == GL_DEBUG_TYPE_ERROR ? "error" : "debug message")
+              << (severity == GL_DEBUG_SEVERITY_HIGH ? " (high)" : severity == GL_DEBUG_SEVERITY_MEDIUM ? " (medium)" : "")
+              << ": " << message << std::endl;
+}
+
+} // namespace
+
+bool enableGLDebugOutput() {
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool supported = major > 4 || (major == 4 && minor >= 3);
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions && !supported; i++) {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        supported = name && std::strcmp(name, "GL_KHR_debug") == 0;
     }
-    
-    return shader;
+    if (!supported) return false;
+    // Asynchronous: messages may arrive late, but the driver is never synchronized
+    glEnable(GL_DEBUG_OUTPUT);
+    glDebugMessageCallback(printDebugMessage, nullptr);
+    return true;
 }
 
-GLuint Renderer::createProgram(const char* vertexSource, const char* fragmentSource) {
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
-    
-    if (vertexShader == 0 || fragmentShader == 0) {
-        return 0;
+std::string Renderer::shaderDefines() const {
+    std::string defines;
+    if (postProcess) {
+        defines += "POST_PROCESS ";
     }
-    
-    GLuint prog = glCreateProgram();
-    glAttachShader(prog, vertexShader);
-    glAttachShader(prog, fragmentShader);
-    glLinkProgram(prog);
-    
-    GLint success;
-    glGetProgramiv(prog, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(prog, 512, nullptr, infoLog);
-        std::cerr << "Program linking failed:\n" << infoLog << std::endl;
-        glDeleteProgram(prog);
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return 0;
+    if (gaussianData.format == SplatFormat::Compressed) {
+        defines += "COMPRESSED_SPLATS ";
     }
-    
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    
-    return prog;
+    if (instances.isComposite()) {
+        defines += "INSTANCES ";
+    }
+    int shDegree = getShDegree();
+    if (shDegree > 0) {
+        // The stride is that of the stored degree, which may be higher
+        defines += "SH_DEGREE=" + std::to_string(shDegree) + " SH_STRIDE=" +
+                   std::to_string(shTexels(gaussianData.shDegree, gaussianData.shFormat));
+        if (gaussianData.shFormat == ShFormat::Byte) {
+            defines += " SH_BYTES";
+        }
+    }
+    return defines;
 }
 
-void Renderer::initShaders() {
-    std::string vertexSource = readFile("shaders/splat.vert");
-    std::string fragmentSource = readFile("shaders/splat.frag");
-    
-    program = createProgram(vertexSource.c_str(), fragmentSource.c_str());
-    if (program == 0) {
+void Renderer::initShaders(const std::string& defines) {
+    if (program != 0 && defines == programDefines) return;
+    
+    // Both stages get the defines, so each variant is compiled with only the code it runs
+    GLuint newProgram = programCache.build({
+        {GL_VERTEX_SHADER, withDefines(readShader("splat.vert"), defines), "splat.vert"},
+        {GL_FRAGMENT_SHADER, withDefines(readShader("splat.frag"), defines), "splat.frag"}
+    }, {"position", "index"});
+    if (newProgram == 0) {
         throw std::runtime_error("Failed to create shader program");
     }
+    glDeleteProgram(program);
+    program = newProgram;
+    programDefines = defines;
     
     // Get uniform locations
     u_projection = glGetUniformLocation(program, "projection");
@@ -104,6 +135,18 @@ void Renderer::initShaders() {
     u_focal = glGetUniformLocation(program, "focal");
     u_viewport = glGetUniformLocation(program, "viewport");
     u_texture = glGetUniformLocation(program, "u_texture");
+    u_chunks = glGetUniformLocation(program, "u_chunks");
+    u_sh = glGetUniformLocation(program, "u_sh");
+    u_instances = glGetUniformLocation(program, "u_instances");
+    u_cameraPosition = glGetUniformLocation(program, "cameraPosition");
+    a_position = glGetAttribLocation(program, "position");
+    a_index = glGetAttribLocation(program, "index");
+    
+    glUseProgram(program);
+    glUniform1i(u_texture, 0);
+    glUniform1i(u_chunks, 1);
+    glUniform1i(u_sh, 2);
+    glUniform1i(u_instances, 3);
 }
 
 void Renderer::initBuffers() {
@@ -123,97 +166,452 @@ void Renderer::initBuffers() {
     glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
     
-    a_position = glGetAttribLocation(program, "position");
     glEnableVertexAttribArray(a_position);
     glVertexAttribPointer(a_position, 2, GL_FLOAT, GL_FALSE, 0, 0);
     
     // Index buffer (per-instance)
     glGenBuffers(1, &indexVBO);
+    if (IndexRing::isSupported()) {
+        indexRing = std::make_unique<IndexRing>();
+    }
     
     glBindVertexArray(0);
-    
-    // Create textures
-    glGenTextures(1, &splatTexture);
 }
 
 void Renderer::setGaussianData(const GaussianData& data) {
-    gaussianData = data;
-    splatCount = data.count();
+    GaussianData copy;
+    copy.format = data.format;
+    copy.shDegree = data.shDegree;
+    copy.shFormat = data.shFormat;
+    copy.packedData = data.packedData;
+    copy.chunkData = data.chunkData;
+    copy.shData = data.shData;
+    copy.worldPositions = data.worldPositions;
+    copy.boundsMin = data.boundsMin;
+    copy.boundsMax = data.boundsMax;
+    setGaussianData(std::move(copy));
+}
+
+void Renderer::setGaussianData(GaussianData&& data) {
+    // The worker reads gaussianData, so stop it before replacing the scene
+    sortWorker.reset();
+    
+    gaussianData = std::move(data);
+    gaussianData.releaseSource();
+    splatCount = 0;
+    depthIndex.clear();
+    chunks.clear();
+    lodTree = LodTree();
+    instances.clear();
+    instances.add(0, gaussianData.count());
+    instances.updatePositions(gaussianData.worldPositions);
+    editor.reset();
+    
+    initShaders(shaderDefines());
+    splatTexture.allocate(gaussianData.count(), gaussianData.layout());
+    uploadPending();
+    
+    if (gpuSort) {
+        gpuSort->resize(static_cast<uint32_t>(splatCount));
+    }
+    restartSortWorker();
+}
+
+void Renderer::reserveSplats(size_t capacity) {
+    sortWorker.reset();
+    
+    gaussianData.packedData.reserve(capacity * splatWords(gaussianData.format));
+    gaussianData.chunkData.reserve((capacity + kSplatChunkSize - 1) / kSplatChunkSize * kChunkWords);
+    gaussianData.shData.reserve(capacity * shTexels(gaussianData.shDegree, gaussianData.shFormat) * 4);
+    gaussianData.worldPositions.x.reserve(capacity);
+    gaussianData.worldPositions.y.reserve(capacity);
+    gaussianData.worldPositions.z.reserve(capacity);
+    
+    if (capacity > splatTexture.getCapacity()) {
+        growTexture(capacity);
+    }
+    restartSortWorker();
+}
+
+void Renderer::appendGaussianData(const GaussianData& chunk) {
+    if (chunk.count() == 0) return;
+    gaussianData.checkAppendable(chunk);
+    
+    // The worker reads gaussianData, so stop it while it grows
+    sortWorker.reset();
+    
+    gaussianData.appendPacked(chunk);
+    if (instances.size() == 0) {
+        instances.add(0, gaussianData.count());
+    } else {
+        instances.extendLast(gaussianData.count());
+    }
+    storeGrew();
+}
+
+size_t Renderer::addInstance(const GaussianData& data, const glm::mat4& transform) {
+    // An incompatible scene is refused before the padding changes the store
+    gaussianData.checkAppendable(data);
+    
+    // The worker reads the sort positions, so stop it while they grow, and
+    // start it again if growing them throws
+    sortWorker.reset();
+    try {
+        // Compressed chunks are quantized per scene
+        if (gaussianData.count() > 0 && data.format == gaussianData.format) {
+            gaussianData.padToChunk();
+        }
+        size_t first = gaussianData.count();
+        gaussianData.appendPacked(data);
+        size_t instance = instances.add(first, data.count(), transform);
+        storeGrew();
+        return instance;
+    } catch (...) {
+        restartSortWorker();
+        throw;
+    }
+}
+
+void Renderer::storeGrew() {
+    lodTree = LodTree();
+    instances.updatePositions(gaussianData.worldPositions);
+    // The first splats of an empty scene decide its layout, and a second
+    // instance selects the instanced variant
+    initShaders(shaderDefines());
+    if (gaussianData.layout() != splatTexture.getLayout()) {
+        growTexture(std::max(gaussianData.count(), splatTexture.getCapacity()));
+    } else if (gaussianData.count() > splatTexture.getCapacity()) {
+        // Outgrew the reservation; grow geometrically so later chunks fit,
+        // up to what the device holds
+        size_t limit = SplatTexture::maxSplats(gaussianData.layout());
+        growTexture(std::max(gaussianData.count(), std::min(splatTexture.getCapacity() * 3 / 2, limit)));
+    }
+    uploadPending();
     
-    // Compute texture dimensions
-    // Texture layout: each gaussian takes 2 columns (2 uvec4)
-    // x coordinate: (index & 0x3ff) << 1 means 1024 gaussians per row
-    // y coordinate: index >> 10
-    textureWidth = 2048;  // 1024 * 2 columns
-    textureHeight = std::max(1, (int)std::ceil(splatCount / 1024.0f));
+    if (gpuSort) {
+        gpuSort->resize(static_cast<uint32_t>(splatCount));
+    }
+    restartSortWorker();
+}
+
+void Renderer::setInstanceTransform(size_t instance, const glm::mat4& transform) {
+    if (!lodTree.empty()) {
+        throw std::runtime_error("Scene instances cannot be moved while a LOD tree is drawn");
+    }
+    sortWorker.reset();
+    
+    instances.setTransform(instance, transform);
+    instances.updatePositions(gaussianData.worldPositions);
+    initShaders(shaderDefines());
+    const SplatInstance& moved = instances.get(instance);
+    chunks.refresh(sortPositions(), moved.first, moved.first + moved.count);
+    if (gpuSort) {
+        gpuSort->reset();
+    }
+    restartSortWorker();
+}
+
+void Renderer::setInstanceVisible(size_t instance, bool visible) {
+    if (!lodTree.empty()) {
+        throw std::runtime_error("Scene instances cannot be hidden while a LOD tree is drawn");
+    }
+    bool wasComposite = instances.isComposite();
+    instances.setVisible(instance, visible);
+    if (instances.isComposite() == wasComposite) return;
+    
+    // Hiding the only scene switches to the instanced variant and its positions
+    sortWorker.reset();
+    instances.updatePositions(gaussianData.worldPositions);
+    initShaders(shaderDefines());
+    restartSortWorker();
+}
+
+size_t Renderer::select(const SelectionShape& shape, SelectionMode mode) {
+    if (!lodTree.empty()) {
+        throw std::runtime_error("Splats cannot be selected while a LOD tree is drawn");
+    }
+    return editor.select(sortPositions(), shape, mode);
+}
+
+const SoAPositions& Renderer::sortPositions() const {
+    return instances.isComposite() ? instances.getPositions() : gaussianData.worldPositions;
+}
+
+void Renderer::growTexture(size_t capacity) {
+    // Storage is immutable, so the resident splats go to a new texture in full
+    splatTexture.allocate(capacity, gaussianData.layout());
+    splatTexture.upload(gaussianData, 0, splatCount);
+}
+
+bool Renderer::uploadPending() {
+    size_t total = gaussianData.count();
+    if (splatCount >= total) return false;
     
-    updateTextures();
+    splatCount += splatTexture.upload(gaussianData, splatCount, total, uploadBudget);
+    return true;
 }
 
-void Renderer::updateTextures() {
-    if (splatCount == 0) return;
+void Renderer::reportMemory(MemoryReport& report) {
+    gaussianData.reportMemory(report);
+    report.add("draw order", vectorBytes(depthIndex));
+    chunks.reportMemory(report);
+    if (instances.isComposite()) {
+        instances.reportMemory(report);
+    }
+    editor.reportMemory(report);
+    if (!lodTree.empty()) {
+        lodTree.reportMemory(report);
+        report.add("LOD cut", vectorBytes(lodCut) + vectorBytes(nextCut) + vectorBytes(cutPositions.x) +
+                              vectorBytes(cutPositions.y) + vectorBytes(cutPositions.z));
+    }
+    if (sortWorker) {
+        sortWorker->reportMemory(report, [&] { sortContext.reportMemory(report); });
+    } else {
+        sortContext.reportMemory(report);
+    }
     
-    glUseProgram(program);
+    report.add("splat texture", splatTexture.textureBytes(), true);
+    report.add("harmonics texture", splatTexture.shTextureBytes(), true);
+    report.add("texture upload buffers", splatTexture.stagingBytes(), true);
+    if (gpuSort) {
+        gpuSort->reportMemory(report);
+    } else if (indexRing) {
+        report.add("index ring", indexRing->gpuBytes(), true);
+    } else {
+        report.add("index buffer", depthIndex.size() * sizeof(uint32_t), true);
+    }
+}
+
+void Renderer::setLodTree(LodTree&& tree) {
+    if (instances.isComposite()) {
+        throw std::runtime_error("A LOD tree needs a single untransformed scene");
+    }
+    sortWorker.reset();
+    lodTree = std::move(tree);
+    lodCut.clear();
+    depthIndex.clear();
+    restartSortWorker();
+}
+
+void Renderer::setShDegree(int degree) {
+    shDegreeLimit = std::clamp(degree, 0, kMaxShDegree);
+    initShaders(shaderDefines());
+}
+
+void Renderer::setPostProcess(bool enabled) {
+    if (enabled == postProcess) return;
+    postProcess = enabled;
+    initShaders(shaderDefines());
+}
+
+void Renderer::setCulling(bool enabled) {
+    sortWorker.reset();
+    sortContext.setCulling(enabled);
+    restartSortWorker();
+}
+
+void Renderer::setChunkedSort(bool enabled) {
+    chunkedSort = enabled;
+    restartSortWorker();
+}
+
+void Renderer::setAsyncSort(bool enabled) {
+    asyncSort = enabled;
+    restartSortWorker();
+}
+
+void Renderer::setSortBackend(SortBackend backend) {
+    if (backend == SortBackend::Gpu) {
+        if (gpuSort) return;
+        if (!GpuSort::isSupported()) {
+            throw std::runtime_error("GPU sort requires OpenGL 4.3 or newer");
+        }
+        gpuSort = std::make_unique<GpuSort>(&programCache);
+        gpuSort->resize(static_cast<uint32_t>(splatCount));
+    } else {
+        gpuSort.reset();
+        depthIndex.clear();
+    }
+    restartSortWorker();
+}
+
+void Renderer::queueSort(Camera& next) {
+    if (!sortWorker) return;
+    next.update();
+    queuedFrame = frameIndex + 1;
+    queuedViewProj = next.getViewProjMatrix();
+    sortWorker->request(queuedViewProj, queuedFrame);
+}
+
+void Renderer::restartSortWorker() {
+    sortWorker.reset();
+    // Whoever sorts next must produce a complete order for its own buffers
+    sortContext.reset();
+    // Every change to the resident splats comes through here; LOD cuts are
+    // not chunk-aligned
+    const bool useChunks = chunkedSort && lodTree.empty();
+    if (useChunks) {
+        chunks.update(sortPositions(), splatCount);
+    }
+    sortContext.setChunks(useChunks ? &chunks : nullptr);
+    if (!asyncSort || gpuSort || !lodTree.empty() || splatCount == 0) return;
+    
+    // The job runs on the worker thread; in async mode it is the only user of sortContext
+    awaitOrder = true;
+    queuedFrame = 0;
+    // The count is copied: a budgeted upload grows splatCount on the render
+    // thread before the worker is restarted for the new splats
+    const SoAPositions& pos = sortPositions();
+    const size_t count = splatCount;
+    sortWorker = std::make_unique<SortWorker>(
+        [this, &pos, count](const glm::mat4& viewProj, std::vector<uint32_t>& order) {
+            return sortContext.sort(viewProj, pos.x.data(), pos.y.data(), pos.z.data(), count, order);
+        });
+}
+
+bool Renderer::sortSplats(const glm::mat4& viewProj) {
+    if (splatCount == 0) return false;
     
-    // Reorganize packed data into 2D texture layout
-    // Each gaussian occupies 2 horizontal pixels (columns)
-    std::vector<uint32_t> textureData(textureWidth * textureHeight * 4);
-    for (size_t i = 0; i < splatCount; i++) {
-        int row = i / 1024;
-        int col = (i % 1024) * 2;  // Each gaussian takes 2 columns
-        
-        // First uvec4 (position + selection)
-        int idx1 = (row * textureWidth + col) * 4;
-        textureData[idx1 + 0] = gaussianData.packedData[i * 8 + 0];
-        textureData[idx1 + 1] = gaussianData.packedData[i * 8 + 1];
-        textureData[idx1 + 2] = gaussianData.packedData[i * 8 + 2];
-        textureData[idx1 + 3] = gaussianData.packedData[i * 8 + 3];
-        
-        // Second uvec4 (covariance + color)
-        int idx2 = (row * textureWidth + col + 1) * 4;
-        textureData[idx2 + 0] = gaussianData.packedData[i * 8 + 4];
-        textureData[idx2 + 1] = gaussianData.packedData[i * 8 + 5];
-        textureData[idx2 + 2] = gaussianData.packedData[i * 8 + 6];
-        textureData[idx2 + 3] = gaussianData.packedData[i * 8 + 7];
-    }
-    
-    // Upload splat data texture
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, splatTexture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32UI, textureWidth, textureHeight, 0,
-                 GL_RGBA_INTEGER, GL_UNSIGNED_INT, textureData.data());
-    glUniform1i(u_texture, 0);
-    checkGLError("Upload splat texture");
+    const SoAPositions& pos = sortPositions();
+    return sortContext.sort(viewProj, pos.x.data(), pos.y.data(), pos.z.data(), splatCount, depthIndex);
 }
 
-void Renderer::sortSplats(const glm::mat4& viewProj) {
-    if (splatCount == 0) return;
+bool Renderer::sortLodCut(const Camera& camera) {
+    lodTree.selectCut(camera.getPosition(), camera.getFx(), lodError, lodBudget, splatCount, nextCut);
+    // The previous order only helps for the same set of splats
+    if (nextCut != lodCut) {
+        sortContext.reset();
+        std::swap(nextCut, lodCut);
+    }
     
-    SplatSort::sort(viewProj, gaussianData.worldPositions.data(), splatCount, depthIndex);
+    const SoAPositions& pos = gaussianData.worldPositions;
+    cutPositions.resize(lodCut.size());
+    for (size_t i = 0; i < lodCut.size(); i++) {
+        cutPositions.x[i] = pos.x[lodCut[i]];
+        cutPositions.y[i] = pos.y[lodCut[i]];
+        cutPositions.z[i] = pos.z[lodCut[i]];
+    }
+    if (!sortContext.sort(camera.getViewProjMatrix(), cutPositions.x.data(), cutPositions.y.data(),
+                          cutPositions.z.data(), static_cast<uint32_t>(lodCut.size()), depthIndex)) {
+        return false;
+    }
+    for (uint32_t& index : depthIndex) {
+        index = lodCut[index];
+    }
+    return true;
+}
+
+void Renderer::validateGpuOrder(const glm::mat4& viewProj) {
+    std::vector<uint32_t> gpuOrder;
+    gpuSort->readIndices(gpuOrder);
+    
+    const SoAPositions& pos = sortPositions();
+    std::vector<uint32_t> cpuOrder;
+    SplatSort::sort(viewProj, pos.x.data(), pos.y.data(), pos.z.data(), splatCount, cpuOrder);
+    
+    // Indices the GPU order is short of count as differing
+    size_t compared = std::min(gpuOrder.size(), cpuOrder.size());
+    size_t mismatches = splatCount - compared;
+    for (size_t i = 0; i < compared; i++) {
+        if (gpuOrder[i] != cpuOrder[i]) mismatches++;
+    }
+    validatedSorts++;
+    if (mismatches > 0) {
+        mismatchedSorts++;
+        std::cerr << "GPU sort mismatch: " << mismatches << " of " << splatCount
+                  << " indices differ from SplatSort::sort" << std::endl;
+    } else if (validatedSorts - mismatchedSorts == 1) {
+        std::cout << "GPU sort matches SplatSort::sort (" << splatCount << " splats)" << std::endl;
+    }
 }
 
 void Renderer::render(Camera& camera) {
+    profiler.beginFrame();
+    
+    // Continue a budgeted upload; the new splats join the sort this frame.
+    // Rows changed by edits go first; edited splats that are not resident
+    // yet go up with the rest.
+    profiler.begin(ProfilePhase::SplatUpload);
+    for (const auto& range : editor.takeDirtyRanges()) {
+        splatTexture.update(gaussianData, range.first, std::min(range.second, splatCount));
+    }
+    if (uploadPending()) {
+        if (gpuSort) {
+            gpuSort->resize(static_cast<uint32_t>(splatCount));
+        }
+        restartSortWorker();
+    }
+    
     if (splatCount == 0) {
         std::cerr << "Warning: splatCount is 0" << std::endl;
+        profiler.endFrame();
         return;
     }
     
+    profiler.begin(ProfilePhase::Camera);
     camera.update();
+    frameIndex++;
     
     // Sort splats
-    sortSplats(camera.getViewProjMatrix());
+    profiler.begin(ProfilePhase::Sort);
+    bool newOrder = true;
+    drawCount = splatCount;
+    if (!lodTree.empty()) {
+        newOrder = sortLodCut(camera);
+        drawCount = depthIndex.size();
+        sortedFrame = frameIndex;
+    } else if (gpuSort) {
+        GLuint table = instances.isComposite() ? instances.getTexture() : 0;
+        if (gpuSort->sort(camera.getViewProjMatrix(), splatTexture, table) && validateSort) {
+            validateGpuOrder(camera.getViewProjMatrix());
+        }
+        newOrder = false;
+        sortedFrame = frameIndex;
+    } else if (sortWorker) {
+        const bool queued = queuedFrame == frameIndex && queuedViewProj == camera.getViewProjMatrix();
+        if (!queued) {
+            sortWorker->request(camera.getViewProjMatrix(), frameIndex);
+        }
+        // Only block when the worker has not produced an order for the current splats yet,
+        // or when this view's sort was queued ahead
+        newOrder = sortWorker->fetch(depthIndex, sortedFrame, awaitOrder || queued);
+        while (queued && sortedFrame < frameIndex) {
+            newOrder = sortWorker->fetch(depthIndex, sortedFrame, true) || newOrder;
+        }
+        awaitOrder = awaitOrder && !newOrder;
+        drawCount = depthIndex.size();
+    } else if (indexRing) {
+        // Sort straight into the next region of the mapped ring
+        uint32_t* out = indexRing->beginWrite(splatCount);
+        const SoAPositions& pos = sortPositions();
+        if (sortContext.sort(camera.getViewProjMatrix(), pos.x.data(), pos.y.data(), pos.z.data(),
+                             splatCount, out)) {
+            indexRing->endWrite();
+        }
+        newOrder = false;
+        drawCount = sortContext.getVisibleCount();
+        sortedFrame = frameIndex;
+    } else {
+        newOrder = sortSplats(camera.getViewProjMatrix());
+        drawCount = depthIndex.size();
+        sortedFrame = frameIndex;
+    }
+    sortLatency = frameIndex - sortedFrame;
     
     // Upload sorted indices
-    glBindBuffer(GL_ARRAY_BUFFER, indexVBO);
-    glBufferData(GL_ARRAY_BUFFER, depthIndex.size() * sizeof(uint32_t), 
-                 depthIndex.data(), GL_STREAM_DRAW);
-    checkGLError("Upload indices");
+    profiler.begin(ProfilePhase::IndexUpload);
+    if (newOrder && indexRing) {
+        std::copy(depthIndex.begin(), depthIndex.end(), indexRing->beginWrite(depthIndex.size()));
+        indexRing->endWrite();
+    } else if (newOrder) {
+        glBindBuffer(GL_ARRAY_BUFFER, indexVBO);
+        glBufferData(GL_ARRAY_BUFFER, depthIndex.size() * sizeof(uint32_t), 
+                     depthIndex.data(), GL_STREAM_DRAW);
+        checkGLError("Upload indices");
+    }
     
     // Setup OpenGL state
+    profiler.begin(ProfilePhase::Uniforms);
     glViewport(0, 0, width, height);
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);  // Zero alpha so front-to-back blending accumulates correctly
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -222,17 +620,29 @@ void Renderer::render(Camera& camera) {
     glEnable(GL_BLEND);
     glBlendFuncSeparate(GL_ONE_MINUS_DST_ALPHA, GL_ONE, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
     glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-    checkGLError("Setup blend state");
     checkGLError("Setup GL state");
     
     glUseProgram(program);
     glBindVertexArray(vao);
+    if (instances.isComposite()) {
+        // Uploads the table first if an instance changed
+        GLuint table = instances.getTexture();
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, table);
+    }
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, splatTexture.getShTexture());
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, splatTexture.getChunkTexture());
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, splatTexture.getTexture());
     
     // Set uniforms
     glUniformMatrix4fv(u_projection, 1, GL_FALSE, glm::value_ptr(camera.getProjectionMatrix()));
     glUniformMatrix4fv(u_view, 1, GL_FALSE, glm::value_ptr(camera.getViewMatrix()));
     glUniform2f(u_focal, camera.getFx(), camera.getFy());
     glUniform2f(u_viewport, static_cast<float>(width), static_cast<float>(height));
+    glUniform3fv(u_cameraPosition, 1, glm::value_ptr(camera.getPosition()));
     checkGLError("Set uniforms");
     
     // Setup vertex attributes
@@ -240,20 +650,30 @@ void Renderer::render(Camera& camera) {
     glEnableVertexAttribArray(a_position);
     glVertexAttribPointer(a_position, 2, GL_FLOAT, GL_FALSE, 0, 0);
     
-    glBindBuffer(GL_ARRAY_BUFFER, indexVBO);
-    if (a_index == -1) {
-        a_index = glGetAttribLocation(program, "index");
+    size_t indexOffset = 0;
+    if (gpuSort && lodTree.empty()) {
+        glBindBuffer(GL_ARRAY_BUFFER, gpuSort->getIndexBuffer());
+    } else if (indexRing) {
+        glBindBuffer(GL_ARRAY_BUFFER, indexRing->getBuffer());
+        indexOffset = indexRing->getDrawOffset();
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, indexVBO);
     }
     glEnableVertexAttribArray(a_index);
-    glVertexAttribIPointer(a_index, 1, GL_UNSIGNED_INT, 0, 0);
+    glVertexAttribIPointer(a_index, 1, GL_UNSIGNED_INT, 0, reinterpret_cast<const void*>(indexOffset));
     glVertexAttribDivisor(a_index, 1);
     checkGLError("Setup vertex attributes");
     
     // Draw
-    glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, splatCount);
+    profiler.begin(ProfilePhase::Draw);
+    glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, static_cast<GLsizei>(drawCount));
     checkGLError("Draw");
+    if (indexRing && (!gpuSort || !lodTree.empty())) {
+        indexRing->fence();
+    }
     
     glBindVertexArray(0);
+    profiler.endFrame();
 }
 
 void Renderer::resize(int w, int h) {
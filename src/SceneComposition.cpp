@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <stdexcept>
+
+#include "glm/gtc/quaternion.hpp"
+
+#include "Json.h"
+#include "SceneComposition.h"
+#include "Utils.h"
+
+namespace gsplat {
+
+namespace {
+
+// An optional array of count numbers
+bool numbers(const JsonValue& entry, const char* key, size_t count, size_t index, const std::string& path,
+             float* out) {
+    const JsonValue* value = entry.find(key);
+    if (!value) return false;
+    if (value->type != JsonValue::Type::Array || value->items.size() != count) {
+        throw std::runtime_error(path + ": scene " + std::to_string(index) + " '" + key + "' must have " +
+                                 std::to_string(count) + " entries");
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (value->items[i].type != JsonValue::Type::Number) {
+            throw std::runtime_error(path + ": scene " + std::to_string(index) + " '" + key + "' is not numeric");
+        }
+        out[i] = static_cast<float>(value->items[i].number);
+    }
+    return true;
+}
+
+} // namespace
+
+bool SceneComposition::isComposition(const std::string& path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".json";
+}
+
+std::vector<ScenePlacement> SceneComposition::load(const std::string& path) {
+    JsonValue root = parseJson(readFile(path), path);
+    if (root.type != JsonValue::Type::Array) {
+        throw std::runtime_error(path + ": expected an array of scenes");
+    }
+
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    std::vector<ScenePlacement> scenes;
+    for (size_t i = 0; i < root.items.size(); i++) {
+        const JsonValue& entry = root.items[i];
+        const JsonValue* file = entry.type == JsonValue::Type::Object ? entry.find("file") : nullptr;
+        if (!file || file->type != JsonValue::Type::String) {
+            throw std::runtime_error(path + ": scene " + std::to_string(i) + " needs a 'file' string");
+        }
+
+        float translation[3] = {0.0f, 0.0f, 0.0f};
+        float rotation[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+        numbers(entry, "translation", 3, i, path, translation);
+        numbers(entry, "rotation", 4, i, path, rotation);
+        float scale = 1.0f;
+        if (const JsonValue* value = entry.find("scale")) {
+            if (value->type != JsonValue::Type::Number || !(value->number > 0.0)) {
+                throw std::runtime_error(path + ": scene " + std::to_string(i) + " 'scale' must be positive");
+            }
+            scale = static_cast<float>(value->number);
+        }
+        glm::quat q(rotation[0], rotation[1], rotation[2], rotation[3]);
+        if (!(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z > 0.0f)) {
+            throw std::runtime_error(path + ": scene " + std::to_string(i) + " 'rotation' is zero");
+        }
+        glm::mat3 r = glm::mat3_cast(glm::normalize(q));
+
+        ScenePlacement scene;
+        scene.path = (directory / file->string).string();
+        scene.transform = glm::mat4(1.0f);
+        for (int c = 0; c < 3; c++) {
+            for (int k = 0; k < 3; k++) {
+                scene.transform[c][k] = r[c][k] * scale;
+            }
+        }
+        scene.transform[3] = glm::vec4(translation[0], translation[1], translation[2], 1.0f);
+        const JsonValue* visible = entry.find("visible");
+        scene.visible = !visible || visible->type != JsonValue::Type::Bool || visible->number != 0.0;
+        scenes.push_back(std::move(scene));
+    }
+    return scenes;
+}
+
+} // namespace gsplat
@@ -0,0 +1,688 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "SceneFile.h"
+#include "PLYLoader.h"
+#include "Utils.h"
+
+namespace gsplat {
+
+namespace {
+
+constexpr size_t kSplatRecordBytes = 32;
+
+constexpr uint32_t kSpzMagic = 0x5053474e;  // "NGSP"
+constexpr size_t kSpzHeaderBytes = 16;
+constexpr float kSpzColorScale = 0.15f;
+
+constexpr size_t kKSplatHeaderBytes = 4096;
+constexpr size_t kKSplatSectionHeaderBytes = 1024;
+constexpr size_t kKSplatBucketBytes = 12;
+// Harmonic range of compression level 2 when the header leaves it zero
+constexpr float kKSplatDefaultShRange = 1.5f;
+// Degree written; GaussianSplats3D reads up to 2
+constexpr int kKSplatMaxShDegree = 2;
+
+template <typename T>
+T readAt(const std::string& bytes, size_t offset) {
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void append(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+uint8_t toByte(float value) {
+    return static_cast<uint8_t>(std::clamp(std::round(value), 0.0f, 255.0f));
+}
+
+// Byte color from a DC coefficient, truncating as PLYLoader::convertVertex does
+uint8_t colorFromSH(float dc) {
+    return static_cast<uint8_t>(std::clamp((0.5f + SH_C0 * dc) * 255.0f, 0.0f, 255.0f));
+}
+
+// DC coefficient at the middle of the byte's interval, so it maps back to the same byte
+float shFromColor(uint8_t color) {
+    return ((color + 0.5f) / 255.0f - 0.5f) / SH_C0;
+}
+
+float logitFromAlpha(uint8_t alpha) {
+    if (alpha == 255) {
+        return 20.0f;  // Far enough that the sigmoid rounds to exactly 1
+    }
+    float a = (alpha + 0.5f) / 255.0f;
+    return std::log(a / (1.0f - a));
+}
+
+glm::quat normalizedRotation(const glm::quat& q) {
+    return glm::dot(q, q) > 0.0f ? glm::normalize(q) : glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+}
+
+void resizeSource(GaussianData& data, size_t count) {
+    data.positions.resize(count);
+    data.scales.resize(count);
+    data.rotations.resize(count);
+    data.colors.resize(count);
+}
+
+size_t sourceCount(const GaussianData& data) {
+    size_t count = data.positions.size();
+    if (data.scales.size() != count || data.rotations.size() != count || data.colors.size() != count ||
+        data.shRest.size() != count * 3 * shCoefficients(data.shDegree) || (count == 0 && data.count() > 0)) {
+        throw std::runtime_error("Writing a scene needs its source attributes");
+    }
+    return count;
+}
+
+void requireBytes(const std::string& bytes, size_t needed, const std::string& path) {
+    if (bytes.size() < needed) {
+        throw std::runtime_error("Truncated scene file: " + path);
+    }
+}
+
+// antimatter15 .splat: position and linear scale as floats, RGBA8 with
+// linear alpha, rotation w x y z as (q * 128 + 128) bytes. No header.
+void readSplat(const std::string& bytes, const std::string& path, GaussianData& data) {
+    if (bytes.size() % kSplatRecordBytes != 0) {
+        throw std::runtime_error("Not a .splat file (size is not a multiple of 32): " + path);
+    }
+    size_t count = bytes.size() / kSplatRecordBytes;
+    resizeSource(data, count);
+    for (size_t i = 0; i < count; i++) {
+        size_t base = i * kSplatRecordBytes;
+        const unsigned char* record = reinterpret_cast<const unsigned char*>(bytes.data()) + base;
+        data.positions[i] = glm::vec3(readAt<float>(bytes, base), readAt<float>(bytes, base + 4),
+                                      readAt<float>(bytes, base + 8));
+        data.scales[i] = glm::vec3(readAt<float>(bytes, base + 12), readAt<float>(bytes, base + 16),
+                                   readAt<float>(bytes, base + 20));
+        data.colors[i] = glm::u8vec4(record[24], record[25], record[26], record[27]);
+        glm::quat q((record[28] - 128.0f) / 128.0f, (record[29] - 128.0f) / 128.0f,
+                    (record[30] - 128.0f) / 128.0f, (record[31] - 128.0f) / 128.0f);
+        data.rotations[i] = normalizedRotation(q);
+    }
+}
+
+void writeSplat(std::string& out, const GaussianData& data) {
+    size_t count = sourceCount(data);
+    out.reserve(count * kSplatRecordBytes);
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec3& p = data.positions[i];
+        const glm::vec3& s = data.scales[i];
+        glm::quat q = normalizedRotation(data.rotations[i]);
+        append(out, p.x); append(out, p.y); append(out, p.z);
+        append(out, s.x); append(out, s.y); append(out, s.z);
+        append(out, data.colors[i]);
+        append(out, toByte(q.w * 128.0f + 128.0f));
+        append(out, toByte(q.x * 128.0f + 128.0f));
+        append(out, toByte(q.y * 128.0f + 128.0f));
+        append(out, toByte(q.z * 128.0f + 128.0f));
+    }
+}
+
+// Niantic .spz after gunzip: a 16-byte header, then each attribute for all
+// points in turn. Positions are 24-bit fixed point, colors DC coefficients
+// scaled by 0.15, scales (log + 10) * 16. Version 2 stores rotation x y z as
+// bytes with w >= 0, version 3 the smallest three at 9 bits plus sign.
+void readSpz(const std::string& bytes, const std::string& path, int maxShDegree, GaussianData& data) {
+    if (bytes.size() >= 2 && static_cast<unsigned char>(bytes[0]) == 0x1f &&
+        static_cast<unsigned char>(bytes[1]) == 0x8b) {
+        throw std::runtime_error("gzip-compressed .spz files are not supported, decompress it first: " + path);
+    }
+    requireBytes(bytes, kSpzHeaderBytes, path);
+    uint32_t magic = readAt<uint32_t>(bytes, 0);
+    uint32_t version = readAt<uint32_t>(bytes, 4);
+    size_t count = readAt<uint32_t>(bytes, 8);
+    uint32_t shDegree = static_cast<unsigned char>(bytes[12]);
+    uint32_t fractionalBits = static_cast<unsigned char>(bytes[13]);
+    if (magic != kSpzMagic) {
+        throw std::runtime_error("Not an .spz file: " + path);
+    }
+    if (version != 2 && version != 3) {
+        throw std::runtime_error("Unsupported .spz version " + std::to_string(version) + ": " + path);
+    }
+    if (shDegree > 3 || fractionalBits > 23) {
+        throw std::runtime_error("Invalid .spz header: " + path);
+    }
+    size_t rotationBytes = version == 3 ? 4 : 3;
+    size_t positionsAt = kSpzHeaderBytes;
+    size_t alphasAt = positionsAt + count * 9;
+    size_t colorsAt = alphasAt + count;
+    size_t scalesAt = colorsAt + count * 3;
+    size_t rotationsAt = scalesAt + count * 3;
+    size_t shAt = rotationsAt + count * rotationBytes;
+    requireBytes(bytes, shAt + count * shCoefficients(shDegree) * 3, path);
+
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(bytes.data());
+    float positionScale = 1.0f / static_cast<float>(1u << fractionalBits);
+    resizeSource(data, count);
+    // Harmonics are RGB triplets per coefficient, as in shRest
+    size_t fileValues = 3 * shCoefficients(shDegree);
+    data.shDegree = std::min(maxShDegree, static_cast<int>(shDegree));
+    size_t keptValues = 3 * shCoefficients(data.shDegree);
+    data.shRest.resize(count * keptValues);
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 p;
+        for (int c = 0; c < 3; c++) {
+            const unsigned char* v = b + positionsAt + i * 9 + c * 3;
+            int32_t fixed = static_cast<int32_t>(v[0] | (v[1] << 8) | (v[2] << 16));
+            if (fixed & 0x800000) {
+                fixed -= 0x1000000;
+            }
+            p[c] = static_cast<float>(fixed) * positionScale;
+        }
+        data.positions[i] = p;
+
+        const unsigned char* color = b + colorsAt + i * 3;
+        data.colors[i] = glm::u8vec4(colorFromSH((color[0] / 255.0f - 0.5f) / kSpzColorScale),
+                                     colorFromSH((color[1] / 255.0f - 0.5f) / kSpzColorScale),
+                                     colorFromSH((color[2] / 255.0f - 0.5f) / kSpzColorScale),
+                                     b[alphasAt + i]);
+
+        const unsigned char* scale = b + scalesAt + i * 3;
+        data.scales[i] = glm::vec3(std::exp(scale[0] / 16.0f - 10.0f), std::exp(scale[1] / 16.0f - 10.0f),
+                                   std::exp(scale[2] / 16.0f - 10.0f));
+
+        // Components in x y z w order
+        float r[4];
+        const unsigned char* rotation = b + rotationsAt + i * rotationBytes;
+        if (version == 3) {
+            uint32_t packed = rotation[0] | (rotation[1] << 8) | (rotation[2] << 16) |
+                              (static_cast<uint32_t>(rotation[3]) << 24);
+            uint32_t largest = packed >> 30;
+            float sumSquares = 0.0f;
+            for (int c = 3; c >= 0; c--) {
+                if (static_cast<uint32_t>(c) == largest) continue;
+                float magnitude = 0.70710678f * static_cast<float>(packed & 0x1ff) / 511.0f;
+                r[c] = (packed & 0x200) ? -magnitude : magnitude;
+                sumSquares += r[c] * r[c];
+                packed >>= 10;
+            }
+            r[largest] = std::sqrt(std::max(0.0f, 1.0f - sumSquares));
+        } else {
+            for (int c = 0; c < 3; c++) {
+                r[c] = rotation[c] / 127.5f - 1.0f;
+            }
+            r[3] = std::sqrt(std::max(0.0f, 1.0f - r[0] * r[0] - r[1] * r[1] - r[2] * r[2]));
+        }
+        data.rotations[i] = normalizedRotation(glm::quat(r[3], r[0], r[1], r[2]));
+        
+        for (size_t j = 0; j < keptValues; j++) {
+            data.shRest[i * keptValues + j] = (b[shAt + i * fileValues + j] - 128.0f) / 128.0f;
+        }
+    }
+}
+
+// As many fractional bits as the largest coordinate leaves room for
+uint32_t spzFractionalBits(const GaussianData& data) {
+    float maxCoordinate = 0.0f;
+    for (const glm::vec3& p : data.positions) {
+        maxCoordinate = std::max(maxCoordinate, std::max(std::abs(p.x), std::max(std::abs(p.y), std::abs(p.z))));
+    }
+    uint32_t fractionalBits = 23;
+    while (fractionalBits > 0 && maxCoordinate * static_cast<float>(1u << fractionalBits) >= 8388607.0f) {
+        fractionalBits--;
+    }
+    return fractionalBits;
+}
+
+// Version 3
+void writeSpz(std::string& out, const GaussianData& data) {
+    size_t count = sourceCount(data);
+
+    uint32_t fractionalBits = spzFractionalBits(data);
+
+    out.reserve(kSpzHeaderBytes + count * 20);
+    append(out, kSpzMagic);
+    append(out, uint32_t(3));
+    append(out, static_cast<uint32_t>(count));
+    append(out, static_cast<uint8_t>(data.shDegree));
+    append(out, static_cast<uint8_t>(fractionalBits));
+    append(out, uint8_t(0));    // flags
+    append(out, uint8_t(0));    // reserved
+
+    float positionScale = static_cast<float>(1u << fractionalBits);
+    for (const glm::vec3& p : data.positions) {
+        for (int c = 0; c < 3; c++) {
+            int32_t fixed = static_cast<int32_t>(std::clamp(std::round(p[c] * positionScale), -8388608.0f, 8388607.0f));
+            append(out, static_cast<uint8_t>(fixed));
+            append(out, static_cast<uint8_t>(fixed >> 8));
+            append(out, static_cast<uint8_t>(fixed >> 16));
+        }
+    }
+    for (const glm::u8vec4& color : data.colors) {
+        append(out, color.a);
+    }
+    for (const glm::u8vec4& color : data.colors) {
+        for (int c = 0; c < 3; c++) {
+            append(out, toByte((shFromColor(color[c]) * kSpzColorScale + 0.5f) * 255.0f));
+        }
+    }
+    for (const glm::vec3& s : data.scales) {
+        for (int c = 0; c < 3; c++) {
+            append(out, toByte((std::log(s[c]) + 10.0f) * 16.0f));
+        }
+    }
+    for (const glm::quat& rotation : data.rotations) {
+        glm::quat q = normalizedRotation(rotation);
+        float r[4] = {q.x, q.y, q.z, q.w};
+        uint32_t largest = 0;
+        for (uint32_t c = 1; c < 4; c++) {
+            if (std::abs(r[c]) > std::abs(r[largest])) largest = c;
+        }
+        // q and -q are the same rotation; make the dropped component positive
+        float sign = r[largest] < 0.0f ? -1.0f : 1.0f;
+        uint32_t packed = 0;
+        for (uint32_t c = 0; c < 4; c++) {
+            if (c == largest) continue;
+            float value = r[c] * sign;
+            uint32_t magnitude = static_cast<uint32_t>(
+                std::min(std::round(std::abs(value) / 0.70710678f * 511.0f), 511.0f));
+            packed = (packed << 10) | (value < 0.0f ? 0x200u : 0u) | magnitude;
+        }
+        append(out, packed | (largest << 30));
+    }
+    for (float value : data.shRest) {
+        append(out, toByte(value * 128.0f + 128.0f));
+    }
+}
+
+// GaussianSplats3D .ksplat: a 4096-byte header, 1024 bytes per section
+// header, then per section the bucket data and the splats. Level 0 stores
+// float position, linear scale and rotation w x y z, then RGBA8. Levels 1
+// and 2 store positions as 16-bit offsets from their bucket's center and
+// scale and rotation as halfs; they differ only in harmonic precision.
+void readKSplat(const std::string& bytes, const std::string& path, int maxShDegree, GaussianData& data) {
+    requireBytes(bytes, kKSplatHeaderBytes, path);
+    uint32_t versionMajor = static_cast<unsigned char>(bytes[0]);
+    uint32_t versionMinor = static_cast<unsigned char>(bytes[1]);
+    if (versionMajor != 0 || versionMinor < 1) {
+        throw std::runtime_error("Unsupported .ksplat version " + std::to_string(versionMajor) + "." +
+                                 std::to_string(versionMinor) + ": " + path);
+    }
+    uint32_t maxSectionCount = readAt<uint32_t>(bytes, 4);
+    uint32_t splatCount = readAt<uint32_t>(bytes, 16);
+    uint32_t compressionLevel = readAt<uint16_t>(bytes, 20);
+    if (compressionLevel > 2) {
+        throw std::runtime_error("Unsupported .ksplat compression level " + std::to_string(compressionLevel) +
+                                 ": " + path);
+    }
+    requireBytes(bytes, kKSplatHeaderBytes + static_cast<size_t>(maxSectionCount) * kKSplatSectionHeaderBytes, path);
+
+    size_t splatBytes = compressionLevel == 0 ? 44 : 24;
+    size_t shBytes = compressionLevel == 0 ? 4 : 3 - compressionLevel;
+    float shMin = readAt<float>(bytes, 36);
+    float shMax = readAt<float>(bytes, 40);
+    if (shMin == 0.0f && shMax == 0.0f) {
+        shMin = -kKSplatDefaultShRange;
+        shMax = kKSplatDefaultShRange;
+    }
+    
+    // Keep the bands every section has
+    data.shDegree = maxShDegree;
+    for (uint32_t section = 0; section < maxSectionCount; section++) {
+        size_t header = kKSplatHeaderBytes + section * kKSplatSectionHeaderBytes;
+        data.shDegree = std::min<int>(data.shDegree, readAt<uint16_t>(bytes, header + 40));
+    }
+    size_t keptValues = 3 * shCoefficients(data.shDegree);
+    size_t sectionBase = kKSplatHeaderBytes + static_cast<size_t>(maxSectionCount) * kKSplatSectionHeaderBytes;
+    // The count is the header's claim; no more splats fit than the rest of the file holds
+    size_t reserved = std::min<size_t>(splatCount, (bytes.size() - sectionBase) / splatBytes);
+    data.positions.reserve(reserved);
+    data.scales.reserve(reserved);
+    data.rotations.reserve(reserved);
+    data.colors.reserve(reserved);
+    data.shRest.reserve(reserved * keptValues);
+
+    for (uint32_t section = 0; section < maxSectionCount; section++) {
+        size_t header = kKSplatHeaderBytes + section * kKSplatSectionHeaderBytes;
+        size_t sectionSplats = readAt<uint32_t>(bytes, header);
+        size_t maxSplats = readAt<uint32_t>(bytes, header + 4);
+        uint32_t bucketSize = readAt<uint32_t>(bytes, header + 8);
+        size_t bucketCount = readAt<uint32_t>(bytes, header + 12);
+        float bucketBlockSize = readAt<float>(bytes, header + 16);
+        size_t bucketStorageBytes = readAt<uint16_t>(bytes, header + 20);
+        uint32_t scaleRange = readAt<uint32_t>(bytes, header + 24);
+        uint32_t fullBuckets = readAt<uint32_t>(bytes, header + 32);
+        size_t partialBuckets = readAt<uint32_t>(bytes, header + 36);
+        uint32_t shDegree = readAt<uint16_t>(bytes, header + 40);
+        if (scaleRange == 0) {
+            scaleRange = compressionLevel == 0 ? 1 : 32767;
+        }
+        if (sectionSplats > maxSplats || (compressionLevel > 0 && bucketStorageBytes < kKSplatBucketBytes)) {
+            throw std::runtime_error("Invalid .ksplat section header: " + path);
+        }
+
+        size_t stride = splatBytes + shCoefficients(shDegree) * 3 * shBytes;
+        size_t bucketsAt = sectionBase + partialBuckets * 4;
+        size_t dataAt = bucketsAt + bucketCount * bucketStorageBytes;
+        requireBytes(bytes, dataAt + sectionSplats * stride, path);
+        float positionScale = bucketBlockSize * 0.5f / static_cast<float>(scaleRange);
+
+        // Full buckets come first, then the partially filled ones
+        auto bucketLength = [&](size_t b) -> size_t {
+            return b < fullBuckets ? bucketSize : readAt<uint32_t>(bytes, sectionBase + (b - fullBuckets) * 4);
+        };
+        size_t bucket = 0;
+        size_t bucketRemaining = compressionLevel > 0 && bucketCount > 0 ? bucketLength(0) : 0;
+        for (size_t i = 0; i < sectionSplats; i++) {
+            size_t base = dataAt + i * stride;
+            glm::vec3 position, scale;
+            glm::quat rotation;
+            if (compressionLevel == 0) {
+                for (int c = 0; c < 3; c++) {
+                    position[c] = readAt<float>(bytes, base + c * 4);
+                    scale[c] = readAt<float>(bytes, base + 12 + c * 4);
+                }
+                rotation = glm::quat(readAt<float>(bytes, base + 24), readAt<float>(bytes, base + 28),
+                                     readAt<float>(bytes, base + 32), readAt<float>(bytes, base + 36));
+            } else {
+                while (bucketRemaining == 0) {
+                    bucket++;
+                    if (bucket >= bucketCount) {
+                        throw std::runtime_error("Invalid .ksplat buckets: " + path);
+                    }
+                    bucketRemaining = bucketLength(bucket);
+                }
+                bucketRemaining--;
+                size_t center = bucketsAt + bucket * bucketStorageBytes;
+                for (int c = 0; c < 3; c++) {
+                    float offset = static_cast<float>(readAt<uint16_t>(bytes, base + c * 2)) - static_cast<float>(scaleRange);
+                    position[c] = offset * positionScale + readAt<float>(bytes, center + c * 4);
+                    scale[c] = halfToFloat(readAt<uint16_t>(bytes, base + 6 + c * 2));
+                }
+                rotation = glm::quat(halfToFloat(readAt<uint16_t>(bytes, base + 12)),
+                                     halfToFloat(readAt<uint16_t>(bytes, base + 14)),
+                                     halfToFloat(readAt<uint16_t>(bytes, base + 16)),
+                                     halfToFloat(readAt<uint16_t>(bytes, base + 18)));
+            }
+            const unsigned char* color = reinterpret_cast<const unsigned char*>(bytes.data()) + base +
+                                         (compressionLevel == 0 ? 40 : 20);
+            data.positions.push_back(position);
+            data.scales.push_back(scale);
+            data.rotations.push_back(normalizedRotation(rotation));
+            data.colors.push_back(glm::u8vec4(color[0], color[1], color[2], color[3]));
+            
+            // Harmonics follow the color, RGB triplets per coefficient
+            size_t shAt = base + splatBytes;
+            for (size_t j = 0; j < keptValues; j++) {
+                float value;
+                if (compressionLevel == 0) {
+                    value = readAt<float>(bytes, shAt + j * 4);
+                } else if (compressionLevel == 1) {
+                    value = halfToFloat(readAt<uint16_t>(bytes, shAt + j * 2));
+                } else {
+                    value = shMin + static_cast<unsigned char>(bytes[shAt + j]) / 255.0f * (shMax - shMin);
+                }
+                data.shRest.push_back(value);
+            }
+        }
+        sectionBase = dataAt + maxSplats * stride;
+    }
+}
+
+// One uncompressed section
+void writeKSplat(std::string& out, const GaussianData& data) {
+    size_t count = sourceCount(data);
+    int shDegree = std::min(data.shDegree, kKSplatMaxShDegree);
+    size_t fileValues = 3 * shCoefficients(shDegree);
+    size_t dataValues = 3 * shCoefficients(data.shDegree);
+    glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+    if (count > 0) {
+        boundsMin = boundsMax = data.positions[0];
+        for (const glm::vec3& p : data.positions) {
+            boundsMin = glm::min(boundsMin, p);
+            boundsMax = glm::max(boundsMax, p);
+        }
+    }
+    glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+
+    out.assign(kKSplatHeaderBytes + kKSplatSectionHeaderBytes, '\0');
+    auto put = [&out](size_t offset, auto value) {
+        std::memcpy(&out[offset], &value, sizeof(value));
+    };
+    put(0, uint8_t(0));                       // version 0.1
+    put(1, uint8_t(1));
+    put(4, uint32_t(1));                      // max section count
+    put(8, uint32_t(1));                      // section count
+    put(12, static_cast<uint32_t>(count));    // max splat count
+    put(16, static_cast<uint32_t>(count));    // splat count
+    put(20, uint16_t(0));                     // compression level
+    put(24, center.x);
+    put(28, center.y);
+    put(32, center.z);
+
+    size_t section = kKSplatHeaderBytes;
+    put(section, static_cast<uint32_t>(count));
+    put(section + 4, static_cast<uint32_t>(count));
+    put(section + 24, uint32_t(1));           // compression scale range
+    put(section + 40, static_cast<uint16_t>(shDegree));
+
+    out.reserve(out.size() + count * (44 + fileValues * 4));
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec3& p = data.positions[i];
+        const glm::vec3& s = data.scales[i];
+        glm::quat q = normalizedRotation(data.rotations[i]);
+        append(out, p.x); append(out, p.y); append(out, p.z);
+        append(out, s.x); append(out, s.y); append(out, s.z);
+        append(out, q.w); append(out, q.x); append(out, q.y); append(out, q.z);
+        append(out, data.colors[i]);
+        for (size_t j = 0; j < fileValues; j++) {
+            append(out, data.shRest[i * dataValues + j]);
+        }
+    }
+}
+
+// Binary PLY with the attributes PLYLoader reads
+void writePly(std::string& out, const GaussianData& data) {
+    size_t count = sourceCount(data);
+    out = "ply\nformat binary_little_endian 1.0\nelement vertex " + std::to_string(count) + "\n";
+    for (const char* name : {"x", "y", "z", "f_dc_0", "f_dc_1", "f_dc_2", "opacity",
+                             "scale_0", "scale_1", "scale_2", "rot_0", "rot_1", "rot_2", "rot_3"}) {
+        out += std::string("property float ") + name + "\n";
+    }
+    size_t coefficients = shCoefficients(data.shDegree);
+    for (size_t k = 0; k < 3 * coefficients; k++) {
+        out += "property float f_rest_" + std::to_string(k) + "\n";
+    }
+    out += "end_header\n";
+    out.reserve(out.size() + count * (14 + 3 * coefficients) * sizeof(float));
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec3& p = data.positions[i];
+        const glm::vec3& s = data.scales[i];
+        const glm::u8vec4& c = data.colors[i];
+        glm::quat q = normalizedRotation(data.rotations[i]);
+        append(out, p.x); append(out, p.y); append(out, p.z);
+        append(out, shFromColor(c.r)); append(out, shFromColor(c.g)); append(out, shFromColor(c.b));
+        append(out, logitFromAlpha(c.a));
+        append(out, std::log(s.x)); append(out, std::log(s.y)); append(out, std::log(s.z));
+        append(out, q.w); append(out, q.x); append(out, q.y); append(out, q.z);
+        // f_rest_* are grouped by channel
+        const float* rest = data.shRest.data() + i * 3 * coefficients;
+        for (size_t ch = 0; ch < 3; ch++) {
+            for (size_t k = 0; k < coefficients; k++) {
+                append(out, rest[k * 3 + ch]);
+            }
+        }
+    }
+}
+
+} // namespace
+
+const char* sceneFormatName(SceneFormat format) {
+    switch (format) {
+        case SceneFormat::Ply: return "PLY";
+        case SceneFormat::Splat: return "SPLAT";
+        case SceneFormat::KSplat: return "KSPLAT";
+        case SceneFormat::Spz: return "SPZ";
+    }
+    return "unknown";
+}
+
+bool SceneDifference::within(const SceneDifference& tolerance) const {
+    return sameCount && position <= tolerance.position && scale <= tolerance.scale &&
+           rotation <= tolerance.rotation && color <= tolerance.color && alpha <= tolerance.alpha &&
+           harmonics <= tolerance.harmonics;
+}
+
+bool SceneFile::formatFromExtension(const std::string& path, SceneFormat& format) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || path.find_first_of("/\\", dot) != std::string::npos) {
+        return false;
+    }
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == "ply") {
+        format = SceneFormat::Ply;
+    } else if (extension == "splat") {
+        format = SceneFormat::Splat;
+    } else if (extension == "ksplat") {
+        format = SceneFormat::KSplat;
+    } else if (extension == "spz") {
+        format = SceneFormat::Spz;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+SceneFormat SceneFile::detect(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open scene file: " + path);
+    }
+    char magic[4] = {};
+    file.read(magic, sizeof(magic));
+    if (file.gcount() == sizeof(magic)) {
+        if (std::memcmp(magic, "ply", 3) == 0 && (magic[3] == '\n' || magic[3] == '\r')) {
+            return SceneFormat::Ply;
+        }
+        uint32_t word;
+        std::memcpy(&word, magic, sizeof(word));
+        if (word == kSpzMagic) {
+            return SceneFormat::Spz;
+        }
+    }
+    SceneFormat format;
+    if (!formatFromExtension(path, format)) {
+        throw std::runtime_error("Unknown scene format: " + path);
+    }
+    return format;
+}
+
+GaussianData SceneFile::load(const std::string& path, ThreadPool* pool, bool keepSource, const SplatLayout& layout,
+                              bool spatialOrder) {
+    SceneFormat sceneFormat = detect(path);
+    if (sceneFormat == SceneFormat::Ply) {
+        return PLYLoader::load(path, pool, keepSource, layout, spatialOrder);
+    }
+
+    std::string bytes = readFile(path);
+    GaussianData data;
+    switch (sceneFormat) {
+        case SceneFormat::Splat: readSplat(bytes, path, data); break;
+        case SceneFormat::KSplat: readKSplat(bytes, path, layout.shDegree, data); break;
+        case SceneFormat::Spz: readSpz(bytes, path, layout.shDegree, data); break;
+        case SceneFormat::Ply: break;
+    }
+
+    data.format = layout.format;
+    data.shFormat = layout.shFormat;
+    if (spatialOrder) {
+        data.sortSpatially(pool);
+    }
+    data.pack(pool);
+    if (!keepSource) {
+        data.releaseSource();
+    }
+    return data;
+}
+
+void SceneFile::write(const std::string& path, const GaussianData& data, SceneFormat format) {
+    std::string out;
+    switch (format) {
+        case SceneFormat::Ply: writePly(out, data); break;
+        case SceneFormat::Splat: writeSplat(out, data); break;
+        case SceneFormat::KSplat: writeKSplat(out, data); break;
+        case SceneFormat::Spz: writeSpz(out, data); break;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to create scene file: " + path);
+    }
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    if (!file) {
+        throw std::runtime_error("Failed to write scene file: " + path);
+    }
+}
+
+SceneDifference SceneFile::compare(const GaussianData& a, const GaussianData& b) {
+    SceneDifference difference;
+    if (a.positions.size() != b.positions.size()) {
+        difference.sameCount = false;
+        return difference;
+    }
+    size_t coefficientsA = shCoefficients(a.shDegree), coefficientsB = shCoefficients(b.shDegree);
+    size_t shared = std::min(coefficientsA, coefficientsB);
+    // Written so that NaN carries into the maximum
+    auto raise = [](float& maximum, float value) {
+        if (!(value <= maximum)) maximum = value;
+    };
+    for (size_t i = 0; i < a.positions.size(); i++) {
+        raise(difference.position, glm::length(a.positions[i] - b.positions[i]));
+        for (int c = 0; c < 3; c++) {
+            raise(difference.scale, std::abs(b.scales[i][c] / a.scales[i][c] - 1.0f));
+            difference.color = std::max(difference.color, std::abs(int(a.colors[i][c]) - int(b.colors[i][c])));
+        }
+        difference.alpha = std::max(difference.alpha, std::abs(int(a.colors[i].a) - int(b.colors[i].a)));
+        // Angle of the rotation between them, by atan2 as acos loses small
+        // angles to rounding; q and -q are the same rotation
+        glm::quat r = glm::conjugate(a.rotations[i]) * b.rotations[i];
+        raise(difference.rotation,
+              glm::degrees(2.0f * std::atan2(glm::length(glm::vec3(r.x, r.y, r.z)), std::abs(r.w))));
+        for (size_t k = 0; k < shared * 3; k++) {
+            raise(difference.harmonics, std::abs(a.shRest[i * 3 * coefficientsA + k] -
+                                                 b.shRest[i * 3 * coefficientsB + k]));
+        }
+    }
+    return difference;
+}
+
+SceneDifference SceneFile::roundTripTolerance(const GaussianData& data, SceneFormat format) {
+    // Rotations stored as floats still differ by the rounding of their
+    // normalization
+    SceneDifference tolerance;
+    tolerance.rotation = 0.01f;
+    switch (format) {
+        case SceneFormat::Ply:
+            // Scales are stored as logs
+            tolerance.scale = 1e-5f;
+            break;
+        case SceneFormat::Splat:
+            // Half a 1/128 step on each of four components, plus rounding
+            tolerance.rotation = 1.0f;
+            break;
+        case SceneFormat::KSplat:
+            break;
+        case SceneFormat::Spz:
+            // Half a fixed-point step on each axis, half of the 1/16 log scale
+            // step, smallest-three rotations at 9 bits, harmonics at 1/128
+            tolerance.position = 0.87f / static_cast<float>(1u << spzFractionalBits(data));
+            tolerance.scale = std::exp(1.0f / 32.0f) - 1.0f + 1e-4f;
+            tolerance.rotation = 0.3f;
+            tolerance.color = 1;
+            tolerance.harmonics = 0.5f / 128.0f + 1e-5f;
+            break;
+    }
+    return tolerance;
+}
+
+} // namespace gsplat
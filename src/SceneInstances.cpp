@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "SceneInstances.h"
+
+namespace gsplat {
+
+namespace {
+
+// Splats [begin, end) of local through transform. Left to right without
+// contraction, as sort_keys.comp transforms them, so CPU and GPU keys match.
+void transformPositions(const glm::mat4& m, const SoAPositions& local, SoAPositions& world, size_t begin,
+                        size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        float x = local.x[i], y = local.y[i], z = local.z[i];
+        world.x[i] = m[0][0] * x + m[1][0] * y + m[2][0] * z + m[3][0];
+        world.y[i] = m[0][1] * x + m[1][1] * y + m[2][1] * z + m[3][1];
+        world.z[i] = m[0][2] * x + m[1][2] * y + m[2][2] * z + m[3][2];
+    }
+}
+
+} // namespace
+
+SceneInstances::SceneInstances()
+    : transformed(0)
+    , texture(0)
+    , textureRows(0)
+    , tableDirty(true)
+{
+}
+
+SceneInstances::~SceneInstances() {
+    glDeleteTextures(1, &texture);
+}
+
+void SceneInstances::clear() {
+    instances.clear();
+    moved.clear();
+    world = SoAPositions();
+    transformed = 0;
+    tableDirty = true;
+}
+
+size_t SceneInstances::add(size_t first, size_t count, const glm::mat4& transform) {
+    if (!instances.empty() && first < instances.back().first + instances.back().count) {
+        throw std::runtime_error("Scene instances must not overlap");
+    }
+    SplatInstance instance;
+    instance.first = first;
+    instance.count = count;
+    instance.transform = transform;
+    instances.push_back(instance);
+    moved.push_back(false);
+    tableDirty = true;
+    return instances.size() - 1;
+}
+
+void SceneInstances::extendLast(size_t end) {
+    SplatInstance& last = instances.back();
+    last.count = std::max(end, last.first) - last.first;
+    tableDirty = true;
+}
+
+void SceneInstances::setTransform(size_t instance, const glm::mat4& transform) {
+    if (instance >= instances.size()) {
+        throw std::runtime_error("No scene instance " + std::to_string(instance));
+    }
+    instances[instance].transform = transform;
+    moved[instance] = true;
+    tableDirty = true;
+}
+
+void SceneInstances::setVisible(size_t instance, bool visible) {
+    if (instance >= instances.size()) {
+        throw std::runtime_error("No scene instance " + std::to_string(instance));
+    }
+    instances[instance].visible = visible;
+    tableDirty = true;
+}
+
+bool SceneInstances::isComposite() const {
+    return instances.size() > 1 ||
+           (instances.size() == 1 && (instances[0].transform != glm::mat4(1.0f) || !instances[0].visible));
+}
+
+void SceneInstances::updatePositions(const SoAPositions& local) {
+    if (!isComposite()) {
+        world = SoAPositions();
+        transformed = 0;
+        return;
+    }
+
+    // Splats of no instance keep their local positions
+    size_t count = local.size();
+    transformed = std::min(transformed, count);
+    world.resize(count);
+    std::copy(local.x.begin() + transformed, local.x.end(), world.x.begin() + transformed);
+    std::copy(local.y.begin() + transformed, local.y.end(), world.y.begin() + transformed);
+    std::copy(local.z.begin() + transformed, local.z.end(), world.z.begin() + transformed);
+    for (size_t i = 0; i < instances.size(); i++) {
+        const SplatInstance& instance = instances[i];
+        size_t end = std::min(instance.first + instance.count, count);
+        size_t begin = moved[i] ? instance.first : std::max(instance.first, transformed);
+        if (begin < end) {
+            transformPositions(instance.transform, local, world, begin, end);
+        }
+        moved[i] = false;
+    }
+    transformed = count;
+}
+
+GLuint SceneInstances::getTexture() {
+    if (!tableDirty && texture != 0) return texture;
+
+    int rows = static_cast<int>(std::max<size_t>(instances.size(), 1));
+    std::vector<uint32_t> table(static_cast<size_t>(rows) * 16, 0);
+    for (size_t i = 0; i < instances.size(); i++) {
+        const SplatInstance& instance = instances[i];
+        uint32_t* row = &table[i * 16];
+        for (int r = 0; r < 3; r++) {
+            float values[4] = {instance.transform[0][r], instance.transform[1][r], instance.transform[2][r],
+                               instance.transform[3][r]};
+            std::memcpy(row + r * 4, values, sizeof(values));
+        }
+        row[12] = static_cast<uint32_t>(instance.first);
+        row[13] = static_cast<uint32_t>(instance.count);
+        row[14] = instance.visible ? 1u : 0u;
+    }
+
+    if (texture == 0 || rows != textureRows) {
+        // Storage is immutable; the table is tiny, so a new instance gets a new texture
+        glDeleteTextures(1, &texture);
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA32UI, 4, rows);
+        textureRows = rows;
+    } else {
+        glBindTexture(GL_TEXTURE_2D, texture);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 4, rows, GL_RGBA_INTEGER, GL_UNSIGNED_INT, table.data());
+    tableDirty = false;
+    return texture;
+}
+
+void SceneInstances::reportMemory(MemoryReport& report) const {
+    report.add("instance positions", vectorBytes(world.x) + vectorBytes(world.y) + vectorBytes(world.z));
+    report.add("instance table", static_cast<size_t>(textureRows) * 4 * 16, true);
+}
+
+} // namespace gsplat
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <cctype>
+
+#include "Simd.h"
+
+namespace gsplat {
+
+SimdLevel detectSimdLevel() {
+#if defined(GSPLAT_X86_KERNELS)
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.1")) return SimdLevel::SSE41;
+        return SimdLevel::Scalar;
+    }();
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SSE41: return "sse4";
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+bool parseSimdLevel(const std::string& name, SimdLevel& level) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (lower == "auto") {
+        level = detectSimdLevel();
+        return true;
+    }
+    for (SimdLevel candidate : {SimdLevel::Scalar, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (lower == simdLevelName(candidate)) {
+            // Never hand out a level the CPU cannot run
+            level = std::min(candidate, detectSimdLevel());
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace gsplat
@@ -0,0 +1,85 @@
+#include "SortWorker.h"
+
+namespace gsplat {
+
+SortWorker::SortWorker(SortJob job)
+    : job(std::move(job))
+    , stopping(false)
+    , hasRequest(false)
+    , hasResult(false)
+    , busy(false)
+    , pendingViewProj(1.0f)
+    , pendingFrame(0)
+    , completedFrame(0)
+{
+    thread = std::thread(&SortWorker::run, this);
+}
+
+SortWorker::~SortWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    requestCv.notify_all();
+    resultCv.notify_all();
+    thread.join();
+}
+
+void SortWorker::request(const glm::mat4& viewProj, uint64_t frame) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingViewProj = viewProj;
+        pendingFrame = frame;
+        hasRequest = true;
+    }
+    requestCv.notify_one();
+}
+
+bool SortWorker::fetch(std::vector<uint32_t>& depthIndex, uint64_t& frame, bool wait) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (wait) {
+        resultCv.wait(lock, [this] { return hasResult || stopping || (!hasRequest && !busy); });
+    }
+    frame = completedFrame;
+    if (!hasResult) return false;
+
+    depthIndex.swap(ready);
+    hasResult = false;
+    return true;
+}
+
+void SortWorker::reportMemory(MemoryReport& report, const std::function<void()>& inspect) {
+    std::unique_lock<std::mutex> lock(mutex);
+    // A new job only starts under the lock, so it stays idle until we return
+    resultCv.wait(lock, [this] { return !busy || stopping; });
+    report.add("sort worker buffers", vectorBytes(working) + vectorBytes(ready));
+    if (inspect) inspect();
+}
+
+void SortWorker::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        requestCv.wait(lock, [this] { return hasRequest || stopping; });
+        if (stopping) return;
+
+        glm::mat4 viewProj = pendingViewProj;
+        uint64_t frame = pendingFrame;
+        hasRequest = false;
+        busy = true;
+
+        lock.unlock();
+        bool written = job(viewProj, working);
+        lock.lock();
+
+        // Publish, recycling whichever buffer the renderer last handed back
+        if (written) {
+            working.swap(ready);
+            hasResult = true;
+        }
+        completedFrame = frame;
+        busy = false;
+        resultCv.notify_all();
+    }
+}
+
+} // namespace gsplat
@@ -0,0 +1,294 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SplatCache.h"
+
+namespace gsplat {
+
+namespace {
+
+const char kMagic[8] = {'G', 'S', 'P', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint64_t kAlignment = 4096;
+// Bytes read at a time while hashing the source
+constexpr size_t kHashBlockBytes = 1 << 20;
+// Bytes copied out of the mapping before its pages are released
+constexpr uint64_t kCopyBlockBytes = 16 << 20;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t splatCount;
+    // Layout the cache was written for; shDegree is what the source had of it
+    uint32_t format;      // SplatFormat
+    uint32_t shFormat;    // ShFormat
+    uint32_t shMaxDegree;
+    uint32_t shDegree;
+    
+    // Source identity
+    uint64_t sourceSize;
+    int64_t sourceMtimeNs;
+    uint64_t sourceHash;
+    
+    float boundsMin[3];
+    float boundsMax[3];
+    
+    // Byte offsets of the sections: packedData, then x, y, z, then chunkData, then shData
+    uint64_t packedOffset;
+    uint64_t positionsOffset;
+    uint64_t chunksOffset;
+    uint64_t shOffset;
+    uint64_t fileSize;
+};
+
+struct SourceInfo {
+    uint64_t size;
+    int64_t mtimeNs;
+};
+
+uint64_t alignUp(uint64_t value) {
+    return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+bool statSource(const std::string& path, SourceInfo& info) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    info.size = static_cast<uint64_t>(st.st_size);
+    info.mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+// FNV-1a over the size and the whole file, streamed in blocks. Still far
+// cheaper than a parse, and it survives copies that reset mtime.
+uint64_t hashSource(const std::string& path, uint64_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const unsigned char* bytes, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(reinterpret_cast<const unsigned char*>(&size), sizeof(size));
+    
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return 0;
+    std::vector<unsigned char> buffer(kHashBlockBytes);
+    size_t read;
+    while ((read = std::fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+        mix(buffer.data(), read);
+    }
+    std::fclose(file);
+    return hash;
+}
+
+// Read-only mapping released on scope exit
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) : data(nullptr), size(0) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* ptr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr != MAP_FAILED) {
+                data = static_cast<const unsigned char*>(ptr);
+                size = static_cast<size_t>(st.st_size);
+                // Advice values are not flags; each needs its own call
+                madvise(ptr, size, MADV_SEQUENTIAL);
+                madvise(ptr, size, MADV_WILLNEED);
+            }
+        }
+        close(fd);
+    }
+    ~MappedFile() {
+        if (data) munmap(const_cast<unsigned char*>(data), size);
+    }
+    
+    // Drop the whole pages within [begin, end) from the mapping; they are
+    // read from the file again if touched
+    void release(uint64_t begin, uint64_t end) const {
+        const uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        uint64_t first = (begin + page - 1) / page * page;
+        uint64_t last = std::min<uint64_t>(end, size) / page * page;
+        if (first < last) {
+            madvise(const_cast<unsigned char*>(data) + first, last - first, MADV_DONTNEED);
+        }
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    const unsigned char* data;
+    size_t size;
+};
+
+// Copy count values at offset out of file in blocks, releasing each block's
+// pages once copied, so the mapping and the copy never both hold a section
+template <typename T>
+void copyOut(const MappedFile& file, uint64_t offset, uint64_t count, std::vector<T>& out) {
+    out.resize(count);
+    const uint64_t bytes = count * sizeof(T);
+    for (uint64_t done = 0; done < bytes; done += kCopyBlockBytes) {
+        uint64_t block = std::min<uint64_t>(kCopyBlockBytes, bytes - done);
+        std::memcpy(reinterpret_cast<unsigned char*>(out.data()) + done, file.data + offset + done, block);
+        file.release(offset + done, offset + done + block);
+    }
+}
+
+// Whether count elements of elementBytes each, from offset, lie within a
+// file of size bytes; divides rather than multiplies, so header values
+// that would overflow the section's size are rejected too
+bool sectionFits(uint64_t offset, uint64_t count, uint64_t elementBytes, uint64_t size) {
+    if (offset > size) return false;
+    return elementBytes == 0 || count <= (size - offset) / elementBytes;
+}
+
+bool writeAt(std::FILE* file, uint64_t offset, const void* data, size_t bytes) {
+    if (std::fseek(file, static_cast<long>(offset), SEEK_SET) != 0) return false;
+    return bytes == 0 || std::fwrite(data, 1, bytes, file) == bytes;
+}
+
+} // namespace
+
+std::string SplatCache::pathFor(const std::string& sourcePath) {
+    return sourcePath + ".gsplatcache";
+}
+
+bool SplatCache::load(const std::string& cachePath, const std::string& sourcePath, const SplatLayout& layout,
+                      GaussianData& data) {
+    SourceInfo source;
+    if (!statSource(sourcePath, source)) return false;
+    
+    MappedFile file(cachePath);
+    if (!file.data || file.size < sizeof(CacheHeader)) return false;
+    
+    CacheHeader header;
+    std::memcpy(&header, file.data, sizeof(CacheHeader));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kVersion || header.headerSize != sizeof(CacheHeader)) {
+        std::cout << "Ignoring cache " << cachePath << ": different format version" << std::endl;
+        return false;
+    }
+    
+    // Stale unless the source is the same size and either untouched or identical in content
+    if (header.sourceSize != source.size) return false;
+    if (header.sourceMtimeNs != source.mtimeNs && header.sourceHash != hashSource(sourcePath, source.size)) {
+        return false;
+    }
+    
+    if (header.format != static_cast<uint32_t>(layout.format) ||
+        header.shFormat != static_cast<uint32_t>(layout.shFormat) ||
+        header.shMaxDegree != static_cast<uint32_t>(layout.shDegree) || header.shDegree > header.shMaxDegree) {
+        std::cout << "Ignoring cache " << cachePath << ": different splat format" << std::endl;
+        return false;
+    }
+    
+    SplatFormat format = layout.format;
+    int shDegree = static_cast<int>(header.shDegree);
+    // The header is untrusted: every section must lie within the mapping
+    // before any size is derived from the splat count
+    uint64_t n = header.splatCount;
+    uint64_t splatShWords = shTexels(shDegree, layout.shFormat) * 4;
+    uint64_t chunkCount = format == SplatFormat::Compressed ?
+        n / kSplatChunkSize + (n % kSplatChunkSize != 0) : 0;
+    if (header.fileSize != file.size ||
+        !sectionFits(header.packedOffset, n, splatWords(format) * sizeof(uint32_t), file.size) ||
+        !sectionFits(header.positionsOffset, n, 3 * sizeof(float), file.size) ||
+        !sectionFits(header.chunksOffset, chunkCount, kChunkWords * sizeof(uint32_t), file.size) ||
+        !sectionFits(header.shOffset, n, splatShWords * sizeof(uint32_t), file.size)) {
+        std::cerr << "Ignoring corrupt cache " << cachePath << std::endl;
+        return false;
+    }
+    uint64_t packedWords = n * splatWords(format);
+    uint64_t positionBytes = n * sizeof(float);
+    uint64_t chunkWords = chunkCount * kChunkWords;
+    uint64_t shWords = n * splatShWords;
+    
+    // Bulk copies out of the mapping; no per-splat work. The data is not
+    // used from the mapping itself: the renderer edits, appends to and moves
+    // the vectors, so they must own their storage. Releasing the mapped
+    // pages as they are copied keeps the scene from being held twice.
+    GaussianData loaded;
+    loaded.format = format;
+    loaded.shDegree = shDegree;
+    loaded.shFormat = layout.shFormat;
+    copyOut(file, header.packedOffset, packedWords, loaded.packedData);
+    copyOut(file, header.positionsOffset, n, loaded.worldPositions.x);
+    copyOut(file, header.positionsOffset + positionBytes, n, loaded.worldPositions.y);
+    copyOut(file, header.positionsOffset + 2 * positionBytes, n, loaded.worldPositions.z);
+    copyOut(file, header.chunksOffset, chunkWords, loaded.chunkData);
+    copyOut(file, header.shOffset, shWords, loaded.shData);
+    
+    loaded.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    loaded.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    
+    data = std::move(loaded);
+    return true;
+}
+
+bool SplatCache::write(const std::string& cachePath, const std::string& sourcePath, const SplatLayout& layout,
+                       const GaussianData& data) {
+    SourceInfo source;
+    if (!statSource(sourcePath, source)) {
+        std::cerr << "Not writing cache: cannot stat " << sourcePath << std::endl;
+        return false;
+    }
+    
+    uint64_t n = data.count();
+    CacheHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.headerSize = sizeof(CacheHeader);
+    header.splatCount = n;
+    header.format = static_cast<uint32_t>(layout.format);
+    header.shFormat = static_cast<uint32_t>(layout.shFormat);
+    header.shMaxDegree = static_cast<uint32_t>(layout.shDegree);
+    header.shDegree = static_cast<uint32_t>(data.shDegree);
+    header.sourceSize = source.size;
+    header.sourceMtimeNs = source.mtimeNs;
+    header.sourceHash = hashSource(sourcePath, source.size);
+    for (int i = 0; i < 3; i++) {
+        header.boundsMin[i] = data.boundsMin[i];
+        header.boundsMax[i] = data.boundsMax[i];
+    }
+    header.packedOffset = alignUp(sizeof(CacheHeader));
+    header.positionsOffset = alignUp(header.packedOffset + data.packedData.size() * sizeof(uint32_t));
+    // Empty sections are not padded, so the file ends with its last section
+    uint64_t positionsEnd = header.positionsOffset + 3 * n * sizeof(float);
+    header.chunksOffset = data.chunkData.empty() ? positionsEnd : alignUp(positionsEnd);
+    uint64_t chunksEnd = header.chunksOffset + data.chunkData.size() * sizeof(uint32_t);
+    header.shOffset = data.shData.empty() ? chunksEnd : alignUp(chunksEnd);
+    header.fileSize = header.shOffset + data.shData.size() * sizeof(uint32_t);
+    
+    std::string tempPath = cachePath + ".tmp";
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Not writing cache: cannot create " << tempPath << std::endl;
+        return false;
+    }
+    
+    size_t positionBytes = n * sizeof(float);
+    bool ok = writeAt(file, 0, &header, sizeof(CacheHeader)) &&
+              writeAt(file, header.packedOffset, data.packedData.data(), data.packedData.size() * sizeof(uint32_t)) &&
+              writeAt(file, header.positionsOffset, data.worldPositions.x.data(), positionBytes) &&
+              writeAt(file, header.positionsOffset + positionBytes, data.worldPositions.y.data(), positionBytes) &&
+              writeAt(file, header.positionsOffset + 2 * positionBytes, data.worldPositions.z.data(), positionBytes) &&
+              writeAt(file, header.chunksOffset, data.chunkData.data(), data.chunkData.size() * sizeof(uint32_t)) &&
+              writeAt(file, header.shOffset, data.shData.data(), data.shData.size() * sizeof(uint32_t));
+    ok = (std::fclose(file) == 0) && ok;
+    
+    if (!ok || std::rename(tempPath.c_str(), cachePath.c_str()) != 0) {
+        std::cerr << "Failed to write cache " << cachePath << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace gsplat
@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <cfloat>
+
+#include "SplatChunks.h"
+
+namespace gsplat {
+
+void SplatChunks::update(const SoAPositions& positions, size_t count) {
+    count = std::min(count, positions.size());
+    if (count < covered) {
+        clear();
+    }
+    // The last chunk may have been partial
+    size_t first = covered / kSplatChunkSize;
+    bounds.resize((count + kSplatChunkSize - 1) / kSplatChunkSize);
+    for (size_t c = first; c < bounds.size(); c++) {
+        computeChunk(positions, c, count);
+    }
+    covered = count;
+}
+
+void SplatChunks::refresh(const SoAPositions& positions, size_t first, size_t last) {
+    last = std::min(last, covered);
+    if (first >= last) return;
+    for (size_t c = first / kSplatChunkSize; c <= (last - 1) / kSplatChunkSize; c++) {
+        computeChunk(positions, c, covered);
+    }
+}
+
+void SplatChunks::computeChunk(const SoAPositions& positions, size_t chunk, size_t count) {
+    glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+    for (size_t i = chunk * kSplatChunkSize, end = std::min(count, i + kSplatChunkSize); i < end; i++) {
+        glm::vec3 p(positions.x[i], positions.y[i], positions.z[i]);
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+    bounds[chunk] = {lo, hi};
+}
+
+void SplatChunks::clear() {
+    bounds.clear();
+    covered = 0;
+}
+
+void SplatChunks::reportMemory(MemoryReport& report) const {
+    report.add("chunk bounds", vectorBytes(bounds));
+}
+
+} // namespace gsplat
@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "SplatEditor.h"
+#include "SplatTexture.h"
+#include "ThreadPool.h"
+
+namespace gsplat {
+
+namespace {
+
+// Texture rows per task, so tasks never share a dirty row
+constexpr size_t kBlockRows = 64;
+
+// Alpha of a packed RGBA8 color, in the top byte
+constexpr uint32_t kAlphaMask = 0xff000000u;
+
+// Where a splat's flag and color live in packedData
+struct PackedWords {
+    uint32_t* packed;
+    size_t stride;
+    size_t flagWord;
+    uint32_t flagMask;
+    size_t colorWord;
+
+    explicit PackedWords(GaussianData& data)
+        : packed(data.packedData.data())
+        , stride(splatWords(data.format))
+        , flagWord(data.format == SplatFormat::Compressed ? 2 : 3)
+        , flagMask(data.format == SplatFormat::Compressed ? 0x80000000u : 1u)
+        , colorWord(data.format == SplatFormat::Compressed ? 3 : 7)
+    {
+    }
+
+    bool selected(size_t i) const { return (packed[i * stride + flagWord] & flagMask) != 0; }
+    void setSelected(size_t i, bool value) {
+        uint32_t& word = packed[i * stride + flagWord];
+        word = value ? word | flagMask : word & ~flagMask;
+    }
+    uint32_t& color(size_t i) { return packed[i * stride + colorWord]; }
+    // False for deleted, hidden and fully transparent splats
+    bool selectable(size_t i) const { return (packed[i * stride + colorWord] & kAlphaMask) != 0; }
+};
+
+bool inside(const SelectionShape& shape, const glm::vec3& p) {
+    switch (shape.type) {
+        case SelectionShape::Type::Box: {
+            glm::vec4 q = shape.worldToBox * glm::vec4(p, 1.0f);
+            return std::abs(q.x) <= 1.0f && std::abs(q.y) <= 1.0f && std::abs(q.z) <= 1.0f;
+        }
+        case SelectionShape::Type::Sphere: {
+            glm::vec3 d = p - shape.center;
+            return glm::dot(d, d) <= shape.radius * shape.radius;
+        }
+        case SelectionShape::Type::Brush: {
+            glm::vec4 clip = shape.viewProj * glm::vec4(p, 1.0f);
+            if (clip.w <= 0.0f) return false;
+            glm::vec2 pixel((clip.x / clip.w * 0.5f + 0.5f) * shape.viewport.x,
+                            (0.5f - clip.y / clip.w * 0.5f) * shape.viewport.y);
+            glm::vec2 d = pixel - shape.pixel;
+            return glm::dot(d, d) <= shape.radius * shape.radius;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+SelectionShape SelectionShape::box(const glm::vec3& min, const glm::vec3& max) {
+    glm::mat4 worldToBox(1.0f);
+    for (int k = 0; k < 3; k++) {
+        float halfExtent = std::max((max[k] - min[k]) * 0.5f, 1e-30f);
+        worldToBox[k][k] = 1.0f / halfExtent;
+        worldToBox[3][k] = -(min[k] + max[k]) * 0.5f / halfExtent;
+    }
+    return orientedBox(worldToBox);
+}
+
+SelectionShape SelectionShape::orientedBox(const glm::mat4& worldToBox) {
+    SelectionShape shape;
+    shape.type = Type::Box;
+    shape.worldToBox = worldToBox;
+    return shape;
+}
+
+SelectionShape SelectionShape::sphere(const glm::vec3& center, float radius) {
+    SelectionShape shape;
+    shape.type = Type::Sphere;
+    shape.center = center;
+    shape.radius = radius;
+    return shape;
+}
+
+SelectionShape SelectionShape::brush(const glm::mat4& viewProj, const glm::vec2& viewport, const glm::vec2& pixel,
+                                     float radius) {
+    SelectionShape shape;
+    shape.type = Type::Brush;
+    shape.viewProj = viewProj;
+    shape.viewport = viewport;
+    shape.pixel = pixel;
+    shape.radius = radius;
+    return shape;
+}
+
+SplatEditor::SplatEditor(GaussianData& data)
+    : data(data)
+    , pool(nullptr)
+    , selected(0)
+    , edited(false)
+{
+}
+
+void SplatEditor::reset() {
+    selected = 0;
+    edited = false;
+    hiddenColors = std::vector<uint32_t>();
+    dirtyRows.clear();
+}
+
+size_t SplatEditor::splatsPerRow() const {
+    return SplatTexture::kWidth * 4 / splatWords(data.format);
+}
+
+template <typename Edit>
+size_t SplatEditor::apply(const Edit& edit) {
+    size_t count = data.count();
+    size_t rowSplats = splatsPerRow();
+    dirtyRows.resize((count + rowSplats - 1) / rowSplats, 0);
+
+    const size_t blockSplats = kBlockRows * rowSplats;
+    uint32_t blocks = static_cast<uint32_t>((count + blockSplats - 1) / blockSplats);
+    std::vector<size_t> changed(blocks, 0);
+    std::vector<size_t> selectedInBlock(blocks, 0);
+    PackedWords words(data);
+    auto task = [&](uint32_t block) {
+        size_t begin = block * blockSplats;
+        size_t end = std::min(count, begin + blockSplats);
+        size_t n = 0, s = 0;
+        for (size_t i = begin; i < end; i++) {
+            if (edit(words, i)) {
+                n++;
+                dirtyRows[i / rowSplats] = 1;
+            }
+            s += words.selected(i) ? 1 : 0;
+        }
+        changed[block] = n;
+        selectedInBlock[block] = s;
+    };
+    if (pool && blocks > 1) {
+        pool->run(blocks, task);
+    } else {
+        for (uint32_t block = 0; block < blocks; block++) {
+            task(block);
+        }
+    }
+
+    size_t total = 0;
+    selected = 0;
+    for (uint32_t block = 0; block < blocks; block++) {
+        total += changed[block];
+        selected += selectedInBlock[block];
+    }
+    edited = edited || total > 0;
+    return total;
+}
+
+size_t SplatEditor::select(const SoAPositions& positions, const SelectionShape& shape, SelectionMode mode) {
+    if (positions.size() < data.count()) {
+        throw std::runtime_error("Selection needs a position for every splat");
+    }
+    apply([&](PackedWords& words, size_t i) {
+        bool was = words.selected(i);
+        bool now = false;
+        if (words.selectable(i)) {
+            switch (mode) {
+                case SelectionMode::Replace:
+                    now = inside(shape, glm::vec3(positions.x[i], positions.y[i], positions.z[i]));
+                    break;
+                case SelectionMode::Add:
+                    now = was || inside(shape, glm::vec3(positions.x[i], positions.y[i], positions.z[i]));
+                    break;
+                case SelectionMode::Subtract:
+                    now = was && !inside(shape, glm::vec3(positions.x[i], positions.y[i], positions.z[i]));
+                    break;
+            }
+        }
+        if (now == was) return false;
+        words.setSelected(i, now);
+        return true;
+    });
+    return selected;
+}
+
+size_t SplatEditor::clearSelection() {
+    if (selected == 0) return 0;
+    apply([](PackedWords& words, size_t i) {
+        if (!words.selected(i)) return false;
+        words.setSelected(i, false);
+        return true;
+    });
+    return selected;
+}
+
+size_t SplatEditor::invertSelection() {
+    apply([](PackedWords& words, size_t i) {
+        bool now = !words.selected(i) && words.selectable(i);
+        if (now == words.selected(i)) return false;
+        words.setSelected(i, now);
+        return true;
+    });
+    return selected;
+}
+
+size_t SplatEditor::deleteSelected() {
+    if (selected == 0) return 0;
+    return apply([](PackedWords& words, size_t i) {
+        if (!words.selected(i)) return false;
+        words.setSelected(i, false);
+        words.color(i) &= ~kAlphaMask;
+        return true;
+    });
+}
+
+size_t SplatEditor::hideSelected() {
+    if (selected == 0) return 0;
+    hiddenColors.resize(data.count(), 0);
+    return apply([&](PackedWords& words, size_t i) {
+        if (!words.selected(i)) return false;
+        words.setSelected(i, false);
+        hiddenColors[i] = words.color(i);
+        words.color(i) &= ~kAlphaMask;
+        return true;
+    });
+}
+
+size_t SplatEditor::unhideAll() {
+    if (hiddenColors.empty()) return 0;
+    size_t restored = apply([&](PackedWords& words, size_t i) {
+        if (i >= hiddenColors.size() || hiddenColors[i] == 0) return false;
+        words.color(i) = hiddenColors[i];
+        return true;
+    });
+    hiddenColors = std::vector<uint32_t>();
+    return restored;
+}
+
+size_t SplatEditor::recolorSelected(const glm::u8vec3& color) {
+    if (selected == 0) return 0;
+    const uint32_t rgb = color.r | (color.g << 8) | (static_cast<uint32_t>(color.b) << 16);
+    return apply([&](PackedWords& words, size_t i) {
+        if (!words.selected(i)) return false;
+        uint32_t recolored = (words.color(i) & kAlphaMask) | rgb;
+        if (recolored == words.color(i)) return false;
+        words.color(i) = recolored;
+        return true;
+    });
+}
+
+std::vector<std::pair<size_t, size_t>> SplatEditor::takeDirtyRanges() {
+    std::vector<std::pair<size_t, size_t>> ranges;
+    size_t rowSplats = splatsPerRow();
+    size_t count = data.count();
+    for (size_t row = 0; row < dirtyRows.size(); row++) {
+        if (!dirtyRows[row]) continue;
+        size_t end = row + 1;
+        while (end < dirtyRows.size() && dirtyRows[end]) {
+            end++;
+        }
+        ranges.emplace_back(row * rowSplats, std::min(end * rowSplats, count));
+        std::fill(dirtyRows.begin() + row, dirtyRows.begin() + end, 0);
+        row = end;
+    }
+    return ranges;
+}
+
+void SplatEditor::reportMemory(MemoryReport& report) const {
+    report.add("splat edits", vectorBytes(hiddenColors) + vectorBytes(dirtyRows));
+}
+
+} // namespace gsplat
@@ -1,41 +1,707 @@
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <numeric>
 #include <vector>
 
 #include "SplatSort.h"
+#include "DepthKeys.h"
+#include "ThreadPool.h"
 
 namespace gsplat {
 
-void SplatSort::sort(
+namespace {
+
+struct RadixPass {
+    uint32_t shift;
+    uint32_t bits;
+};
+
+// 16-bit keys take one counting pass; 32-bit keys take three 11-bit passes
+// so each pass scatters into a cache-friendly number of buckets
+constexpr RadixPass kPasses16[] = {{0, 16}};
+constexpr RadixPass kPasses32[] = {{0, 11}, {11, 11}, {22, 10}};
+
+// Below this many splats per block, extra threads cost more than they save
+constexpr uint32_t kMinBlockSize = 1u << 16;
+
+// Element moves per splat an incremental refine may spend before it is
+// cheaper to radix sort from scratch
+constexpr uint64_t kRefineMovesPerSplat = 4;
+
+// Disorder probe: evenly spaced samples of the previous order, each compared
+// against the next few entries under the new keys
+constexpr uint32_t kProbeSamples = 4096;
+constexpr uint32_t kProbeWindow = 16;
+
+// A refine of culled keys sorts from scratch once more than one visible
+// splat in this many came into view
+constexpr uint64_t kMaxEnteringShare = 8;
+
+// Slot of a splat that is not visible
+constexpr uint32_t kNotVisible = UINT32_MAX;
+
+// Clusters up to this size are insertion sorted rather than radix sorted
+constexpr uint32_t kSmallCluster = 32;
+
+// Stable insertion sort of keys/values; gives up once more than budget
+// elements have been shifted. The arrays stay a valid permutation either way.
+bool insertionSortBounded(uint32_t* keys, uint32_t* values, uint32_t count, uint64_t budget) {
+    uint64_t moves = 0;
+    for (uint32_t i = 1; i < count; i++) {
+        uint32_t key = keys[i];
+        if (keys[i - 1] <= key) continue;
+
+        uint32_t value = values[i];
+        uint32_t j = i;
+        while (j > 0 && keys[j - 1] > key) {
+            keys[j] = keys[j - 1];
+            values[j] = values[j - 1];
+            j--;
+        }
+        keys[j] = key;
+        values[j] = value;
+
+        moves += i - j;
+        if (moves > budget) return false;
+    }
+    return true;
+}
+
+// Stable radix sort of one cluster on the calling thread, writing positions
+// first + i to out. keys is consumed; keysTmp and indexTmp hold count each.
+void sortCluster(uint32_t* keys, uint32_t* keysTmp, uint32_t* indexTmp, uint32_t first, uint32_t count,
+                 uint32_t* out) {
+    std::iota(out, out + count, first);
+    if (count <= kSmallCluster) {
+        insertionSortBounded(keys, out, count, UINT64_MAX);
+        return;
+    }
+    uint32_t counts[1u << 11];
+    uint32_t* srcKeys = keys;
+    uint32_t* srcIndex = out;
+    for (const RadixPass& pass : kPasses32) {
+        const uint32_t radixSize = 1u << pass.bits;
+        const uint32_t mask = radixSize - 1;
+        std::fill(counts, counts + radixSize, 0u);
+        for (uint32_t i = 0; i < count; i++) {
+            counts[(srcKeys[i] >> pass.shift) & mask]++;
+        }
+        if (counts[(srcKeys[0] >> pass.shift) & mask] == count) continue;
+        uint32_t offset = 0;
+        for (uint32_t d = 0; d < radixSize; d++) {
+            uint32_t n = counts[d];
+            counts[d] = offset;
+            offset += n;
+        }
+        uint32_t* dstKeys = srcKeys == keys ? keysTmp : keys;
+        uint32_t* dstIndex = srcIndex == out ? indexTmp : out;
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t pos = counts[(srcKeys[i] >> pass.shift) & mask]++;
+            dstKeys[pos] = srcKeys[i];
+            dstIndex[pos] = srcIndex[i];
+        }
+        srcKeys = dstKeys;
+        srcIndex = dstIndex;
+    }
+    if (srcIndex != out) {
+        std::memcpy(out, srcIndex, count * sizeof(uint32_t));
+    }
+}
+
+float angleBetweenDegrees(const DepthAxis& a, const DepthAxis& b) {
+    float dot = a.x * b.x + a.y * b.y + a.z * b.z;
+    float lengths = std::sqrt((a.x * a.x + a.y * a.y + a.z * a.z) * (b.x * b.x + b.y * b.y + b.z * b.z));
+    if (lengths <= 0.0f) return 180.0f;
+    return glm::degrees(std::acos(std::clamp(dot / lengths, -1.0f, 1.0f)));
+}
+
+} // namespace
+
+SplatSortContext::SplatSortContext(SortKeyBits keyBits)
+    : keyBits(keyBits)
+    , threadPool(nullptr)
+    , simdLevel(detectSimdLevel())
+    , refineAngle(2.0f)
+    , culling(false)
+    , chunks(nullptr)
+    , lastPath(SortPath::Full)
+    , visibleCount(0)
+    , hasPrevious(false)
+    , prevAxis{0.0f, 0.0f, 0.0f, 0.0f}
+    , prevX(nullptr)
+    , prevCount(0)
+    , prevKeyBits(keyBits)
+    , prevCulling(false)
+    , prevChunked(false)
+    , prevViewProj(1.0f)
+{
+}
+
+void SplatSortContext::reset() {
+    hasPrevious = false;
+    order.clear();
+}
+
+bool SplatSortContext::sort(
     const glm::mat4& viewProj,
-    const float* positions,
+    const float* x,
+    const float* y,
+    const float* z,
     uint32_t vertexCount,
     std::vector<uint32_t>& depthIndex
 ) {
-    // Compute depths
-    std::vector<std::pair<float, uint32_t>> depths(vertexCount);
-    
-    for (uint32_t i = 0; i < vertexCount; i++) {
-        glm::vec3 pos(
-            positions[i * 3 + 0],
-            positions[i * 3 + 1],
-            positions[i * 3 + 2]
-        );
-        
-        glm::vec4 projected = viewProj * glm::vec4(pos, 1.0f);
-        float depth = projected.z / projected.w;
-        
-        depths[i] = {depth, i};
-    }
-    
-    // Sort by depth (front to back for weighted blended transparency)
-    std::sort(depths.begin(), depths.end(),
-        [](const auto& a, const auto& b) { return a.first < b.first; });
-    
-    // Extract sorted indices
-    depthIndex.resize(vertexCount);
-    for (uint32_t i = 0; i < vertexCount; i++) {
-        depthIndex[i] = depths[i].second;
+    if (!updateOrder(viewProj, x, y, z, vertexCount)) return false;
+    depthIndex.resize(visibleCount);
+    writeOrder(depthIndex.data());
+    return true;
+}
+
+bool SplatSortContext::sort(
+    const glm::mat4& viewProj,
+    const float* x,
+    const float* y,
+    const float* z,
+    uint32_t vertexCount,
+    uint32_t* out
+) {
+    if (!updateOrder(viewProj, x, y, z, vertexCount)) return false;
+    writeOrder(out);
+    return true;
+}
+
+void SplatSortContext::writeOrder(uint32_t* out) {
+    std::copy(order.begin(), order.end(), out);
+}
+
+bool SplatSortContext::updateOrder(const glm::mat4& viewProj, const float* x, const float* y, const float* z,
+                                   uint32_t vertexCount) {
+    const DepthAxis axis = depthAxisFromViewProj(viewProj);
+    const bool chunked = chunks && keyBits == SortKeyBits::Bits32 && vertexCount > 0 &&
+                         chunks->splatCount() == vertexCount;
+    const bool sameInput = hasPrevious && prevX == x && prevCount == vertexCount && prevKeyBits == keyBits &&
+                           prevCulling == culling && prevChunked == chunked;
+
+    // Translation only moves the axis offset, which shifts every depth equally,
+    // but it changes what is culled
+    bool sameView = axis.x == prevAxis.x && axis.y == prevAxis.y && axis.z == prevAxis.z;
+    if (culling) {
+        sameView = viewProj == prevViewProj;
+    }
+    if (sameInput && sameView) {
+        lastPath = SortPath::Skipped;
+        return false;
+    }
+
+    // Culled and chunked keys are laid out by position in visible, which
+    // changes with the view; order is mapped back to splat indices at the end
+    const bool mapped = culling || chunked;
+    visibleCount = 0;
+    clusters.clear();
+    if (chunked) {
+        chunkKeys(viewProj, axis, x, y, z, vertexCount);
+    } else if (vertexCount > 0) {
+        computeKeys(viewProj, axis, x, y, z, vertexCount);
+    }
+    lastPath = SortPath::Full;
+    if (visibleCount > 0) {
+        // Sort by depth (front to back for weighted blended transparency)
+        if (sameInput && refineAngle > 0.0f && angleBetweenDegrees(axis, prevAxis) <= refineAngle &&
+            (mapped ? refineVisible(vertexCount) : refineOrder(visibleCount))) {
+            lastPath = SortPath::Incremental;
+        } else {
+            order.resize(visibleCount);
+            if (chunked) {
+                sortClusters(order.data());
+            } else {
+                radixSort(0, visibleCount, order.data());
+            }
+        }
+        if (mapped) {
+            const uint32_t blocks = blockCount(visibleCount);
+            forEachBlock(blocks, [&](uint32_t b) {
+                uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(visibleCount) * b / blocks);
+                uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(visibleCount) * (b + 1) / blocks);
+                for (uint32_t i = begin; i < end; i++) {
+                    order[i] = visible[order[i]];
+                }
+            });
+        }
+    }
+    order.resize(visibleCount);
+
+    hasPrevious = true;
+    prevAxis = axis;
+    prevX = x;
+    prevCount = vertexCount;
+    prevKeyBits = keyBits;
+    prevCulling = culling;
+    prevChunked = chunked;
+    prevViewProj = viewProj;
+    return true;
+}
+
+uint32_t SplatSortContext::blockCount(uint32_t vertexCount) const {
+    uint32_t threads = threadPool ? threadPool->size() : 1;
+    return std::clamp(vertexCount / kMinBlockSize, 1u, threads);
+}
+
+void SplatSortContext::forEachBlock(uint32_t blocks, const std::function<void(uint32_t)>& fn) {
+    if (threadPool && blocks > 1) {
+        threadPool->run(blocks, fn);
+    } else {
+        for (uint32_t b = 0; b < blocks; b++) fn(b);
+    }
+}
+
+void SplatSortContext::computeKeys(const glm::mat4& viewProj, const DepthAxis& axis, const float* x,
+                                   const float* y, const float* z, uint32_t vertexCount) {
+    keys.resize(vertexCount);
+    if (culling) {
+        cullKeys(viewProj, axis, x, y, z, vertexCount);
+        return;
+    }
+    visibleCount = vertexCount;
+
+    const uint32_t blocks = blockCount(vertexCount);
+    auto blockBegin = [&](uint32_t b) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(vertexCount) * b / blocks);
+    };
+
+    if (keyBits == SortKeyBits::Bits32) {
+        forEachBlock(blocks, [&](uint32_t b) {
+            uint32_t begin = blockBegin(b);
+            computeDepthKeys32(simdLevel, axis, x + begin, y + begin, z + begin,
+                               blockBegin(b + 1) - begin, keys.data() + begin);
+        });
+        return;
+    }
+
+    // 16-bit keys quantize over this frame's depth range
+    depths.resize(vertexCount);
+    blockMin.assign(blocks, FLT_MAX);
+    blockMax.assign(blocks, -FLT_MAX);
+
+    forEachBlock(blocks, [&](uint32_t b) {
+        uint32_t begin = blockBegin(b);
+        computeDepths(simdLevel, axis, x + begin, y + begin, z + begin,
+                      blockBegin(b + 1) - begin, depths.data() + begin, blockMin[b], blockMax[b]);
+    });
+
+    float minDepth = *std::min_element(blockMin.begin(), blockMin.end());
+    float maxDepth = *std::max_element(blockMax.begin(), blockMax.end());
+    float range = maxDepth - minDepth;
+    float scale = range > 0.0f ? 65535.0f / range : 0.0f;
+
+    forEachBlock(blocks, [&](uint32_t b) {
+        uint32_t begin = blockBegin(b);
+        quantizeDepths16(simdLevel, depths.data() + begin, blockBegin(b + 1) - begin,
+                         minDepth, scale, keys.data() + begin);
+    });
+}
+
+void SplatSortContext::cullKeys(const glm::mat4& viewProj, const DepthAxis& axis, const float* x,
+                                const float* y, const float* z, uint32_t vertexCount) {
+    const ClipRows clip = clipRowsFromViewProj(viewProj);
+    const bool bits32 = keyBits == SortKeyBits::Bits32;
+    visible.resize(vertexCount);
+    if (!bits32) {
+        depths.resize(vertexCount);
     }
+
+    // Each block packs its visible splats at its own start, then the blocks
+    // are moved together in order, so the result is the same for any split
+    uint32_t blocks = blockCount(vertexCount);
+    auto blockBegin = [&](uint32_t b) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(vertexCount) * b / blocks);
+    };
+    blockVisible.assign(blocks, 0);
+    blockMin.assign(blocks, FLT_MAX);
+    blockMax.assign(blocks, -FLT_MAX);
+
+    forEachBlock(blocks, [&](uint32_t b) {
+        uint32_t begin = blockBegin(b);
+        uint32_t count = blockBegin(b + 1) - begin;
+        if (bits32) {
+            blockVisible[b] = cullDepthKeys32(simdLevel, clip, axis, x + begin, y + begin, z + begin, count, begin,
+                                              keys.data() + begin, visible.data() + begin);
+        } else {
+            blockVisible[b] = cullDepths(simdLevel, clip, axis, x + begin, y + begin, z + begin, count, begin,
+                                         depths.data() + begin, visible.data() + begin, blockMin[b], blockMax[b]);
+        }
+    });
+
+    visibleCount = 0;
+    for (uint32_t b = 0; b < blocks; b++) {
+        uint32_t begin = blockBegin(b);
+        if (begin != visibleCount) {
+            std::memmove(visible.data() + visibleCount, visible.data() + begin, blockVisible[b] * sizeof(uint32_t));
+            if (bits32) {
+                std::memmove(keys.data() + visibleCount, keys.data() + begin, blockVisible[b] * sizeof(uint32_t));
+            } else {
+                std::memmove(depths.data() + visibleCount, depths.data() + begin, blockVisible[b] * sizeof(float));
+            }
+        }
+        visibleCount += blockVisible[b];
+    }
+    if (bits32 || visibleCount == 0) return;
+
+    // 16-bit keys quantize over the visible depth range only
+    float minDepth = *std::min_element(blockMin.begin(), blockMin.end());
+    float maxDepth = *std::max_element(blockMax.begin(), blockMax.end());
+    float range = maxDepth - minDepth;
+    float scale = range > 0.0f ? 65535.0f / range : 0.0f;
+
+    blocks = blockCount(visibleCount);
+    forEachBlock(blocks, [&](uint32_t b) {
+        uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(visibleCount) * b / blocks);
+        uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(visibleCount) * (b + 1) / blocks);
+        quantizeDepths16(simdLevel, depths.data() + begin, end - begin, minDepth, scale, keys.data() + begin);
+    });
+}
+
+void SplatSortContext::chunkKeys(const glm::mat4& viewProj, const DepthAxis& axis, const float* x,
+                                 const float* y, const float* z, uint32_t vertexCount) {
+    const ClipRows clip = clipRowsFromViewProj(viewProj);
+    const std::vector<ChunkBounds>& bounds = chunks->getBounds();
+    const uint32_t chunkCount = static_cast<uint32_t>(bounds.size());
+    keysScratch.resize(vertexCount);
+    visibleScratch.resize(vertexCount);
+    chunkVisible.resize(chunkCount);
+    chunkMin.resize(chunkCount);
+    chunkMax.resize(chunkCount);
+
+    // Each chunk keys its visible splats at its own start
+    const uint32_t blocks = blockCount(vertexCount);
+    forEachBlock(blocks, [&](uint32_t b) {
+        uint32_t firstChunk = static_cast<uint32_t>(static_cast<uint64_t>(chunkCount) * b / blocks);
+        uint32_t endChunk = static_cast<uint32_t>(static_cast<uint64_t>(chunkCount) * (b + 1) / blocks);
+        for (uint32_t c = firstChunk; c < endChunk; c++) {
+            const ChunkBounds& box = bounds[c];
+            const uint32_t begin = c * static_cast<uint32_t>(kSplatChunkSize);
+            const uint32_t count = std::min(static_cast<uint32_t>(kSplatChunkSize), vertexCount - begin);
+            uint32_t* chunkKeys = keysScratch.data() + begin;
+            uint32_t* chunkIndices = visibleScratch.data() + begin;
+            // A chunk with no finite center has inverted bounds
+            const bool bounded = box.min.x <= box.max.x && box.min.y <= box.max.y && box.min.z <= box.max.z;
+
+            BoxVisibility visibility = BoxVisibility::Inside;
+            if (culling) {
+                visibility = bounded ? classifyBox(clip, box.min, box.max) : BoxVisibility::Partial;
+            }
+            if (visibility == BoxVisibility::Outside) {
+                chunkVisible[c] = 0;
+            } else if (visibility == BoxVisibility::Inside) {
+                computeDepthKeys32(simdLevel, axis, x + begin, y + begin, z + begin, count, chunkKeys);
+                std::iota(chunkIndices, chunkIndices + count, begin);
+                chunkVisible[c] = count;
+            } else {
+                chunkVisible[c] = cullDepthKeys32(simdLevel, clip, axis, x + begin, y + begin, z + begin, count,
+                                                  begin, chunkKeys, chunkIndices);
+            }
+            if (bounded) {
+                boxDepthRange(axis, box.min, box.max, chunkMin[c], chunkMax[c]);
+            } else {
+                chunkMin[c] = -INFINITY;
+                chunkMax[c] = INFINITY;
+            }
+        }
+    });
+
+    // Near to far by each chunk's nearest depth, then a sweep merges chunks
+    // whose ranges overlap into clusters. Inside a cluster chunks go back to
+    // index order, so equal keys tie by splat index as in the unchunked sort.
+    liveChunks.clear();
+    for (uint32_t c = 0; c < chunkCount; c++) {
+        if (chunkVisible[c] > 0) liveChunks.push_back(c);
+    }
+    std::sort(liveChunks.begin(), liveChunks.end(), [&](uint32_t a, uint32_t b) {
+        return chunkMin[a] < chunkMin[b] || (chunkMin[a] == chunkMin[b] && a < b);
+    });
+    for (size_t i = 0; i < liveChunks.size();) {
+        size_t end = i + 1;
+        float clusterMax = chunkMax[liveChunks[i]];
+        while (end < liveChunks.size() && chunkMin[liveChunks[end]] <= clusterMax) {
+            clusterMax = std::max(clusterMax, chunkMax[liveChunks[end]]);
+            end++;
+        }
+        std::sort(liveChunks.begin() + i, liveChunks.begin() + end);
+        uint32_t count = 0;
+        for (size_t k = i; k < end; k++) {
+            count += chunkVisible[liveChunks[k]];
+        }
+        clusters.emplace_back(visibleCount, count);
+        visibleCount += count;
+        i = end;
+    }
+
+    // Move the chunks' keys together in cluster order; blockVisible holds
+    // where each block of live chunks starts
+    keys.resize(vertexCount);
+    visible.resize(vertexCount);
+    const uint32_t live = static_cast<uint32_t>(liveChunks.size());
+    const uint32_t gatherBlocks = std::min(blockCount(visibleCount), std::max(live, 1u));
+    auto firstLive = [&](uint32_t b) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(live) * b / gatherBlocks);
+    };
+    blockVisible.assign(gatherBlocks, 0);
+    for (uint32_t b = 1; b < gatherBlocks; b++) {
+        blockVisible[b] = blockVisible[b - 1];
+        for (uint32_t k = firstLive(b - 1); k < firstLive(b); k++) {
+            blockVisible[b] += chunkVisible[liveChunks[k]];
+        }
+    }
+    forEachBlock(gatherBlocks, [&](uint32_t b) {
+        uint32_t offset = blockVisible[b];
+        for (uint32_t k = firstLive(b), end = firstLive(b + 1); k < end; k++) {
+            uint32_t begin = liveChunks[k] * static_cast<uint32_t>(kSplatChunkSize);
+            uint32_t count = chunkVisible[liveChunks[k]];
+            std::memcpy(keys.data() + offset, keysScratch.data() + begin, count * sizeof(uint32_t));
+            std::memcpy(visible.data() + offset, visibleScratch.data() + begin, count * sizeof(uint32_t));
+            offset += count;
+        }
+    });
+}
+
+void SplatSortContext::sortClusters(uint32_t* out) {
+    keysScratch.resize(visibleCount);
+    indexScratch.resize(visibleCount);
+
+    // Large clusters use every thread in turn; the rest are shared out whole,
+    // each sorted on one thread in its own part of the scratch buffers
+    for (const auto& cluster : clusters) {
+        if (cluster.second >= kMinBlockSize) {
+            radixSort(cluster.first, cluster.second, out + cluster.first);
+        }
+    }
+    const uint32_t blocks = blockCount(visibleCount);
+    const uint32_t clusterCount = static_cast<uint32_t>(clusters.size());
+    forEachBlock(blocks, [&](uint32_t b) {
+        // Clusters starting in this block's share of the keys
+        uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(visibleCount) * b / blocks);
+        uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(visibleCount) * (b + 1) / blocks);
+        auto firstAt = [&](uint32_t position) {
+            return static_cast<uint32_t>(std::lower_bound(clusters.begin(), clusters.end(), position,
+                [](const std::pair<uint32_t, uint32_t>& c, uint32_t p) { return c.first < p; }) - clusters.begin());
+        };
+        for (uint32_t c = firstAt(begin), last = b + 1 == blocks ? clusterCount : firstAt(end); c < last; c++) {
+            uint32_t first = clusters[c].first, count = clusters[c].second;
+            if (count >= kMinBlockSize) continue;
+            sortCluster(keys.data() + first, keysScratch.data() + first, indexScratch.data() + first, first, count,
+                        out + first);
+        }
+    });
+}
+
+bool SplatSortContext::refineOrder(uint32_t vertexCount) {
+    const uint32_t blocks = blockCount(vertexCount);
+    auto blockBegin = [&](uint32_t b) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(vertexCount) * b / blocks);
+    };
+
+    // Estimate inversions per splat from a sparse probe, so that orders which
+    // moved too far go straight to the radix sort without a wasted attempt
+    if (vertexCount > kProbeWindow) {
+        uint32_t samples = std::min(kProbeSamples, vertexCount - kProbeWindow);
+        uint64_t inversions = 0;
+        for (uint32_t s = 0; s < samples; s++) {
+            uint32_t k = static_cast<uint32_t>(static_cast<uint64_t>(vertexCount - kProbeWindow) * s / samples);
+            uint32_t key = keys[order[k]];
+            for (uint32_t j = 1; j <= kProbeWindow; j++) {
+                inversions += keys[order[k + j]] < key;
+            }
+        }
+        if (inversions > samples * kRefineMovesPerSplat) return false;
+    }
+
+    // Keys in the previous order, then refine each block in parallel. Inversions
+    // left across block boundaries are fixed by one final sequential sweep.
+    // Insertion sort is stable, so the result does not depend on the block split.
+    keysScratch.resize(vertexCount);
+    blockOk.assign(blocks, 0);
+
+    forEachBlock(blocks, [&](uint32_t b) {
+        uint32_t begin = blockBegin(b);
+        uint32_t end = blockBegin(b + 1);
+        for (uint32_t i = begin; i < end; i++) {
+            keysScratch[i] = keys[order[i]];
+        }
+        uint64_t budget = (end - begin) * kRefineMovesPerSplat;
+        blockOk[b] = insertionSortBounded(keysScratch.data() + begin, order.data() + begin, end - begin, budget);
+    });
+
+    for (uint8_t ok : blockOk) {
+        if (!ok) return false;
+    }
+
+    return insertionSortBounded(keysScratch.data(), order.data(), vertexCount,
+                                vertexCount * kRefineMovesPerSplat);
+}
+
+bool SplatSortContext::refineVisible(uint32_t vertexCount) {
+    // Where each splat is among the visible ones this frame
+    slots.assign(vertexCount, kNotVisible);
+    uint32_t blocks = blockCount(visibleCount);
+    forEachBlock(blocks, [&](uint32_t b) {
+        uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(visibleCount) * b / blocks);
+        uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(visibleCount) * (b + 1) / blocks);
+        for (uint32_t p = begin; p < end; p++) {
+            slots[visible[p]] = p;
+        }
+    });
+
+    // The previous order as positions, keeping the splats still visible. Each
+    // block packs its own at its start and clears their slots, so the slots
+    // left afterwards are the splats that came into view.
+    const uint32_t prevVisible = static_cast<uint32_t>(order.size());
+    blocks = blockCount(prevVisible);
+    auto blockBegin = [&](uint32_t b) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(prevVisible) * b / blocks);
+    };
+    blockVisible.assign(blocks, 0);
+    forEachBlock(blocks, [&](uint32_t b) {
+        uint32_t kept = blockBegin(b);
+        for (uint32_t i = blockBegin(b), end = blockBegin(b + 1); i < end; i++) {
+            uint32_t& slot = slots[order[i]];
+            if (slot == kNotVisible) continue;
+            order[kept++] = slot;
+            slot = kNotVisible;
+        }
+        blockVisible[b] = kept - blockBegin(b);
+    });
+    uint32_t kept = 0;
+    for (uint32_t b = 0; b < blocks; b++) {
+        if (blockBegin(b) != kept) {
+            std::memmove(order.data() + kept, order.data() + blockBegin(b), blockVisible[b] * sizeof(uint32_t));
+        }
+        kept += blockVisible[b];
+    }
+
+    if (static_cast<uint64_t>(visibleCount - kept) * kMaxEnteringShare > visibleCount) return false;
+    order.resize(kept);
+    if (kept > 0 && !refineOrder(kept)) return false;
+    if (kept == visibleCount) return true;
+
+    entering.clear();
+    for (uint32_t p = 0; p < visibleCount; p++) {
+        if (slots[visible[p]] != kNotVisible) entering.push_back(p);
+    }
+    auto nearer = [&](uint32_t a, uint32_t b) { return keys[a] < keys[b] || (keys[a] == keys[b] && a < b); };
+    std::sort(entering.begin(), entering.end(), nearer);
+    order.resize(visibleCount);
+    std::copy(entering.begin(), entering.end(), order.begin() + kept);
+    std::inplace_merge(order.begin(), order.begin() + kept, order.end(),
+                       [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+    return true;
+}
+
+void SplatSortContext::radixSort(uint32_t first, uint32_t vertexCount, uint32_t* out) {
+    const RadixPass* passes = keyBits == SortKeyBits::Bits16 ? kPasses16 : kPasses32;
+    const uint32_t passCount = keyBits == SortKeyBits::Bits16
+        ? static_cast<uint32_t>(std::size(kPasses16))
+        : static_cast<uint32_t>(std::size(kPasses32));
+
+    const uint32_t blocks = blockCount(vertexCount);
+    auto blockBegin = [&](uint32_t b) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(vertexCount) * b / blocks);
+    };
+
+    keysScratch.resize(std::max<size_t>(keysScratch.size(), first + vertexCount));
+    indexScratch.resize(std::max<size_t>(indexScratch.size(), first + vertexCount));
+    uint32_t* const rangeKeys = keys.data() + first;
+    uint32_t* const rangeKeysScratch = keysScratch.data() + first;
+    uint32_t* const rangeIndexScratch = indexScratch.data() + first;
+
+    // The first pass reads the identity order. Index output alternates between
+    // out and indexScratch so an unskipped last pass lands directly in out.
+    const uint32_t* srcKeys = rangeKeys;
+    const uint32_t* srcIndex = nullptr;
+
+    for (uint32_t p = 0; p < passCount; p++) {
+        const uint32_t shift = passes[p].shift;
+        const uint32_t radixSize = 1u << passes[p].bits;
+        const uint32_t mask = radixSize - 1;
+        const bool last = (p + 1 == passCount);
+
+        histogram.assign(static_cast<size_t>(blocks) * radixSize, 0);
+
+        forEachBlock(blocks, [&](uint32_t b) {
+            uint32_t* counts = histogram.data() + static_cast<size_t>(b) * radixSize;
+            for (uint32_t i = blockBegin(b), end = blockBegin(b + 1); i < end; i++) {
+                counts[(srcKeys[i] >> shift) & mask]++;
+            }
+        });
+
+        // A pass where every key shares one digit leaves the order unchanged
+        uint32_t firstDigit = (srcKeys[0] >> shift) & mask;
+        uint32_t sameDigit = 0;
+        for (uint32_t b = 0; b < blocks; b++) {
+            sameDigit += histogram[static_cast<size_t>(b) * radixSize + firstDigit];
+        }
+        if (sameDigit == vertexCount) continue;
+
+        // Digit-major, block-minor offsets keep the scatter stable
+        uint32_t offset = 0;
+        for (uint32_t d = 0; d < radixSize; d++) {
+            for (uint32_t b = 0; b < blocks; b++) {
+                uint32_t& slot = histogram[static_cast<size_t>(b) * radixSize + d];
+                uint32_t count = slot;
+                slot = offset;
+                offset += count;
+            }
+        }
+
+        uint32_t* dstIndex = (srcIndex == out) ? rangeIndexScratch : out;
+        uint32_t* dstKeys = nullptr;
+        if (!last) {
+            dstKeys = (srcKeys == rangeKeys) ? rangeKeysScratch : rangeKeys;
+        }
+
+        forEachBlock(blocks, [&](uint32_t b) {
+            uint32_t* offsets = histogram.data() + static_cast<size_t>(b) * radixSize;
+            for (uint32_t i = blockBegin(b), end = blockBegin(b + 1); i < end; i++) {
+                uint32_t key = srcKeys[i];
+                uint32_t pos = offsets[(key >> shift) & mask]++;
+                dstIndex[pos] = srcIndex ? srcIndex[i] : first + i;
+                if (dstKeys) dstKeys[pos] = key;
+            }
+        });
+
+        if (dstKeys) srcKeys = dstKeys;
+        srcIndex = dstIndex;
+    }
+
+    // Skipped passes can leave the result in scratch, or untouched
+    if (srcIndex == nullptr) {
+        std::iota(out, out + vertexCount, first);
+    } else if (srcIndex != out) {
+        std::memcpy(out, srcIndex, vertexCount * sizeof(uint32_t));
+    }
+}
+
+void SplatSortContext::reportMemory(MemoryReport& report) const {
+    report.add("sort order", vectorBytes(order));
+    report.add("sort keys", vectorBytes(keys) + vectorBytes(keysScratch));
+    report.add("sort scratch", vectorBytes(indexScratch) + vectorBytes(depths) + vectorBytes(histogram) +
+                               vectorBytes(blockMin) + vectorBytes(blockMax) + vectorBytes(blockOk) +
+                               vectorBytes(blockVisible) + vectorBytes(visibleScratch) +
+                               vectorBytes(chunkVisible) + vectorBytes(chunkMin) + vectorBytes(chunkMax) +
+                               vectorBytes(liveChunks) + vectorBytes(clusters) + vectorBytes(slots) +
+                               vectorBytes(entering));
+    report.add("visible indices", vectorBytes(visible));
+}
+
+void SplatSort::sort(
+    const glm::mat4& viewProj,
+    const float* x,
+    const float* y,
+    const float* z,
+    uint32_t vertexCount,
+    std::vector<uint32_t>& depthIndex
+) {
+    SplatSortContext context(SortKeyBits::Bits32);
+    context.sort(viewProj, x, y, z, vertexCount, depthIndex);
 }
 
 } // namespace gsplat
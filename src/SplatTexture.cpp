@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "SplatTexture.h"
+#include "Utils.h"
+
+namespace gsplat {
+
+namespace {
+
+constexpr size_t kTexelBytes = 4 * sizeof(uint32_t);
+constexpr size_t kRowBytes = SplatTexture::kWidth * kTexelBytes;
+
+size_t rowsFor(size_t texels) {
+    return std::max<size_t>(1, (texels + SplatTexture::kWidth - 1) / SplatTexture::kWidth);
+}
+
+GLuint createTexture(int rows, int layers) {
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA32UI, SplatTexture::kWidth, rows, layers);
+    return tex;
+}
+
+// Texels an array of the device's most layers holds; the shaders index
+// texels with 32 bits
+size_t maxTexels() {
+    GLint layers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &layers);
+    size_t texels = static_cast<size_t>(std::max(layers, 1)) * SplatTexture::kLayerRows * SplatTexture::kWidth;
+    return std::min<size_t>(texels, size_t(1) << 32);
+}
+
+} // namespace
+
+size_t SplatTexture::maxSplats(const SplatLayout& layout) {
+    size_t texels = maxTexels();
+    // Splat indices are 32-bit too
+    size_t splats = std::min<size_t>(texels / (splatWords(layout.format) / 4), UINT32_MAX);
+    size_t shTexelsPerSplat = shTexels(layout.shDegree, layout.shFormat);
+    if (shTexelsPerSplat > 0) {
+        splats = std::min(splats, texels / shTexelsPerSplat);
+    }
+    return splats;
+}
+
+SplatTexture::SplatTexture()
+    : texture(0)
+    , chunkTexture(0)
+    , shTexture(0)
+    , pbos{0, 0, 0}
+    , nextPbo(0)
+    , capacity(0)
+{
+    glGenBuffers(kPboCount, pbos);
+}
+
+SplatTexture::~SplatTexture() {
+    glDeleteTextures(1, &texture);
+    glDeleteTextures(1, &chunkTexture);
+    glDeleteTextures(1, &shTexture);
+    glDeleteBuffers(kPboCount, pbos);
+}
+
+void SplatTexture::allocate(size_t splats, const SplatLayout& splatLayout) {
+    size_t limit = maxSplats(splatLayout);
+    if (splats > limit) {
+        throw std::runtime_error(std::to_string(splats) + " splats exceed this device's splat texture limit of " +
+                                 std::to_string(limit));
+    }
+    
+    // Immutable storage cannot be resized, so a new capacity needs a new texture
+    glDeleteTextures(1, &texture);
+    glDeleteTextures(1, &chunkTexture);
+    glDeleteTextures(1, &shTexture);
+    texture = 0;
+    chunkTexture = 0;
+    shTexture = 0;
+    
+    layout = splatLayout;
+    capacity = splats;
+    extent = extentFor(splats * splatWords(layout.format) / 4);
+    chunkExtent = Extent();
+    shExtent = Extent();
+    
+    glActiveTexture(GL_TEXTURE0);
+    texture = createTexture(extent.rows, extent.layers);
+    if (layout.format == SplatFormat::Compressed) {
+        size_t chunks = (splats + kSplatChunkSize - 1) / kSplatChunkSize;
+        chunkExtent = extentFor(chunks * kChunkWords / 4);
+        chunkTexture = createTexture(chunkExtent.rows, chunkExtent.layers);
+    }
+    size_t shTexelsPerSplat = shTexels(layout.shDegree, layout.shFormat);
+    if (shTexelsPerSplat > 0) {
+        shExtent = extentFor(splats * shTexelsPerSplat);
+        shTexture = createTexture(shExtent.rows, shExtent.layers);
+    }
+    checkGLError("Allocate splat texture");
+}
+
+SplatTexture::Extent SplatTexture::extentFor(size_t texels) {
+    size_t rows = rowsFor(texels);
+    Extent e;
+    e.rows = static_cast<int>(std::min<size_t>(rows, kLayerRows));
+    e.layers = static_cast<int>((rows + kLayerRows - 1) / kLayerRows);
+    return e;
+}
+
+void SplatTexture::uploadRect(const uint32_t* data, int x, int y, int layer, int width, int rows) {
+    size_t bytes = static_cast<size_t>(width) * rows * kTexelBytes;
+    
+    // Orphan the buffer so the driver never waits for a transfer still reading it
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dst) {
+        std::memcpy(dst, data, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, layer, width, rows, 1, GL_RGBA_INTEGER, GL_UNSIGNED_INT,
+                        nullptr);
+    } else {
+        // Mapping failed; fall back to a direct upload from client memory
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, layer, width, rows, 1, GL_RGBA_INTEGER, GL_UNSIGNED_INT, data);
+    }
+    nextPbo = (nextPbo + 1) % kPboCount;
+}
+
+size_t SplatTexture::uploadTexels(GLuint tex, const uint32_t* data, size_t first, size_t last, size_t maxBytes) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+    
+    const size_t maxRows = kChunkBytes / kRowBytes;
+    size_t sent = 0;
+    size_t i = first;
+    while (i < last && (maxBytes == 0 || sent < maxBytes)) {
+        size_t row = i / kWidth;
+        int col = static_cast<int>(i % kWidth);
+        int y = static_cast<int>(row % kLayerRows);
+        int layer = static_cast<int>(row / kLayerRows);
+        size_t count;
+        if (col == 0 && last - i >= kWidth) {
+            // As many whole rows as fit in one chunk and the layer
+            size_t rows = std::min({(last - i) / kWidth, maxRows, static_cast<size_t>(kLayerRows - y)});
+            uploadRect(data + i * 4, 0, y, layer, kWidth, static_cast<int>(rows));
+            count = rows * kWidth;
+        } else {
+            // Partial row
+            count = std::min(last, (row + 1) * kWidth) - i;
+            uploadRect(data + i * 4, col, y, layer, static_cast<int>(count), 1);
+        }
+        sent += count * kTexelBytes;
+        i += count;
+    }
+    return i;
+}
+
+size_t SplatTexture::upload(const GaussianData& data, size_t first, size_t last, size_t maxBytes) {
+    last = std::min(last, capacity);
+    if (first >= last) return 0;
+    
+    // Texel ranges always cover whole splats: a row holds a whole number of them
+    size_t texelsPerSplat = splatWords(layout.format) / 4;
+    size_t shTexelsPerSplat = shTexels(layout.shDegree, layout.shFormat);
+    if (maxBytes > 0 && shTexelsPerSplat > 0) {
+        // The harmonics of the splats sent come on top, so leave room for them
+        maxBytes = std::max<size_t>(1, maxBytes * texelsPerSplat / (texelsPerSplat + shTexelsPerSplat));
+    }
+    glActiveTexture(GL_TEXTURE0);
+    size_t end = uploadTexels(texture, data.packedData.data(), first * texelsPerSplat,
+                              last * texelsPerSplat, maxBytes) / texelsPerSplat;
+    
+    if (chunkTexture) {
+        // Chunks overlapping the splats just sent; re-sending a chunk is harmless
+        size_t firstChunk = first / kSplatChunkSize;
+        size_t lastChunk = (end + kSplatChunkSize - 1) / kSplatChunkSize;
+        const size_t texelsPerChunk = kChunkWords / 4;
+        uploadTexels(chunkTexture, data.chunkData.data(), firstChunk * texelsPerChunk,
+                     lastChunk * texelsPerChunk, 0);
+    }
+    if (shTexture) {
+        uploadTexels(shTexture, data.shData.data(), first * shTexelsPerSplat, end * shTexelsPerSplat, 0);
+    }
+    
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    checkGLError("Upload splat texture");
+    return end - first;
+}
+
+void SplatTexture::update(const GaussianData& data, size_t first, size_t last) {
+    last = std::min(last, capacity);
+    if (first >= last) return;
+    
+    size_t texelsPerSplat = splatWords(layout.format) / 4;
+    glActiveTexture(GL_TEXTURE0);
+    uploadTexels(texture, data.packedData.data(), first * texelsPerSplat, last * texelsPerSplat, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    checkGLError("Update splat texture");
+}
+
+std::string SplatTexture::describe() const {
+    return std::to_string(extent.layers) + (extent.layers == 1 ? " layer" : " layers") + " of " +
+           std::to_string(kWidth) + " x " + std::to_string(extent.rows) + " RGBA32UI texels, up to " +
+           std::to_string(maxTexels() / (static_cast<size_t>(kWidth) * kLayerRows)) + " layers (" +
+           std::to_string(maxSplats(layout)) + " splats in this layout)";
+}
+
+size_t SplatTexture::textureBytes() const {
+    return static_cast<size_t>(extent.rows) * extent.layers * kRowBytes +
+           static_cast<size_t>(chunkExtent.rows) * chunkExtent.layers * kRowBytes;
+}
+
+size_t SplatTexture::shTextureBytes() const {
+    return static_cast<size_t>(shExtent.rows) * shExtent.layers * kRowBytes;
+}
+
+size_t SplatTexture::stagingBytes() const {
+    GLint size = 0;
+    size_t total = 0;
+    for (GLuint pbo : pbos) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        glGetBufferParameteriv(GL_PIXEL_UNPACK_BUFFER, GL_BUFFER_SIZE, &size);
+        total += static_cast<size_t>(size);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return total;
+}
+
+} // namespace gsplat
@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "StreamingLoader.h"
+#include "PLYLoader.h"
+
+namespace gsplat {
+
+namespace {
+
+enum class PropertyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+struct PlyProperty {
+    std::string name;
+    PropertyType type;
+    size_t offset;
+};
+
+struct PlyHeader {
+    bool binaryLittleEndian = false;
+    bool vertexFirst = false;
+    bool vertexHasList = false;
+    size_t vertexCount = 0;
+    size_t vertexStride = 0;
+    std::vector<PlyProperty> vertexProperties;
+};
+
+bool parsePropertyType(const std::string& name, PropertyType& type, size_t& size) {
+    if (name == "char" || name == "int8") { type = PropertyType::Int8; size = 1; }
+    else if (name == "uchar" || name == "uint8") { type = PropertyType::UInt8; size = 1; }
+    else if (name == "short" || name == "int16") { type = PropertyType::Int16; size = 2; }
+    else if (name == "ushort" || name == "uint16") { type = PropertyType::UInt16; size = 2; }
+    else if (name == "int" || name == "int32") { type = PropertyType::Int32; size = 4; }
+    else if (name == "uint" || name == "uint32") { type = PropertyType::UInt32; size = 4; }
+    else if (name == "float" || name == "float32") { type = PropertyType::Float32; size = 4; }
+    else if (name == "double" || name == "float64") { type = PropertyType::Float64; size = 8; }
+    else return false;
+    return true;
+}
+
+// Reads the header up to and including end_header, leaving the stream at the data
+bool parseHeader(std::istream& in, PlyHeader& header) {
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, 3, "ply") != 0) return false;
+    
+    std::string currentElement;
+    bool sawElement = false;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        std::istringstream words(line);
+        std::string keyword;
+        words >> keyword;
+        
+        if (keyword == "format") {
+            std::string format;
+            words >> format;
+            header.binaryLittleEndian = format == "binary_little_endian";
+        } else if (keyword == "element") {
+            size_t count = 0;
+            words >> currentElement >> count;
+            if (currentElement == "vertex") {
+                header.vertexFirst = !sawElement;
+                header.vertexCount = count;
+            }
+            sawElement = true;
+        } else if (keyword == "property" && currentElement == "vertex") {
+            std::string typeName, name;
+            words >> typeName;
+            if (typeName == "list") {
+                header.vertexHasList = true;
+                continue;
+            }
+            words >> name;
+            PlyProperty property;
+            size_t size = 0;
+            if (!parsePropertyType(typeName, property.type, size)) return false;
+            property.name = name;
+            property.offset = header.vertexStride;
+            header.vertexStride += size;
+            header.vertexProperties.push_back(property);
+        } else if (keyword == "end_header") {
+            return true;
+        }
+    }
+    return false;
+}
+
+float readProperty(const unsigned char* record, const PlyProperty& property) {
+    const unsigned char* p = record + property.offset;
+    switch (property.type) {
+        case PropertyType::Int8: { int8_t v; std::memcpy(&v, p, 1); return v; }
+        case PropertyType::UInt8: return *p;
+        case PropertyType::Int16: { int16_t v; std::memcpy(&v, p, 2); return v; }
+        case PropertyType::UInt16: { uint16_t v; std::memcpy(&v, p, 2); return v; }
+        case PropertyType::Int32: { int32_t v; std::memcpy(&v, p, 4); return static_cast<float>(v); }
+        case PropertyType::UInt32: { uint32_t v; std::memcpy(&v, p, 4); return static_cast<float>(v); }
+        case PropertyType::Float32: { float v; std::memcpy(&v, p, 4); return v; }
+        case PropertyType::Float64: { double v; std::memcpy(&v, p, 8); return static_cast<float>(v); }
+    }
+    return 0.0f;
+}
+
+// First property found among the alternative names, or nullptr
+const PlyProperty* findProperty(const PlyHeader& header, std::initializer_list<const char*> names) {
+    for (const char* name : names) {
+        for (const PlyProperty& property : header.vertexProperties) {
+            if (property.name == name) return &property;
+        }
+    }
+    return nullptr;
+}
+
+bool isLittleEndianHost() {
+    uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+} // namespace
+
+StreamingLoader::StreamingLoader(const std::string& path, size_t chunkSplats, const SplatLayout& layout)
+    : path(path)
+    , chunkSplats(std::max<size_t>(chunkSplats, 1))
+    , layout(layout)
+    , startTime(std::chrono::steady_clock::now())
+    , finished(false)
+    , stopping(false)
+    , loadedSplats(0)
+    , totalSplats(0)
+    , bytesRead(0)
+    , totalBytes(0)
+    , finishSeconds(0.0)
+{
+    this->chunkSplats = (this->chunkSplats + kSplatChunkSize - 1) / kSplatChunkSize * kSplatChunkSize;
+    thread = std::thread(&StreamingLoader::run, this);
+}
+
+StreamingLoader::~StreamingLoader() {
+    stopping = true;
+    thread.join();
+}
+
+bool StreamingLoader::poll(GaussianData& chunk, bool wait) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (wait) {
+        chunkCv.wait(lock, [this] { return !chunks.empty() || finished; });
+    }
+    if (!chunks.empty()) {
+        chunk = std::move(chunks.front());
+        chunks.pop_front();
+        return true;
+    }
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+    return false;
+}
+
+bool StreamingLoader::isDone() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return finished && chunks.empty();
+}
+
+LoadProgress StreamingLoader::getProgress() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    LoadProgress progress;
+    progress.loadedSplats = loadedSplats;
+    progress.totalSplats = totalSplats;
+    progress.bytesRead = bytesRead;
+    progress.totalBytes = totalBytes;
+    progress.done = finished;
+    progress.seconds = finished ? finishSeconds
+        : std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return progress;
+}
+
+void StreamingLoader::publish(GaussianData&& chunk, uint64_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        loadedSplats += chunk.count();
+        bytesRead += bytes;
+        chunks.push_back(std::move(chunk));
+    }
+    chunkCv.notify_all();
+}
+
+void StreamingLoader::run() {
+    try {
+        if (!streamBinary() && !stopping) {
+            // Not a layout we stream: load it in one go
+            GaussianData data = PLYLoader::load(path, nullptr, false, layout, true);
+            uint64_t bytes;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                totalSplats = data.count();
+                bytes = totalBytes;
+            }
+            publish(std::move(data), bytes);
+        }
+    } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = e.what();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+        finishSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
+    chunkCv.notify_all();
+}
+
+bool StreamingLoader::streamBinary() {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        throw std::runtime_error("Failed to open PLY file: " + path);
+    }
+    uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        totalBytes = fileSize;
+    }
+    
+    PlyHeader header;
+    if (!parseHeader(in, header) || !header.binaryLittleEndian || !header.vertexFirst ||
+        header.vertexHasList || !isLittleEndianHost()) {
+        return false;
+    }
+    
+    const PlyProperty* x = findProperty(header, {"x"});
+    const PlyProperty* y = findProperty(header, {"y"});
+    const PlyProperty* z = findProperty(header, {"z"});
+    const PlyProperty* scale[3] = {
+        findProperty(header, {"scale_0", "scaling_0"}),
+        findProperty(header, {"scale_1", "scaling_1"}),
+        findProperty(header, {"scale_2", "scaling_2"})
+    };
+    const PlyProperty* rot[4] = {
+        findProperty(header, {"rot_0", "rotation_0"}),
+        findProperty(header, {"rot_1", "rotation_1"}),
+        findProperty(header, {"rot_2", "rotation_2"}),
+        findProperty(header, {"rot_3", "rotation_3"})
+    };
+    const PlyProperty* sh[3] = {
+        findProperty(header, {"f_dc_0"}), findProperty(header, {"f_dc_1"}), findProperty(header, {"f_dc_2"})
+    };
+    const PlyProperty* rgb[3] = {
+        findProperty(header, {"red"}), findProperty(header, {"green"}), findProperty(header, {"blue"})
+    };
+    const PlyProperty* opacity = findProperty(header, {"opacity"});
+    std::vector<const PlyProperty*> rest;
+    for (;;) {
+        std::string name = "f_rest_" + std::to_string(rest.size());
+        const PlyProperty* property = findProperty(header, {name.c_str()});
+        if (!property) break;
+        rest.push_back(property);
+    }
+    
+    // Missing required attributes: let PLYLoader report them
+    if (!x || !y || !z || !scale[0] || !scale[1] || !scale[2] ||
+        !rot[0] || !rot[1] || !rot[2] || !rot[3]) {
+        return false;
+    }
+    
+    PLYVertex v = {};
+    v.hasSH = sh[0] && sh[1] && sh[2];
+    v.hasRGB = !v.hasSH && rgb[0] && rgb[1] && rgb[2];
+    v.hasOpacity = opacity != nullptr;
+    const PlyProperty* const* color = v.hasSH ? sh : rgb;
+    int shDegree = v.hasSH ? std::min(layout.shDegree, PLYLoader::shDegreeFor(rest.size())) : 0;
+    size_t restPerChannel = rest.size() / 3;
+    size_t keptCoefficients = shCoefficients(shDegree);
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        totalSplats = header.vertexCount;
+        bytesRead = static_cast<uint64_t>(in.tellg());
+    }
+    
+    std::vector<unsigned char> buffer(chunkSplats * header.vertexStride);
+    size_t remaining = header.vertexCount;
+    while (remaining > 0 && !stopping) {
+        size_t n = std::min(remaining, chunkSplats);
+        size_t bytes = n * header.vertexStride;
+        in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(bytes));
+        if (static_cast<size_t>(in.gcount()) != bytes) {
+            throw std::runtime_error("Unexpected end of PLY file: " + path);
+        }
+        
+        GaussianData chunk;
+        chunk.format = layout.format;
+        chunk.shDegree = shDegree;
+        chunk.shFormat = layout.shFormat;
+        chunk.positions.resize(n);
+        chunk.scales.resize(n);
+        chunk.rotations.resize(n);
+        chunk.colors.resize(n);
+        chunk.shRest.resize(n * 3 * keptCoefficients);
+        for (size_t i = 0; i < n; i++) {
+            const unsigned char* record = buffer.data() + i * header.vertexStride;
+            v.x = readProperty(record, *x);
+            v.y = readProperty(record, *y);
+            v.z = readProperty(record, *z);
+            for (int k = 0; k < 3; k++) v.scale[k] = readProperty(record, *scale[k]);
+            for (int k = 0; k < 4; k++) v.rot[k] = readProperty(record, *rot[k]);
+            if (v.hasSH || v.hasRGB) {
+                for (int k = 0; k < 3; k++) v.color[k] = readProperty(record, *color[k]);
+            }
+            if (v.hasOpacity) v.opacity = readProperty(record, *opacity);
+            for (size_t c = 0; c < 3; c++) {
+                for (size_t k = 0; k < keptCoefficients; k++) {
+                    v.shRest[c][k] = readProperty(record, *rest[c * restPerChannel + k]);
+                }
+            }
+            PLYLoader::convertVertex(v, chunk, i);
+        }
+        chunk.sortSpatially();
+        chunk.pack();
+        
+        chunk.releaseSource();
+        
+        publish(std::move(chunk), bytes);
+        remaining -= n;
+    }
+    return true;
+}
+
+} // namespace gsplat
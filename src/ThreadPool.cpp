@@ -0,0 +1,85 @@
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+namespace gsplat {
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : current(nullptr)
+    , taskCount(0)
+    , nextTask(0)
+    , pending(0)
+    , generation(0)
+    , stopping(false)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 1; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(uint32_t count, const std::function<void(uint32_t)>& task) {
+    if (workers.empty() || count <= 1) {
+        for (uint32_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(runMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = &task;
+        taskCount = count;
+        nextTask.store(0);
+        pending = static_cast<unsigned>(workers.size());
+        generation++;
+    }
+    startCv.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCv.wait(lock, [this] { return pending == 0; });
+    current = nullptr;
+}
+
+void ThreadPool::drain() {
+    uint32_t i;
+    while ((i = nextTask.fetch_add(1)) < taskCount) {
+        (*current)(i);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        startCv.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+
+        lock.unlock();
+        drain();
+        lock.lock();
+
+        if (--pending == 0) {
+            doneCv.notify_one();
+        }
+    }
+}
+
+} // namespace gsplat
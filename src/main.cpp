@@ -1,14 +1,26 @@
 #include <iostream>
 #include <chrono>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
 
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 
 #include "Renderer.h"
 #include "Camera.h"
-#include "PLYLoader.h"
+#include "LodTree.h"
+#include "PackKernels.h"
+#include "SceneComposition.h"
+#include "SceneFile.h"
+#include "SplatCache.h"
+#include "StreamingLoader.h"
 #include "OrbitControls.h"
 #include "AppContext.h"
+#include "ThreadPool.h"
+#include "Simd.h"
+#include "Utils.h"
 
 using namespace gsplat;
 
@@ -19,22 +31,271 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     }
 }
 
+// Selection edits; the brush itself is polled in the render loop
+void key_callback(GLFWwindow* window, int key, int, int action, int) {
+    auto ctx = static_cast<AppContext*>(glfwGetWindowUserPointer(window));
+    if (!ctx || !ctx->renderer || action != GLFW_PRESS) return;
+    Renderer& renderer = *ctx->renderer;
+    switch (key) {
+        case GLFW_KEY_DELETE:
+        case GLFW_KEY_BACKSPACE:
+            std::cout << "Deleted " << renderer.deleteSelected() << " splats" << std::endl;
+            break;
+        case GLFW_KEY_H:
+            std::cout << "Hid " << renderer.hideSelected() << " splats" << std::endl;
+            break;
+        case GLFW_KEY_U:
+            std::cout << "Unhid " << renderer.unhideAll() << " splats" << std::endl;
+            break;
+        case GLFW_KEY_I:
+            std::cout << renderer.invertSelection() << " splats selected" << std::endl;
+            break;
+        case GLFW_KEY_C:
+            renderer.clearSelection();
+            break;
+    }
+}
+
+struct Options {
+    std::string scenePath;
+    SortKeyBits sortKeyBits = SortKeyBits::Bits32;
+    bool asyncSort = false;
+    unsigned threads = 0;
+    SimdLevel simdLevel = detectSimdLevel();
+    float resortAngle = 2.0f;
+    SortBackend sortBackend = SortBackend::Cpu;
+    bool validateSort = false;
+    bool useCache = true;
+    bool streamLoad = true;
+    bool memoryReport = false;
+    size_t uploadBudgetMB = 64;
+    SplatLayout layout;
+    bool compressionError = false;
+    bool culling = true;
+    bool chunkedSort = true;
+    bool postProcess = true;
+    bool shaderCache = true;
+    bool lod = false;
+    float lodError = 1.0f;
+    size_t lodBudget = 0;
+    bool profile = false;
+    std::string tracePath;
+    bool glDebug = false;
+};
+
 void printUsage(const char* prog) {
-    std::cout << "Usage: " << prog << " <ply_file>\n";
+    std::cout << "Usage: " << prog << " [options] <scene_file>\n";
+    std::cout << "\nScene files: .ply, .splat, .ksplat or .spz (gzip-free), or a .json composition of several\n";
+    std::cout << "\nOptions:\n";
+    std::cout << "  --sort-bits <16|32>  Depth sort key width (default 32)\n";
+    std::cout << "  --async-sort         Sort on a background thread, drawing with the newest finished order\n";
+    std::cout << "  --threads <n>        Worker threads for CPU work, 0 = all hardware threads (default 0)\n";
+    std::cout << "  --simd <level>       CPU kernel level: auto, scalar, sse4, avx2, avx512 (default auto)\n";
+    std::cout << "  --resort-angle <deg> Rotation up to which the last order is refined, 0 = always full sort (default 2)\n";
+    std::cout << "  --sort-backend <b>   Where to sort: cpu, gpu (compute shaders, OpenGL 4.3) (default cpu)\n";
+    std::cout << "  --validate-sort      Check every GPU order against the CPU sort (slow)\n";
+    std::cout << "  --no-cache           Neither read nor write the <scene_file>.gsplatcache binary cache\n";
+    std::cout << "  --no-stream          Load the whole scene before the first frame instead of progressively (PLY only)\n";
+    std::cout << "  --memory-report      Print CPU and GPU memory per buffer once the scene is loaded\n";
+    std::cout << "  --upload-budget <mb> Splat data uploaded to the GPU per frame, 0 = no limit (default 64)\n";
+    std::cout << "  --compressed         Store splats in 16 quantized bytes instead of 32\n";
+    std::cout << "  --compression-error  Load with --compressed in one pass and print its error against the full format\n";
+    std::cout << "  --sh-degree <0-3>    Highest spherical harmonic degree loaded (default 3)\n";
+    std::cout << "  --sh-format <f>      Harmonic storage: half, or byte with a per-splat range (default half)\n";
+    std::cout << "  --no-cull            Sort and draw every splat instead of only those in the view frustum\n";
+    std::cout << "  --no-chunks          Cull and sort splat by splat instead of by spatial chunk first\n";
+    std::cout << "  --no-post            Draw splat colors as they are, without saturation, white point and sharpening\n";
+    std::cout << "  --no-shader-cache    Compile shaders on every start instead of caching the linked programs\n";
+    std::cout << "  --lod                Build a level-of-detail tree at load time and draw a cut through it\n";
+    std::cout << "  --lod-error <px>     Projected radius above which LOD nodes are refined (default 1)\n";
+    std::cout << "  --lod-budget <n>     Most splats a LOD cut may draw, 0 = no limit (default 0)\n";
+    std::cout << "  --profile            Time each render phase on the CPU and GPU; percentiles in the title and on exit\n";
+    std::cout << "  --trace <file>       With --profile, write every frame's timings on exit: .csv, else Chrome trace JSON\n";
+    std::cout << "  --gl-debug           Debug context, with GL errors reported through a debug-output callback\n";
     std::cout << "\nControls:\n";
     std::cout << "  Left Mouse:   Rotate camera\n";
     std::cout << "  Middle/Right: Pan camera\n";
     std::cout << "  Scroll:       Zoom in/out\n";
+    std::cout << "  0-3:          Spherical harmonic degree drawn\n";
+    std::cout << "  Shift+Left:   Brush splats into the selection (with Ctrl: out of it)\n";
+    std::cout << "  Delete/H/U:   Delete or hide the selection, unhide everything\n";
+    std::cout << "  I/C:          Invert or clear the selection\n";
     std::cout << "  ESC:          Quit\n";
 }
 
+bool parseArgs(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--sort-bits" && i + 1 < argc) {
+            std::string bits = argv[++i];
+            if (bits == "16") {
+                opts.sortKeyBits = SortKeyBits::Bits16;
+            } else if (bits == "32") {
+                opts.sortKeyBits = SortKeyBits::Bits32;
+            } else {
+                std::cerr << "--sort-bits must be 16 or 32" << std::endl;
+                return false;
+            }
+        } else if (arg == "--async-sort") {
+            opts.asyncSort = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            int threads = std::atoi(argv[++i]);
+            if (threads < 0) {
+                std::cerr << "--threads must not be negative" << std::endl;
+                return false;
+            }
+            opts.threads = static_cast<unsigned>(threads);
+        } else if (arg == "--resort-angle" && i + 1 < argc) {
+            opts.resortAngle = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--sort-backend" && i + 1 < argc) {
+            std::string backend = argv[++i];
+            if (backend == "cpu") {
+                opts.sortBackend = SortBackend::Cpu;
+            } else if (backend == "gpu") {
+                opts.sortBackend = SortBackend::Gpu;
+            } else {
+                std::cerr << "--sort-backend must be cpu or gpu" << std::endl;
+                return false;
+            }
+        } else if (arg == "--validate-sort") {
+            opts.validateSort = true;
+        } else if (arg == "--no-cache") {
+            opts.useCache = false;
+        } else if (arg == "--no-stream") {
+            opts.streamLoad = false;
+        } else if (arg == "--memory-report") {
+            opts.memoryReport = true;
+        } else if (arg == "--upload-budget" && i + 1 < argc) {
+            int mb = std::atoi(argv[++i]);
+            if (mb < 0) {
+                std::cerr << "--upload-budget must not be negative" << std::endl;
+                return false;
+            }
+            opts.uploadBudgetMB = static_cast<size_t>(mb);
+        } else if (arg == "--compressed") {
+            opts.layout.format = SplatFormat::Compressed;
+        } else if (arg == "--compression-error") {
+            opts.layout.format = SplatFormat::Compressed;
+            opts.compressionError = true;
+        } else if (arg == "--sh-degree" && i + 1 < argc) {
+            int degree = std::atoi(argv[++i]);
+            if (degree < 0 || degree > kMaxShDegree) {
+                std::cerr << "--sh-degree must be 0 to " << kMaxShDegree << std::endl;
+                return false;
+            }
+            opts.layout.shDegree = degree;
+        } else if (arg == "--sh-format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format == "half") {
+                opts.layout.shFormat = ShFormat::Half;
+            } else if (format == "byte") {
+                opts.layout.shFormat = ShFormat::Byte;
+            } else {
+                std::cerr << "--sh-format must be half or byte" << std::endl;
+                return false;
+            }
+        } else if (arg == "--no-cull") {
+            opts.culling = false;
+        } else if (arg == "--no-chunks") {
+            opts.chunkedSort = false;
+        } else if (arg == "--no-post") {
+            opts.postProcess = false;
+        } else if (arg == "--no-shader-cache") {
+            opts.shaderCache = false;
+        } else if (arg == "--lod") {
+            opts.lod = true;
+        } else if (arg == "--lod-error" && i + 1 < argc) {
+            opts.lodError = static_cast<float>(std::atof(argv[++i]));
+            opts.lod = true;
+        } else if (arg == "--lod-budget" && i + 1 < argc) {
+            long long budget = std::atoll(argv[++i]);
+            if (budget < 0) {
+                std::cerr << "--lod-budget must not be negative" << std::endl;
+                return false;
+            }
+            opts.lodBudget = static_cast<size_t>(budget);
+            opts.lod = true;
+        } else if (arg == "--profile") {
+            opts.profile = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            opts.tracePath = argv[++i];
+            opts.profile = true;
+        } else if (arg == "--gl-debug") {
+            opts.glDebug = true;
+        } else if (arg == "--simd" && i + 1 < argc) {
+            if (!parseSimdLevel(argv[++i], opts.simdLevel)) {
+                std::cerr << "Unknown SIMD level: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (!arg.empty() && arg[0] != '-' && opts.scenePath.empty()) {
+            opts.scenePath = arg;
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return !opts.scenePath.empty();
+}
+
+void printCompressionError(const GaussianData& data) {
+    PackInput in = {data.positions.data(), data.scales.data(), data.rotations.data(), data.colors.data()};
+    CompressionError error = measureCompression(in, 0, data.count(), data.packedData.data(), data.chunkData.data());
+    std::cout << "Compressed format error against the full format:\n"
+              << "  position max     " << error.maxPosition << " (scene extent "
+              << glm::length(data.boundsMax - data.boundsMin) << ")\n"
+              << "  scale max        " << error.maxScale * 100.0f << "%\n"
+              << "  rotation max     " << error.maxRotationDeg << " deg\n"
+              << "  covariance rms   " << error.rmsCovariance * 100.0f << "%, max "
+              << error.maxCovariance * 100.0f << "%" << std::endl;
+}
+
+// The packed scene from its cache, or parsed and cached
+GaussianData loadScene(const std::string& path, const Options& opts, ThreadPool& threadPool) {
+    GaussianData data;
+    std::string cachePath = SplatCache::pathFor(path);
+    if (opts.useCache && SplatCache::load(cachePath, path, opts.layout, data)) {
+        std::cout << "Using cache " << cachePath << std::endl;
+    } else {
+        data = SceneFile::load(path, &threadPool, false, opts.layout, true);
+        if (opts.useCache && SplatCache::write(cachePath, path, opts.layout, data)) {
+            std::cout << "Wrote cache " << cachePath << std::endl;
+        }
+    }
+    return data;
+}
+
+// Grow [minPos, maxPos] by the box [boxMin, boxMax] placed with transform
+void addBounds(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::mat4& transform, glm::vec3& minPos,
+               glm::vec3& maxPos) {
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec3 p((corner & 1) ? boxMax.x : boxMin.x, (corner & 2) ? boxMax.y : boxMin.y,
+                    (corner & 4) ? boxMax.z : boxMin.z);
+        glm::vec3 world = glm::vec3(transform * glm::vec4(p, 1.0f));
+        minPos = glm::min(minPos, world);
+        maxPos = glm::max(maxPos, world);
+    }
+}
+
+// Aim the camera and controls at the center of [minPos, maxPos] from far
+// enough to see all of it
+void frameBounds(const glm::vec3& minPos, const glm::vec3& maxPos, Camera& camera, OrbitControls& controls) {
+    glm::vec3 center = (minPos + maxPos) * 0.5f;
+    glm::vec3 size = maxPos - minPos;
+    float maxDim = std::max(std::max(size.x, size.y), size.z);
+    float distance = std::max(maxDim * 2.0f, 1.0f);
+    camera.setPosition(center + glm::vec3(0.0f, 0.0f, distance));
+    camera.setTarget(center);
+    controls.frame(center, distance);
+}
+
 int main(int argc, char** argv) {
-    if (argc < 2) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
         printUsage(argv[0]);
         return 1;
     }
     
-    std::string plyPath = argv[1];
+    const std::string& scenePath = opts.scenePath;
     
     // Initialize GLFW
     if (!glfwInit()) {
@@ -43,11 +304,15 @@ int main(int argc, char** argv) {
     }
     
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+    // Compute shaders need 4.3; keep asking for 4.2 otherwise
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, opts.sortBackend == SortBackend::Gpu ? 3 : 2);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+    if (opts.glDebug) {
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+    }
     
     // Create window
     int width = 1280;
@@ -70,48 +335,155 @@ int main(int argc, char** argv) {
     
     std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
     std::cout << "GLSL Version: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << std::endl;
+    if (opts.glDebug && !enableGLDebugOutput()) {
+        std::cerr << "Warning: no debug output (needs OpenGL 4.3 or KHR_debug)" << std::endl;
+    }
+    
+    ThreadPool threadPool(opts.threads);
+    std::cout << "Using " << threadPool.size() << " worker threads, "
+              << simdLevelName(opts.simdLevel) << " kernels" << std::endl;
     
     try {
-        // Load PLY file
-        std::cout << "Loading " << plyPath << "..." << std::endl;
+        // Load the packed scene from the cache, or parse the scene file and cache it
+        std::cout << "Loading " << scenePath << "..." << std::endl;
         auto startLoad = std::chrono::high_resolution_clock::now();
         
-        GaussianData data = PLYLoader::load(plyPath);
+        std::vector<ScenePlacement> placements;
+        const bool composition = SceneComposition::isComposition(scenePath);
+        if (composition) {
+            placements = SceneComposition::load(scenePath);
+            if (placements.empty()) {
+                throw std::runtime_error(scenePath + ": no scenes");
+            }
+            if (opts.lod || opts.compressionError) {
+                throw std::runtime_error("--lod and --compression-error need a single scene, not a composition");
+            }
+        }
+        
+        GaussianData data;
+        LodTree lodTree;
+        std::unique_ptr<StreamingLoader> streamingLoader;
+        std::string cachePath = SplatCache::pathFor(scenePath);
+        // The tree is built from the source attributes, which neither the cache nor streaming keeps
+        bool wholeLoad = opts.compressionError || opts.lod;
+        if (composition) {
+            // Each scene goes straight into the renderer's store once it exists
+        } else if (opts.useCache && !wholeLoad && SplatCache::load(cachePath, scenePath, opts.layout, data)) {
+            std::cout << "Using cache " << cachePath << std::endl;
+        } else if (opts.streamLoad && !wholeLoad && SceneFile::detect(scenePath) == SceneFormat::Ply) {
+            // Start drawing as soon as the first chunk is in, framed by its bounds until all are in
+            streamingLoader = std::make_unique<StreamingLoader>(scenePath, StreamingLoader::kDefaultChunkSplats,
+                                                                 opts.layout);
+            streamingLoader->poll(data, true);
+        } else {
+            // The error report needs the source attributes, which are released otherwise.
+            // The LOD tree puts the splats in its own order.
+            data = SceneFile::load(scenePath, &threadPool, wholeLoad, opts.layout, !opts.lod);
+            if (opts.compressionError) {
+                printCompressionError(data);
+            }
+            if (opts.lod) {
+                auto startBuild = std::chrono::high_resolution_clock::now();
+                size_t sourceCount = data.count();
+                lodTree = LodTree::build(data, &threadPool);
+                auto buildTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::high_resolution_clock::now() - startBuild).count();
+                std::cout << "Built LOD tree: " << lodTree.nodeCount() - sourceCount << " merged splats over "
+                          << sourceCount << " in " << buildTime << "ms" << std::endl;
+            }
+            if (opts.useCache && !opts.lod && SplatCache::write(cachePath, scenePath, opts.layout, data)) {
+                std::cout << "Wrote cache " << cachePath << std::endl;
+            }
+        }
         
         auto endLoad = std::chrono::high_resolution_clock::now();
         auto loadTime = std::chrono::duration_cast<std::chrono::milliseconds>(endLoad - startLoad).count();
         
-        std::cout << "Loaded " << data.count() << " Gaussians in " << loadTime << "ms" << std::endl;
-        
-        // Calculate bounding box for camera positioning
-        glm::vec3 minPos(FLT_MAX), maxPos(-FLT_MAX);
-        for (auto position: data.positions) {
-            minPos = glm::min(minPos, position);
-            maxPos = glm::max(maxPos, position);
+        if (streamingLoader) {
+            std::cout << "First " << data.count() << " Gaussians ready in " << loadTime << "ms" << std::endl;
+        } else if (!composition) {
+            std::cout << "Loaded " << data.count() << " Gaussians in " << loadTime << "ms" << std::endl;
         }
-        glm::vec3 center = (minPos + maxPos) * 0.5f;
-        glm::vec3 size = maxPos - minPos;
-        float maxDim = std::max(std::max(size.x, size.y), size.z);
-        float distance = std::max(maxDim * 2.0f, 1.0f);
+        
+        // Use the bounding box for camera positioning
+        glm::vec3 minPos = data.boundsMin, maxPos = data.boundsMax;
 
-        Renderer renderer(width, height);
-        renderer.setGaussianData(data);
+        Renderer renderer(width, height, opts.shaderCache ? ProgramCache::defaultDirectory() : "");
+        renderer.setPostProcess(opts.postProcess);
+        renderer.setSortKeyBits(opts.sortKeyBits);
+        renderer.setThreadPool(&threadPool);
+        renderer.setSimdLevel(opts.simdLevel);
+        renderer.setResortAngle(opts.resortAngle);
+        renderer.setCulling(opts.culling);
+        renderer.setChunkedSort(opts.chunkedSort);
+        renderer.setAsyncSort(opts.asyncSort);
+        renderer.setSortBackend(opts.sortBackend);
+        renderer.setValidateSort(opts.validateSort);
+        renderer.setUploadBudget(opts.uploadBudgetMB << 20);
+        renderer.setLodError(opts.lodError);
+        renderer.setLodBudget(opts.lodBudget);
+        FrameProfiler& profiler = renderer.getProfiler();
+        profiler.setEnabled(opts.profile);
+        profiler.setRecording(!opts.tracePath.empty());
+        if (composition) {
+            // One scene at a time, appended to the shared store and freed
+            minPos = glm::vec3(FLT_MAX);
+            maxPos = glm::vec3(-FLT_MAX);
+            for (size_t i = 0; i < placements.size(); i++) {
+                const ScenePlacement& placement = placements[i];
+                std::cout << "Loading " << placement.path << "..." << std::endl;
+                GaussianData scene = loadScene(placement.path, opts, threadPool);
+                addBounds(scene.boundsMin, scene.boundsMax, placement.transform, minPos, maxPos);
+                if (i == 0) {
+                    renderer.setGaussianData(std::move(scene));
+                    if (placement.transform != glm::mat4(1.0f)) {
+                        renderer.setInstanceTransform(0, placement.transform);
+                    }
+                } else {
+                    renderer.addInstance(scene, placement.transform);
+                }
+                if (!placement.visible) {
+                    renderer.setInstanceVisible(i, false);
+                }
+            }
+            loadTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::high_resolution_clock::now() - startLoad).count();
+            std::cout << "Loaded " << renderer.getGaussianData().count() << " Gaussians from " << placements.size()
+                      << " scenes in " << loadTime << "ms" << std::endl;
+        } else {
+            // The renderer takes ownership; data is not used past this point
+            renderer.setGaussianData(std::move(data));
+        }
+        if (!lodTree.empty()) {
+            renderer.setLodTree(std::move(lodTree));
+        }
+        if (streamingLoader) {
+            renderer.reserveSplats(streamingLoader->getProgress().totalSplats);
+        }
+        std::cout << "Splat texture: " << renderer.getSplatTexture().describe() << std::endl;
+        if (!streamingLoader && opts.memoryReport) {
+            MemoryReport report;
+            renderer.reportMemory(report);
+            report.print(std::cout);
+        }
 
         Camera camera(width, height, 45.0f);
-        camera.setPosition(center + glm::vec3(0.0f, 0.0f, distance));
-        camera.setTarget(center);
-        
-        // Create controls
         OrbitControls controls(window, &camera);
+        // A streamed scene is framed again once all of it is in
+        frameBounds(minPos, maxPos, camera, controls);
         
         // Setup context for callbacks
         AppContext ctx;
         ctx.renderer = &renderer;
         ctx.controls = &controls;
         glfwSetWindowUserPointer(window, &ctx);
+        glfwSetKeyCallback(window, key_callback);
         
         std::cout << "\nRendering started. Press ESC to quit.\n" << std::endl;
         
+        // Selection brush radius in window pixels
+        const float kBrushRadius = 20.0f;
+        
         // Render loop
         auto lastFrame = std::chrono::high_resolution_clock::now();
         int frameCount = 0;
@@ -127,7 +499,31 @@ int main(int argc, char** argv) {
             fpsTimer += deltaTime;
             if (fpsTimer >= 1.0) {
                 std::string title = "Gaussian Splat Viewer - " + std::to_string(frameCount) + " FPS - " +
-                                    std::to_string(data.count()) + " Gaussians";
+                                    std::to_string(renderer.getSplatCount()) + " Gaussians";
+                if (streamingLoader) {
+                    LoadProgress progress = streamingLoader->getProgress();
+                    int percent = progress.totalBytes > 0 ? static_cast<int>(100 * progress.bytesRead / progress.totalBytes) : 0;
+                    double mbps = progress.seconds > 0.0 ? progress.bytesRead / progress.seconds / 1e6 : 0.0;
+                    title += " - loading " + std::to_string(percent) + "% at " + std::to_string(static_cast<int>(mbps)) + " MB/s";
+                }
+                if (renderer.isCulling() || renderer.hasLodTree()) {
+                    title += " - " + std::to_string(renderer.getDrawCount()) + " drawn";
+                }
+                if (renderer.hasLodTree()) {
+                    title += " (LOD)";
+                } else if (renderer.getSortBackend() == SortBackend::Gpu) {
+                    title += " - GPU sort";
+                } else if (renderer.isAsyncSort()) {
+                    title += " - sort latency " + std::to_string(renderer.getSortLatency()) + " frames";
+                }
+                if (profiler.isEnabled()) {
+                    Percentiles cpu = profiler.getCpuPercentiles(ProfilePhase::Frame);
+                    Percentiles gpu = profiler.getGpuPercentiles(ProfilePhase::Frame);
+                    char timings[96];
+                    std::snprintf(timings, sizeof(timings), " - CPU p50 %.2f p99 %.2f ms, GPU p50 %.2f p99 %.2f ms",
+                                  cpu.p50, cpu.p99, gpu.p50, gpu.p99);
+                    title += timings;
+                }
                 glfwSetWindowTitle(window, title.c_str());
                 frameCount = 0;
                 fpsTimer = 0.0;
@@ -137,6 +533,55 @@ int main(int argc, char** argv) {
             if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
                 glfwSetWindowShouldClose(window, true);
             }
+            for (int degree = 0; degree <= kMaxShDegree; degree++) {
+                if (glfwGetKey(window, GLFW_KEY_0 + degree) == GLFW_PRESS && renderer.getShDegree() != degree &&
+                    degree <= renderer.getGaussianData().shDegree) {
+                    renderer.setShDegree(degree);
+                }
+            }
+            
+            // Shift-drag paints the selection, with Ctrl held it erases
+            bool shift = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS ||
+                         glfwGetKey(window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS;
+            if (shift && glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS && !renderer.hasLodTree()) {
+                double mouseX, mouseY;
+                int windowWidth, windowHeight;
+                glfwGetCursorPos(window, &mouseX, &mouseY);
+                glfwGetWindowSize(window, &windowWidth, &windowHeight);
+                SelectionMode mode = glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS ? SelectionMode::Subtract
+                                                                                             : SelectionMode::Add;
+                renderer.select(SelectionShape::brush(camera.getViewProjMatrix(), glm::vec2(windowWidth, windowHeight),
+                                                      glm::vec2(mouseX, mouseY), kBrushRadius),
+                                mode);
+            }
+            
+            // Append whatever the loader finished since the last frame
+            if (streamingLoader) {
+                GaussianData chunk;
+                while (streamingLoader->poll(chunk)) {
+                    renderer.appendGaussianData(chunk);
+                }
+                if (streamingLoader->isDone()) {
+                    LoadProgress progress = streamingLoader->getProgress();
+                    std::cout << "Loaded " << renderer.getGaussianData().count() << " Gaussians in "
+                              << static_cast<int>(progress.seconds * 1000.0) << "ms ("
+                              << static_cast<int>(progress.bytesRead / std::max(progress.seconds, 1e-6) / 1e6)
+                              << " MB/s)" << std::endl;
+                    streamingLoader.reset();
+                    frameBounds(renderer.getGaussianData().boundsMin, renderer.getGaussianData().boundsMax, camera,
+                                controls);
+                    // A scene edited while it loaded is not what the file holds
+                    if (opts.useCache && !renderer.isEdited() &&
+                        SplatCache::write(cachePath, scenePath, opts.layout, renderer.getGaussianData())) {
+                        std::cout << "Wrote cache " << cachePath << std::endl;
+                    }
+                    if (opts.memoryReport) {
+                        MemoryReport report;
+                        renderer.reportMemory(report);
+                        report.print(std::cout);
+                    }
+                }
+            }
             
             // Update controls and camera
             controls.update(deltaTime);
@@ -149,6 +594,21 @@ int main(int argc, char** argv) {
             glfwPollEvents();
         }
         
+        if (profiler.isEnabled()) {
+            profiler.flush();
+            profiler.printSummary(std::cout);
+        }
+        if (!opts.tracePath.empty()) {
+            const std::string& path = opts.tracePath;
+            bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+            if (csv) {
+                profiler.writeCsv(path);
+            } else {
+                profiler.writeChromeTrace(path);
+            }
+            std::cout << "Wrote trace " << path << std::endl;
+        }
+        
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         glfwTerminate();
@@ -0,0 +1,190 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "DepthKeys.h"
+#include "Simd.h"
+#include "TestHarness.h"
+#include "TestScenes.h"
+
+namespace gsplat {
+
+namespace {
+
+// Positions around the origin, some far outside any frustum, with NaN and
+// infinite coordinates mixed in
+struct Positions {
+    std::vector<float> x, y, z;
+};
+
+Positions makePositions(uint32_t count, uint32_t seed) {
+    const float special[] = {
+        std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(), 1e30f, -1e30f, 1e-40f, -0.0f,
+    };
+    const uint32_t specialCount = sizeof(special) / sizeof(special[0]);
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    Positions p;
+    p.x.resize(count);
+    p.y.resize(count);
+    p.z.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        float spread = i % 5 == 0 ? 20.0f : 2.0f;
+        p.x[i] = unit(rng) * spread;
+        p.y[i] = unit(rng) * spread;
+        p.z[i] = unit(rng) * spread;
+        if (i % 97 == 0) {
+            float* axis = (i / 97) % 3 == 0 ? p.x.data() : (i / 97) % 3 == 1 ? p.y.data() : p.z.data();
+            axis[i] = special[(i / 291) % specialCount];
+        }
+    }
+    return p;
+}
+
+// Perspective and orthographic views from a few directions
+std::vector<glm::mat4> makeViews() {
+    std::vector<glm::mat4> views;
+    for (const glm::vec3& eye : kViewEyes) {
+        views.push_back(perspectiveView(eye));
+        views.push_back(orthographicView(eye, 2.0f));
+    }
+    return views;
+}
+
+bool sameBits(const void* a, const void* b, size_t bytes) {
+    return bytes == 0 || std::memcmp(a, b, bytes) == 0;
+}
+
+bool sameBits(float a, float b) {
+    return sameBits(&a, &b, sizeof(float));
+}
+
+} // namespace
+
+GSPLAT_TEST(DepthKeysMatchScalarAtEveryLevel) {
+    // Counts around the vector widths exercise every tail
+    const uint32_t counts[] = {0, 1, 7, 8, 15, 16, 17, 33, 100003};
+    const Positions p = makePositions(100003, 2);
+    const std::vector<glm::mat4> views = makeViews();
+
+    for (int l = 1; l <= static_cast<int>(detectSimdLevel()); l++) {
+        const SimdLevel level = static_cast<SimdLevel>(l);
+        const char* name = simdLevelName(level);
+        for (size_t v = 0; v < views.size(); v++) {
+            const DepthAxis axis = depthAxisFromViewProj(views[v]);
+            const ClipRows clip = clipRowsFromViewProj(views[v]);
+            for (uint32_t count : counts) {
+                std::vector<uint32_t> keys(count), expectedKeys(count);
+                computeDepthKeys32(SimdLevel::Scalar, axis, p.x.data(), p.y.data(), p.z.data(), count,
+                                   expectedKeys.data());
+                computeDepthKeys32(level, axis, p.x.data(), p.y.data(), p.z.data(), count, keys.data());
+                CHECK_MSG(keys == expectedKeys, name << " keys, view " << v << ", " << count << " splats");
+
+                std::vector<float> depths(count), expectedDepths(count);
+                float minDepth = 0.5f, maxDepth = 0.5f, expectedMin = 0.5f, expectedMax = 0.5f;
+                computeDepths(SimdLevel::Scalar, axis, p.x.data(), p.y.data(), p.z.data(), count,
+                              expectedDepths.data(), expectedMin, expectedMax);
+                computeDepths(level, axis, p.x.data(), p.y.data(), p.z.data(), count, depths.data(),
+                              minDepth, maxDepth);
+                CHECK_MSG(sameBits(depths.data(), expectedDepths.data(), count * sizeof(float)) &&
+                          sameBits(minDepth, expectedMin) && sameBits(maxDepth, expectedMax),
+                          name << " depths, view " << v << ", " << count << " splats");
+
+                // Quantized over a range that clamps the far splats at both ends
+                const float quantizeMin = -3.0f, quantizeScale = 65535.0f / 12.0f;
+                std::vector<uint32_t> quantized(count), expectedQuantized(count);
+                quantizeDepths16(SimdLevel::Scalar, expectedDepths.data(), count, quantizeMin, quantizeScale,
+                                 expectedQuantized.data());
+                quantizeDepths16(level, expectedDepths.data(), count, quantizeMin, quantizeScale, quantized.data());
+                CHECK_MSG(quantized == expectedQuantized, name << " 16-bit keys, view " << v << ", " << count);
+
+                // The base offsets the indices, as for a block of a larger scene
+                const uint32_t base = 1000;
+                std::vector<uint32_t> indices(count), expectedIndices(count);
+                uint32_t visible = cullDepthKeys32(level, clip, axis, p.x.data(), p.y.data(), p.z.data(), count,
+                                                   base, keys.data(), indices.data());
+                uint32_t expectedVisible = cullDepthKeys32(SimdLevel::Scalar, clip, axis, p.x.data(), p.y.data(),
+                                                           p.z.data(), count, base, expectedKeys.data(),
+                                                           expectedIndices.data());
+                CHECK_MSG(visible == expectedVisible &&
+                          sameBits(keys.data(), expectedKeys.data(), visible * sizeof(uint32_t)) &&
+                          sameBits(indices.data(), expectedIndices.data(), visible * sizeof(uint32_t)),
+                          name << " culled keys, view " << v << ", " << count << " splats");
+
+                minDepth = maxDepth = expectedMin = expectedMax = 0.5f;
+                visible = cullDepths(level, clip, axis, p.x.data(), p.y.data(), p.z.data(), count, base,
+                                     depths.data(), indices.data(), minDepth, maxDepth);
+                expectedVisible = cullDepths(SimdLevel::Scalar, clip, axis, p.x.data(), p.y.data(), p.z.data(),
+                                             count, base, expectedDepths.data(), expectedIndices.data(),
+                                             expectedMin, expectedMax);
+                CHECK_MSG(visible == expectedVisible &&
+                          sameBits(depths.data(), expectedDepths.data(), visible * sizeof(float)) &&
+                          sameBits(indices.data(), expectedIndices.data(), visible * sizeof(uint32_t)) &&
+                          sameBits(minDepth, expectedMin) && sameBits(maxDepth, expectedMax),
+                          name << " culled depths, view " << v << ", " << count << " splats");
+            }
+        }
+    }
+}
+
+GSPLAT_TEST(DepthKeysClassifyBoxAgreesWithCulling) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> size(0.0f, 1.0f);
+    const std::vector<glm::mat4> views = makeViews();
+    const uint32_t kSamples = 64;
+
+    size_t counts[3] = {0, 0, 0};
+    for (size_t v = 0; v < views.size(); v++) {
+        const DepthAxis axis = depthAxisFromViewProj(views[v]);
+        const ClipRows clip = clipRowsFromViewProj(views[v]);
+        for (int b = 0; b < 2000; b++) {
+            // Boxes from tiny to larger than the view, often across a plane
+            glm::vec3 center = glm::vec3(unit(rng), unit(rng), unit(rng)) * 8.0f;
+            glm::vec3 half = glm::vec3(size(rng), size(rng), size(rng)) * (b % 4 == 0 ? 6.0f : 0.5f);
+            glm::vec3 boxMin = center - half, boxMax = center + half;
+            BoxVisibility visibility = classifyBox(clip, boxMin, boxMax);
+            counts[static_cast<int>(visibility)]++;
+
+            // The corners, then points inside
+            Positions p;
+            for (uint32_t s = 0; s < kSamples; s++) {
+                glm::vec3 t = s < 8 ? glm::vec3(s & 1, (s >> 1) & 1, (s >> 2) & 1)
+                                    : glm::vec3(size(rng), size(rng), size(rng));
+                // Clamped, as the interpolation can round past the box
+                glm::vec3 point = glm::min(glm::max(boxMin + (boxMax - boxMin) * t, boxMin), boxMax);
+                p.x.push_back(point.x);
+                p.y.push_back(point.y);
+                p.z.push_back(point.z);
+            }
+            uint32_t keys[kSamples], indices[kSamples];
+            uint32_t visible = cullDepthKeys32(SimdLevel::Scalar, clip, axis, p.x.data(), p.y.data(), p.z.data(),
+                                               kSamples, 0, keys, indices);
+            if (visibility == BoxVisibility::Inside) {
+                CHECK_MSG(visible == kSamples, "view " << v << ", box " << b << " is inside but "
+                                               << kSamples - visible << " points are culled");
+            } else if (visibility == BoxVisibility::Outside) {
+                CHECK_MSG(visible == 0, "view " << v << ", box " << b << " is outside but " << visible
+                                        << " points are visible");
+            }
+
+            float minDepth = 0.0f, maxDepth = 0.0f;
+            boxDepthRange(axis, boxMin, boxMax, minDepth, maxDepth);
+            std::vector<float> depths(kSamples);
+            float lowest = INFINITY, highest = -INFINITY;
+            computeDepths(SimdLevel::Scalar, axis, p.x.data(), p.y.data(), p.z.data(), kSamples, depths.data(),
+                          lowest, highest);
+            CHECK_MSG(minDepth <= lowest && highest <= maxDepth,
+                      "view " << v << ", box " << b << ": depths outside boxDepthRange");
+        }
+    }
+    // Every outcome must have been reached for the checks to mean anything
+    CHECK_MSG(counts[0] > 0 && counts[1] > 0 && counts[2] > 0,
+              counts[0] << " outside, " << counts[1] << " partial, " << counts[2] << " inside");
+}
+
+} // namespace gsplat
@@ -0,0 +1,103 @@
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Camera.h"
+#include "GpuSort.h"
+#include "HeadlessContext.h"
+#include "Renderer.h"
+#include "TestHarness.h"
+#include "TestScenes.h"
+
+namespace gsplat {
+
+namespace {
+
+constexpr int kWidth = 320;
+constexpr int kHeight = 240;
+
+// Packed scene within the views; the count is odd so the sort's last block
+// is partial
+GaussianData makeScene(size_t count, uint32_t seed, SplatFormat format) {
+    GaussianData data = makeRandomScene(count, seed, {2.0f, -6.0f, -2.0f});
+    data.format = format;
+    data.pack(nullptr);
+    return data;
+}
+
+// Color target the renderer draws into; the context has no default framebuffer
+struct Framebuffer {
+    Framebuffer() {
+        glGenFramebuffers(1, &fbo);
+        glGenRenderbuffers(1, &color);
+        glBindRenderbuffer(GL_RENDERBUFFER, color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, kWidth, kHeight);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    }
+    ~Framebuffer() {
+        glDeleteRenderbuffers(1, &color);
+        glDeleteFramebuffers(1, &fbo);
+    }
+
+    GLuint fbo = 0;
+    GLuint color = 0;
+};
+
+} // namespace
+
+GSPLAT_TEST(GpuSortMatchesCpuSort) {
+    std::unique_ptr<HeadlessContext> context;
+    try {
+        context = std::make_unique<HeadlessContext>(4, 3);
+    } catch (const std::exception& e) {
+        reportSkip(e.what());
+        return;
+    }
+    if (!GpuSort::isSupported()) {
+        reportSkip("no compute shaders");
+        return;
+    }
+    Framebuffer framebuffer;
+
+    // Views from outside the scene and from within it
+    std::vector<glm::vec3> eyes(std::begin(kViewEyes), std::end(kViewEyes));
+    eyes.push_back(glm::vec3(0.3f, -0.2f, 0.1f));
+    for (SplatFormat format : {SplatFormat::Full, SplatFormat::Compressed}) {
+        for (bool instanced : {false, true}) {
+            const char* name = format == SplatFormat::Full ? "full" : "compressed";
+            Renderer renderer(kWidth, kHeight, "");
+            renderer.setSortBackend(SortBackend::Gpu);
+            renderer.setValidateSort(true);
+            renderer.setUploadBudget(0);
+            renderer.setGaussianData(makeScene(30001, 7, format));
+            // A second scene, placed and rotated, sorted together with the first
+            if (instanced) {
+                glm::mat4 transform = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(1.5f, 0.0f, -1.0f)),
+                                                  glm::radians(40.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+                renderer.addInstance(makeScene(12345, 8, format), transform);
+                renderer.setInstanceTransform(0, glm::scale(glm::mat4(1.0f), glm::vec3(0.5f)));
+            }
+
+            Camera camera(kWidth, kHeight);
+            camera.setTarget(kViewTarget);
+            camera.setClipPlanes(0.01f, 100.0f);
+            for (const glm::vec3& eye : eyes) {
+                camera.setPosition(eye);
+                renderer.render(camera);
+            }
+            CHECK_MSG(renderer.getValidatedSorts() == eyes.size(),
+                      name << (instanced ? " instanced" : "") << ": " << renderer.getValidatedSorts()
+                      << " orders validated");
+            CHECK_MSG(renderer.getMismatchedSorts() == 0,
+                      name << (instanced ? " instanced" : "") << ": " << renderer.getMismatchedSorts()
+                      << " orders differ from SplatSort::sort");
+        }
+    }
+}
+
+} // namespace gsplat
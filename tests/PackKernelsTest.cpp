@@ -0,0 +1,124 @@
+#include <cstring>
+#include <limits>
+
+#include "GaussianData.h"
+#include "Simd.h"
+#include "ThreadPool.h"
+#include "Utils.h"
+#include "TestHarness.h"
+#include "TestScenes.h"
+
+#if defined(GSPLAT_X86_KERNELS)
+#include <immintrin.h>
+#endif
+
+namespace gsplat {
+
+namespace {
+
+// Odd, and large enough that a pool splits the packing into several blocks
+constexpr size_t kSplats = 100003;
+
+// Scene in which every seventh splat has one scale no real scene has:
+// NaN, infinities, values past the half range and denormals
+GaussianData makeScene(size_t count, uint32_t seed) {
+    const float special[] = {
+        std::numeric_limits<float>::quiet_NaN(), -std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+        1e30f, -3e38f, 65504.0f, 7e4f, 1e-40f, -1e-42f, 1e-20f, 0.0f, -0.0f,
+    };
+    const size_t specialCount = sizeof(special) / sizeof(special[0]);
+
+    GaussianData data = makeRandomScene(count, seed, {10.0f, -12.0f, 4.0f});
+    for (size_t i = 0; i < count; i += 7) {
+        data.scales[i][(i / 7) % 3] = special[(i / 21) % specialCount];
+    }
+    return data;
+}
+
+// Index of the first word that differs, or count
+size_t firstDifference(const void* a, const void* b, size_t count) {
+    const uint32_t* wordsA = static_cast<const uint32_t*>(a);
+    const uint32_t* wordsB = static_cast<const uint32_t*>(b);
+    for (size_t i = 0; i < count; i++) {
+        if (wordsA[i] != wordsB[i]) return i;
+    }
+    return count;
+}
+
+#if defined(GSPLAT_X86_KERNELS)
+__attribute__((target("f16c")))
+void halvesF16C(const float* values, uint16_t* halves) {
+    __m128i packed = _mm_cvtps_ph(_mm_loadu_ps(values), _MM_FROUND_TO_ZERO);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(halves), packed);
+}
+#endif
+
+} // namespace
+
+GSPLAT_TEST(PackMatchesScalarAtEveryLevel) {
+    GaussianData reference = makeScene(kSplats, 1);
+    reference.pack(nullptr, SimdLevel::Scalar);
+
+    ThreadPool pool(4);
+    for (int l = 0; l <= static_cast<int>(detectSimdLevel()); l++) {
+        const SimdLevel level = static_cast<SimdLevel>(l);
+        for (ThreadPool* threads : {static_cast<ThreadPool*>(nullptr), &pool}) {
+            GaussianData data = makeScene(kSplats, 1);
+            data.pack(threads, level);
+            const char* with = threads ? " with a pool" : "";
+
+            size_t word = firstDifference(data.packedData.data(), reference.packedData.data(),
+                                          reference.packedData.size());
+            CHECK_MSG(word == reference.packedData.size(),
+                      simdLevelName(level) << with << ": packed word " << word << " of splat " << word / 8);
+            const std::vector<float>* axes[3][2] = {
+                {&data.worldPositions.x, &reference.worldPositions.x},
+                {&data.worldPositions.y, &reference.worldPositions.y},
+                {&data.worldPositions.z, &reference.worldPositions.z},
+            };
+            for (int k = 0; k < 3; k++) {
+                size_t i = firstDifference(axes[k][0]->data(), axes[k][1]->data(), kSplats);
+                CHECK_MSG(i == kSplats, simdLevelName(level) << with << ": position " << k << " of splat " << i);
+            }
+            CHECK_MSG(data.boundsMin == reference.boundsMin && data.boundsMax == reference.boundsMax,
+                      simdLevelName(level) << with);
+        }
+    }
+}
+
+GSPLAT_TEST(PackHalvesMatchF16C) {
+#if defined(GSPLAT_X86_KERNELS)
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("f16c")) {
+        reportSkip("no F16C");
+        return;
+    }
+    // Every sign, exponent and the top 14 fraction bits, which covers each
+    // half the rounding can produce; the low bits are scrambled
+    size_t mismatches = 0;
+    for (uint32_t high = 0; high < (1u << 23); high += 4) {
+        float values[4];
+        uint16_t expected[4];
+        for (uint32_t k = 0; k < 4; k++) {
+            uint32_t bits = ((high + k) << 9) | (((high + k) * 2654435761u) >> 23);
+            std::memcpy(&values[k], &bits, sizeof(float));
+        }
+        halvesF16C(values, expected);
+        for (uint32_t k = 0; k < 4; k++) {
+            uint16_t half = floatToHalf(values[k]);
+            if (half != expected[k] && mismatches++ == 0) {
+                uint32_t bits;
+                std::memcpy(&bits, &values[k], sizeof(bits));
+                CHECK_MSG(half == expected[k], "float bits 0x" << std::hex << bits << ": 0x" << half
+                                               << " instead of 0x" << expected[k]);
+            }
+        }
+    }
+    CHECK_MSG(mismatches == 0, mismatches << " floats convert differently");
+#else
+    reportSkip("not an x86 build");
+#endif
+}
+
+} // namespace gsplat
@@ -0,0 +1,184 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "GaussianData.h"
+#include "SceneFile.h"
+#include "Utils.h"
+#include "TestHarness.h"
+#include "TestScenes.h"
+
+namespace gsplat {
+
+namespace {
+
+// A file in the temporary directory, removed when it goes out of scope
+struct TempFile {
+    explicit TempFile(const std::string& name)
+        : path((std::filesystem::temp_directory_path() /
+                ("gsplat_tests_" + std::to_string(std::random_device()()) + "_" + name)).string()) {}
+    ~TempFile() { std::remove(path.c_str()); }
+
+    std::string path;
+};
+
+void writeBytes(const std::string& path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+template <typename T>
+void put(std::string& bytes, size_t offset, T value) {
+    if (bytes.size() < offset + sizeof(T)) bytes.resize(offset + sizeof(T), '\0');
+    std::memcpy(&bytes[offset], &value, sizeof(T));
+}
+
+template <typename T>
+void append(std::string& bytes, T value) {
+    put(bytes, bytes.size(), value);
+}
+
+float rotationDegrees(const glm::quat& a, const glm::quat& b) {
+    glm::quat r = glm::conjugate(a) * b;
+    return glm::degrees(2.0f * std::atan2(glm::length(glm::vec3(r.x, r.y, r.z)), std::abs(r.w)));
+}
+
+} // namespace
+
+GSPLAT_TEST(SceneFileRoundTrips) {
+    const GaussianData scene = makeRandomScene(50000, 6, {30.0f, -7.0f, 1.0f, 3});
+    struct Case {
+        SceneFormat format;
+        const char* extension;
+        int shDegree;
+    };
+    const Case cases[] = {
+        {SceneFormat::Ply, "ply", 3},
+        {SceneFormat::Splat, "splat", 0},
+        {SceneFormat::KSplat, "ksplat", 2},
+        {SceneFormat::Spz, "spz", 3},
+    };
+    for (const Case& c : cases) {
+        TempFile file(std::string("round_trip.") + c.extension);
+        SceneFile::write(file.path, scene, c.format);
+        CHECK_MSG(SceneFile::detect(file.path) == c.format, c.extension);
+        GaussianData loaded = SceneFile::load(file.path, nullptr, true);
+
+        SceneDifference difference = SceneFile::compare(scene, loaded);
+        SceneDifference tolerance = SceneFile::roundTripTolerance(scene, c.format);
+        CHECK_MSG(loaded.shDegree == c.shDegree, c.extension << ": degree " << loaded.shDegree);
+        CHECK_MSG(difference.within(tolerance),
+                  c.extension << ": " << loaded.positions.size() << " splats, position " << difference.position
+                  << ", scale " << difference.scale << ", rotation " << difference.rotation << " deg, color "
+                  << difference.color << ", alpha " << difference.alpha << ", harmonics " << difference.harmonics);
+    }
+}
+
+GSPLAT_TEST(SceneFileDecodesKSplatLevel1) {
+    // One section of 11 splats in three buckets of at most 4, the last one
+    // partial, with 16-bit positions offset along x from the bucket centers
+    const uint32_t count = 11, bucketSize = 4, scaleRange = 32767;
+    const float blockSize = 5.0f;
+    const glm::vec3 centers[] = {{0.0f, 0.0f, 0.0f}, {10.0f, 0.0f, 0.0f}, {0.0f, 20.0f, 0.0f}};
+    const float step = blockSize * 0.5f / scaleRange;
+    // Scales as the halfs store them
+    const glm::vec3 scales(halfToFloat(floatToHalf(0.1f)), halfToFloat(floatToHalf(0.2f)),
+                           halfToFloat(floatToHalf(0.3f)));
+
+    std::string bytes;
+    put(bytes, 0, uint8_t(0));                // version 0.1
+    put(bytes, 1, uint8_t(1));
+    put(bytes, 4, uint32_t(1));               // max section count
+    put(bytes, 8, uint32_t(1));               // section count
+    put(bytes, 12, count);
+    put(bytes, 16, count);
+    put(bytes, 20, uint16_t(1));              // compression level
+    const size_t section = 4096;
+    put(bytes, section, count);
+    put(bytes, section + 4, count);
+    put(bytes, section + 8, bucketSize);
+    put(bytes, section + 12, uint32_t(3));    // bucket count
+    put(bytes, section + 16, blockSize);
+    put(bytes, section + 20, uint16_t(12));   // bucket storage bytes
+    put(bytes, section + 24, scaleRange);
+    put(bytes, section + 32, uint32_t(2));    // full buckets
+    put(bytes, section + 36, uint32_t(1));    // partial buckets
+    put(bytes, section + 40, uint16_t(0));    // harmonic degree
+    bytes.resize(section + 1024, '\0');
+    append(bytes, uint32_t(3));               // length of the partial bucket
+    for (const glm::vec3& center : centers) {
+        append(bytes, center.x); append(bytes, center.y); append(bytes, center.z);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        float offset = (i % bucketSize) * 0.5f;
+        append(bytes, static_cast<uint16_t>(scaleRange + static_cast<uint32_t>(offset / step)));
+        append(bytes, static_cast<uint16_t>(scaleRange));
+        append(bytes, static_cast<uint16_t>(scaleRange));
+        for (int c = 0; c < 3; c++) append(bytes, floatToHalf(scales[c]));
+        for (float r : {1.0f, 0.0f, 0.0f, 0.0f}) append(bytes, floatToHalf(r));
+        append(bytes, glm::u8vec4(static_cast<uint8_t>(i), 2, 3, 4));
+    }
+    TempFile file("level1.ksplat");
+    writeBytes(file.path, bytes);
+
+    GaussianData data = SceneFile::load(file.path, nullptr, true);
+    CHECK_MSG(data.positions.size() == count, data.positions.size() << " splats");
+    for (uint32_t i = 0; i < count && i < data.positions.size(); i++) {
+        glm::vec3 expected = centers[i / bucketSize] + glm::vec3((i % bucketSize) * 0.5f, 0.0f, 0.0f);
+        CHECK_MSG(glm::length(data.positions[i] - expected) <= step, "splat " << i << " position");
+        CHECK_MSG(data.scales[i] == scales, "splat " << i << " scale");
+        CHECK_MSG(rotationDegrees(data.rotations[i], glm::quat(1.0f, 0.0f, 0.0f, 0.0f)) < 0.1f,
+                  "splat " << i << " rotation");
+        CHECK_MSG(data.colors[i] == glm::u8vec4(static_cast<uint8_t>(i), 2, 3, 4), "splat " << i << " color");
+    }
+}
+
+GSPLAT_TEST(SceneFileDecodesSpzVersion2) {
+    // Two splats with 12 fractional bits and 3-byte rotations, at the ends
+    // of the color and scale byte ranges
+    const glm::vec3 positions[] = {{1.5f, -2.25f, 3.0f}, {-0.5f, 0.25f, 100.0f}};
+    std::string bytes;
+    append(bytes, uint32_t(0x5053474e));      // "NGSP"
+    append(bytes, uint32_t(2));
+    append(bytes, uint32_t(2));
+    append(bytes, uint8_t(0));                // harmonic degree
+    append(bytes, uint8_t(12));               // fractional bits
+    append(bytes, uint8_t(0));
+    append(bytes, uint8_t(0));
+    for (const glm::vec3& p : positions) {
+        for (int c = 0; c < 3; c++) {
+            int32_t fixed = static_cast<int32_t>(std::round(p[c] * 4096.0f));
+            append(bytes, uint8_t(fixed)); append(bytes, uint8_t(fixed >> 8)); append(bytes, uint8_t(fixed >> 16));
+        }
+    }
+    for (uint8_t b : {200, 10}) append(bytes, b);                                  // alphas
+    for (uint8_t b : {128, 128, 128, 255, 0, 128}) append(bytes, b);               // colors
+    for (uint8_t b : {160, 160, 160, 0, 255, 16}) append(bytes, b);                // scales
+    for (uint8_t b : {128, 128, 128, 255, 128, 128}) append(bytes, b);             // rotations x y z
+    TempFile file("version2.spz");
+    writeBytes(file.path, bytes);
+
+    GaussianData data = SceneFile::load(file.path, nullptr, true);
+    CHECK_MSG(data.positions.size() == 2, data.positions.size() << " splats");
+    if (data.positions.size() != 2) return;
+    CHECK(data.positions[0] == positions[0] && data.positions[1] == positions[1]);
+    CHECK_MSG(data.colors[0] == glm::u8vec4(128, 128, 128, 200), "splat 0 color");
+    CHECK_MSG(data.colors[1] == glm::u8vec4(255, 0, 128, 10), "splat 1 color");
+
+    const glm::vec3 scales[] = {{1.0f, 1.0f, 1.0f}, {std::exp(-10.0f), std::exp(255.0f / 16.0f - 10.0f), std::exp(-9.0f)}};
+    for (int i = 0; i < 2; i++) {
+        glm::vec3 relative = data.scales[i] / scales[i] - 1.0f;
+        CHECK_MSG(std::abs(relative.x) < 1e-5f && std::abs(relative.y) < 1e-5f && std::abs(relative.z) < 1e-5f,
+                  "splat " << i << " scale");
+    }
+    // Byte 128 is 1/255 off zero, so the rotations are within a degree of
+    // the identity and of half a turn about x
+    CHECK_MSG(rotationDegrees(data.rotations[0], glm::quat(1.0f, 0.0f, 0.0f, 0.0f)) < 1.0f, "splat 0 rotation");
+    CHECK_MSG(rotationDegrees(data.rotations[1], glm::quat(0.0f, 1.0f, 0.0f, 0.0f)) < 1.0f, "splat 1 rotation");
+}
+
+} // namespace gsplat
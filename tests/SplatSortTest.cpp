@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "GaussianData.h"
+#include "SplatChunks.h"
+#include "SplatSort.h"
+#include "ThreadPool.h"
+#include "TestHarness.h"
+#include "TestScenes.h"
+
+namespace gsplat {
+
+namespace {
+
+// NDC depth, as the sort before the radix sort ordered by
+std::vector<float> ndcDepths(const glm::mat4& viewProj, const SoAPositions& positions) {
+    std::vector<float> depths(positions.size());
+    for (size_t i = 0; i < depths.size(); i++) {
+        glm::vec4 clip = viewProj * glm::vec4(positions.x[i], positions.y[i], positions.z[i], 1.0f);
+        depths[i] = clip.z / clip.w;
+    }
+    return depths;
+}
+
+// Where order differs from std::sort on the NDC depth, both splats must
+// tie to rounding: the radix sort orders by w, which z/w only matches
+// exactly in real arithmetic
+size_t orderMismatches(const std::vector<uint32_t>& order, const std::vector<float>& depths) {
+    std::vector<uint32_t> expected(depths.size());
+    std::iota(expected.begin(), expected.end(), 0u);
+    std::sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b) {
+        return depths[a] < depths[b] || (depths[a] == depths[b] && a < b);
+    });
+    if (order.size() != expected.size()) return expected.size();
+    size_t mismatches = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+        if (order[i] == expected[i]) continue;
+        float a = depths[order[i]], b = depths[expected[i]];
+        if (std::abs(a - b) > 1e-6f * std::max(1.0f, std::abs(b))) mismatches++;
+    }
+    return mismatches;
+}
+
+// Per splat, the key the full sort ordered by. 16-bit keys quantize over
+// the depth range of the splats it kept, the visible ones when culling.
+// Chunked sorts order by 32-bit keys, which these only coarsen.
+std::vector<uint32_t> sortKeys(const glm::mat4& viewProj, const SoAPositions& positions,
+                               const std::vector<uint32_t>& kept, SortKeyBits bits) {
+    const DepthAxis axis = depthAxisFromViewProj(viewProj);
+    const uint32_t count = static_cast<uint32_t>(positions.size());
+    std::vector<uint32_t> keys(count);
+    if (bits == SortKeyBits::Bits32) {
+        computeDepthKeys32(SimdLevel::Scalar, axis, positions.x.data(), positions.y.data(), positions.z.data(),
+                           count, keys.data());
+        return keys;
+    }
+    std::vector<float> depths(count);
+    float lowest = FLT_MAX, highest = -FLT_MAX;
+    computeDepths(SimdLevel::Scalar, axis, positions.x.data(), positions.y.data(), positions.z.data(), count,
+                  depths.data(), lowest, highest);
+    float minDepth = FLT_MAX, maxDepth = -FLT_MAX;
+    for (uint32_t i : kept) {
+        minDepth = std::min(minDepth, depths[i]);
+        maxDepth = std::max(maxDepth, depths[i]);
+    }
+    float range = maxDepth - minDepth;
+    quantizeDepths16(SimdLevel::Scalar, depths.data(), count, minDepth, range > 0.0f ? 65535.0f / range : 0.0f,
+                     keys.data());
+    return keys;
+}
+
+} // namespace
+
+GSPLAT_TEST(SortMatchesStdSortOnNdcDepth) {
+    const uint32_t count = 50000;
+    const SoAPositions positions = clusteredPositions(count, 4);
+    for (const glm::vec3& eye : kViewEyes) {
+        for (bool perspective : {true, false}) {
+            glm::mat4 viewProj = perspective ? perspectiveView(eye) : orthographicView(eye, 1.0f);
+            std::vector<uint32_t> order;
+            SplatSort::sort(viewProj, positions.x.data(), positions.y.data(), positions.z.data(), count, order);
+            size_t mismatches = orderMismatches(order, ndcDepths(viewProj, positions));
+            CHECK_MSG(mismatches == 0, (perspective ? "perspective" : "orthographic") << " view from ("
+                                       << eye.x << ", " << eye.y << ", " << eye.z << "): " << mismatches
+                                       << " splats out of place");
+        }
+    }
+}
+
+GSPLAT_TEST(SortRefineMatchesFullSort) {
+    // Small rotations, dollies that change the visible set, then an
+    // orthographic projection; every frame is compared with a fresh sort
+    const uint32_t count = 100000;
+    const SoAPositions positions = clusteredPositions(count, 5);
+    SplatChunks chunks;
+    chunks.update(positions, count);
+    ThreadPool pool(4);
+
+    for (int config = 0; config < 8; config++) {
+        const bool culling = config & 1, chunked = config & 2, bits16 = config & 4;
+        const SortKeyBits bits = bits16 ? SortKeyBits::Bits16 : SortKeyBits::Bits32;
+        SplatSortContext context(bits);
+        context.setThreadPool(&pool);
+        context.setCulling(culling);
+        context.setChunks(chunked ? &chunks : nullptr);
+
+        int incremental = 0;
+        for (int frame = 0; frame < 40; frame++) {
+            float angle = glm::radians(0.001f * frame);
+            glm::vec3 eye(1.6f * std::sin(angle), 0.2f, 1.6f * std::cos(angle));
+            float dolly = frame < 10 ? 0.0f : 0.01f * (frame < 20 ? frame - 9 : 29 - frame);
+            eye += (kViewTarget - eye) * dolly;
+            glm::mat4 viewProj = frame < 30 ? perspectiveView(eye) : orthographicView(eye, 1.0f);
+
+            std::vector<uint32_t> order, expected;
+            context.sort(viewProj, positions.x.data(), positions.y.data(), positions.z.data(), count, order);
+            incremental += context.getLastPath() == SortPath::Incremental;
+            SplatSortContext fresh(bits);
+            fresh.setCulling(culling);
+            fresh.sort(viewProj, positions.x.data(), positions.y.data(), positions.z.data(), count, expected);
+
+            // Ties may keep the previous frame's order, so the keys are compared
+            std::vector<uint32_t> sortedOrder = order, sortedExpected = expected;
+            std::sort(sortedOrder.begin(), sortedOrder.end());
+            std::sort(sortedExpected.begin(), sortedExpected.end());
+            bool sameKeys = sortedOrder == sortedExpected;
+            if (sameKeys) {
+                std::vector<uint32_t> keys = sortKeys(viewProj, positions, expected, bits);
+                for (size_t i = 0; sameKeys && i < order.size(); i++) {
+                    sameKeys = keys[order[i]] == keys[expected[i]];
+                }
+            }
+            CHECK_MSG(sameKeys, "culling " << culling << ", chunks " << chunked << ", " << (bits16 ? 16 : 32)
+                                << "-bit keys, frame " << frame << ": not the order of a full sort");
+        }
+        CHECK_MSG(incremental > 20, "culling " << culling << ", chunks " << chunked << ": only " << incremental
+                                    << " of 40 frames refined");
+    }
+}
+
+} // namespace gsplat
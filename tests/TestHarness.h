@@ -0,0 +1,40 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+
+namespace gsplat {
+
+// Minimal self-registering tests for gsplat_tests. A failed check is
+// reported and the test carries on, so one run lists every mismatch.
+using TestFunction = void (*)();
+
+struct TestRegistration {
+    TestRegistration(const char* name, TestFunction function);
+};
+
+void reportFailure(const char* file, int line, const std::string& message);
+// Mark the running test skipped, for hardware or a context it needs, then
+// return from it. A run whose every test skipped exits with kSkipExitCode.
+void reportSkip(const std::string& reason);
+
+constexpr int kSkipExitCode = 77;
+
+} // namespace gsplat
+
+#define GSPLAT_TEST(name)                                                       \
+    static void name();                                                         \
+    static const gsplat::TestRegistration name##Registration(#name, name);      \
+    static void name()
+
+// message is streamed, so it can mix text and values
+#define CHECK_MSG(condition, message)                                           \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::ostringstream checkMessage;                                    \
+            checkMessage << #condition << ": " << message;                      \
+            gsplat::reportFailure(__FILE__, __LINE__, checkMessage.str());      \
+        }                                                                       \
+    } while (0)
+
+#define CHECK(condition) CHECK_MSG(condition, "failed")
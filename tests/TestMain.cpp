@@ -0,0 +1,75 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "TestHarness.h"
+
+namespace gsplat {
+
+namespace {
+
+struct TestCase {
+    const char* name;
+    TestFunction function;
+};
+
+std::vector<TestCase>& registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+int failures = 0;
+std::string skipReason;
+
+} // namespace
+
+TestRegistration::TestRegistration(const char* name, TestFunction function) {
+    registry().push_back({name, function});
+}
+
+void reportFailure(const char* file, int line, const std::string& message) {
+    std::cerr << file << ":" << line << ": " << message << std::endl;
+    failures++;
+}
+
+void reportSkip(const std::string& reason) {
+    skipReason = reason;
+}
+
+} // namespace gsplat
+
+// Runs the tests whose name starts with any of the arguments, or all of
+// them; exits non-zero if a check failed or nothing matched, and with
+// kSkipExitCode if every test that ran skipped
+int main(int argc, char** argv) {
+    using namespace gsplat;
+    int run = 0, skipped = 0;
+    for (const TestCase& test : registry()) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc && !selected; i++) {
+            selected = std::strncmp(test.name, argv[i], std::strlen(argv[i])) == 0;
+        }
+        if (!selected) continue;
+        
+        int before = failures;
+        skipReason.clear();
+        test.function();
+        if (failures != before) {
+            std::cout << "[FAIL] " << test.name << std::endl;
+        } else if (!skipReason.empty()) {
+            std::cout << "[skip] " << test.name << ": " << skipReason << std::endl;
+            skipped++;
+        } else {
+            std::cout << "[pass] " << test.name << std::endl;
+        }
+        run++;
+    }
+    if (run == 0) {
+        std::cerr << "No tests match" << std::endl;
+        return 1;
+    }
+    std::cout << run << " tests, " << skipped << " skipped, " << failures << " failed checks" << std::endl;
+    if (failures > 0) return 1;
+    return skipped == run ? kSkipExitCode : 0;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "GaussianData.h"
+
+namespace gsplat {
+
+// Seeded fixtures the tests share, so each picks a shape rather than
+// writing its own generator
+struct RandomSceneShape {
+    // Positions are uniform in [-extent, extent] on each axis
+    float extent = 1.0f;
+    // Each scale axis is exp of a value uniform in this range
+    float minLogScale = -4.0f;
+    float maxLogScale = 0.0f;
+    // Harmonic bands past DC, with coefficients in [-0.9, 0.9], which every
+    // format stores without clamping
+    int shDegree = 0;
+};
+
+// Source attributes only, unpacked: uniform positions and log scales,
+// normalized random rotations, random colors and harmonics
+inline GaussianData makeRandomScene(size_t count, uint32_t seed, const RandomSceneShape& shape = {}) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> logScale(shape.minLogScale, shape.maxLogScale);
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    GaussianData data;
+    data.positions.resize(count);
+    data.scales.resize(count);
+    data.rotations.resize(count);
+    data.colors.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        data.positions[i] = glm::vec3(unit(rng), unit(rng), unit(rng)) * shape.extent;
+        data.scales[i] = glm::vec3(std::exp(logScale(rng)), std::exp(logScale(rng)), std::exp(logScale(rng)));
+        data.rotations[i] = glm::normalize(glm::quat(unit(rng), unit(rng), unit(rng), unit(rng)));
+        data.colors[i] = glm::u8vec4(byte(rng), byte(rng), byte(rng), byte(rng));
+    }
+    data.shDegree = shape.shDegree;
+    data.shRest.resize(count * 3 * shCoefficients(shape.shDegree));
+    for (float& value : data.shRest) {
+        value = unit(rng) * 0.9f;
+    }
+    return data;
+}
+
+// Positions of a random scene in runs of nearby splats, like a spatially
+// sorted scene, so chunks have tight bounds
+inline SoAPositions clusteredPositions(uint32_t count, uint32_t seed) {
+    std::vector<glm::vec3> points = makeRandomScene(count, seed).positions;
+    auto cell = [](const glm::vec3& p) { return glm::ivec3((p + 1.0f) * 4.0f); };
+    std::sort(points.begin(), points.end(), [&](const glm::vec3& a, const glm::vec3& b) {
+        glm::ivec3 ca = cell(a), cb = cell(b);
+        if (ca.x != cb.x) return ca.x < cb.x;
+        if (ca.y != cb.y) return ca.y < cb.y;
+        if (ca.z != cb.z) return ca.z < cb.z;
+        return a.x < b.x;
+    });
+    SoAPositions positions;
+    positions.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        positions.x[i] = points[i].x;
+        positions.y[i] = points[i].y;
+        positions.z[i] = points[i].z;
+    }
+    return positions;
+}
+
+// Test views look slightly off the origin, so no view axis is degenerate,
+// from in front of, behind and above, and below the scene
+inline const glm::vec3 kViewTarget(0.2f, 0.0f, -0.1f);
+inline const glm::vec3 kViewEyes[] = {{0.0f, 0.5f, 6.0f}, {-4.0f, 3.0f, -2.5f}, {0.3f, -7.0f, 0.1f}};
+
+inline glm::mat4 perspectiveView(const glm::vec3& eye) {
+    return glm::perspective(glm::radians(50.0f), 1.5f, 0.1f, 100.0f) *
+           glm::lookAt(eye, kViewTarget, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+inline glm::mat4 orthographicView(const glm::vec3& eye, float halfHeight) {
+    return glm::ortho(-1.5f * halfHeight, 1.5f * halfHeight, -halfHeight, halfHeight, 0.1f, 100.0f) *
+           glm::lookAt(eye, kViewTarget, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+} // namespace gsplat
@@ -0,0 +1,518 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "GaussianData.h"
+#include "PLYLoader.h"
+#include "SceneFile.h"
+#include "SplatChunks.h"
+#include "SplatSort.h"
+#include "ThreadPool.h"
+#include "Simd.h"
+#include "Utils.h"
+
+#ifdef GSPLAT_BENCH_GL
+#include "glad/glad.h"
+
+#include "GpuSort.h"
+#include "HeadlessContext.h"
+#include "SplatTexture.h"
+#endif
+
+using namespace gsplat;
+
+// Microbenchmarks of the per-stage hot paths on seeded synthetic scenes:
+// half conversion, packing, depth sorting and PLY loading, plus texture
+// upload and the GPU sort where the build has EGL. Each benchmark runs once
+// to warm up, then repeats until both the repetition count and the minimum
+// time are reached; the median is reported as ns per splat, on stdout and
+// optionally as JSON for tracking across commits.
+
+enum class Distribution {
+    Uniform,    // Centers uniform in a cube
+    Clustered   // Centers in Gaussian blobs of varying size, like scanned objects
+};
+
+const char* distributionName(Distribution distribution) {
+    return distribution == Distribution::Uniform ? "uniform" : "clustered";
+}
+
+const std::vector<std::string> kStages = {"half", "pack", "sort", "load", "upload", "gpusort"};
+
+struct Options {
+    std::vector<size_t> sizes = {100000, 1000000};
+    std::vector<Distribution> distributions = {Distribution::Uniform, Distribution::Clustered};
+    std::vector<std::string> stages = kStages;
+    unsigned threads = 0;
+    uint32_t seed = 1;
+    int shDegree = 0;
+    int repetitions = 5;
+    double minTime = 0.5;
+    std::string jsonPath;
+};
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n";
+    std::cout << "\nOptions:\n";
+    std::cout << "  --sizes <list>         Splat counts, k and m suffixes allowed (default 100k,1m)\n";
+    std::cout << "  --distribution <d>     uniform, clustered or both (default both)\n";
+    std::cout << "  --stages <list>        Any of half, pack, sort, load, upload, gpusort (default all)\n";
+    std::cout << "  --threads <n>          Worker threads, 0 = all hardware threads (default 0)\n";
+    std::cout << "  --seed <n>             Scene generator seed (default 1)\n";
+    std::cout << "  --sh-degree <0-3>      Harmonic bands in the synthetic scenes (default 0)\n";
+    std::cout << "  --repetitions <n>      Timed runs per benchmark, at least (default 5)\n";
+    std::cout << "  --min-time <seconds>   Time per benchmark, at least (default 0.5)\n";
+    std::cout << "  --json <file>          Also write the results as JSON\n";
+}
+
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::istringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// "250000", "100k" or "2.5m"; false on anything else
+bool parseSize(const std::string& text, size_t& size) {
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    std::string suffix(end);
+    if (suffix == "k" || suffix == "K") {
+        value *= 1e3;
+    } else if (suffix == "m" || suffix == "M") {
+        value *= 1e6;
+    } else if (!suffix.empty()) {
+        return false;
+    }
+    if (end == text.c_str() || value < 1.0 || value > 1e9) return false;
+    size = static_cast<size_t>(std::llround(value));
+    return true;
+}
+
+bool parseArgs(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            opts.sizes.clear();
+            for (const std::string& item : splitList(argv[++i])) {
+                size_t size;
+                if (!parseSize(item, size)) {
+                    std::cerr << "Invalid size: " << item << std::endl;
+                    return false;
+                }
+                opts.sizes.push_back(size);
+            }
+        } else if (arg == "--distribution" && i + 1 < argc) {
+            std::string distribution = argv[++i];
+            if (distribution == "uniform") {
+                opts.distributions = {Distribution::Uniform};
+            } else if (distribution == "clustered") {
+                opts.distributions = {Distribution::Clustered};
+            } else if (distribution == "both") {
+                opts.distributions = {Distribution::Uniform, Distribution::Clustered};
+            } else {
+                std::cerr << "--distribution must be uniform, clustered or both" << std::endl;
+                return false;
+            }
+        } else if (arg == "--stages" && i + 1 < argc) {
+            opts.stages = splitList(argv[++i]);
+            for (const std::string& stage : opts.stages) {
+                if (std::find(kStages.begin(), kStages.end(), stage) == kStages.end()) {
+                    std::cerr << "Unknown stage: " << stage << std::endl;
+                    return false;
+                }
+            }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            int threads = std::atoi(argv[++i]);
+            if (threads < 0) {
+                std::cerr << "--threads must not be negative" << std::endl;
+                return false;
+            }
+            opts.threads = static_cast<unsigned>(threads);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            opts.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--sh-degree" && i + 1 < argc) {
+            opts.shDegree = std::atoi(argv[++i]);
+            if (opts.shDegree < 0 || opts.shDegree > kMaxShDegree) {
+                std::cerr << "--sh-degree must be 0 to " << kMaxShDegree << std::endl;
+                return false;
+            }
+        } else if (arg == "--repetitions" && i + 1 < argc) {
+            opts.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            opts.minTime = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--json" && i + 1 < argc) {
+            opts.jsonPath = argv[++i];
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return !opts.sizes.empty() && !opts.stages.empty();
+}
+
+// Source attributes of a synthetic scene, the same for a given seed with
+// any standard library: std::mt19937 is fully specified, values come from
+// its raw output rather than the implementation-defined distributions, and
+// each draw is its own statement so argument order cannot reorder them
+GaussianData generateScene(size_t count, Distribution distribution, int shDegree, uint32_t seed) {
+    std::mt19937 rng(seed);
+    auto uniform = [&](float lo, float hi) {
+        return lo + (hi - lo) * static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+    };
+    auto uniform3 = [&](float lo, float hi) {
+        float x = uniform(lo, hi);
+        float y = uniform(lo, hi);
+        float z = uniform(lo, hi);
+        return glm::vec3(x, y, z);
+    };
+    // Box-Muller; one of the pair is dropped to keep the stream simple
+    auto normal = [&]() {
+        float u = std::max(uniform(0.0f, 1.0f), 1e-7f);
+        return std::sqrt(-2.0f * std::log(u)) * std::cos(6.2831853f * uniform(0.0f, 1.0f));
+    };
+    auto byte = [&]() { return static_cast<uint8_t>(rng() & 0xff); };
+
+    // One blob per 20k splats, sized from a tenth to one unit
+    std::vector<glm::vec4> blobs(std::max<size_t>(1, count / 20000));
+    for (glm::vec4& blob : blobs) {
+        glm::vec3 center = uniform3(-10.0f, 10.0f);
+        blob = glm::vec4(center, uniform(0.1f, 1.0f));
+    }
+
+    GaussianData data;
+    data.shDegree = shDegree;
+    data.positions.resize(count);
+    data.scales.resize(count);
+    data.rotations.resize(count);
+    data.colors.resize(count);
+    size_t coefficients = shCoefficients(shDegree) * 3;
+    data.shRest.resize(count * coefficients);
+    for (size_t i = 0; i < count; i++) {
+        if (distribution == Distribution::Uniform) {
+            data.positions[i] = uniform3(-10.0f, 10.0f);
+        } else {
+            const glm::vec4& blob = blobs[rng() % blobs.size()];
+            float x = normal();
+            float y = normal();
+            float z = normal();
+            data.positions[i] = glm::vec3(blob) + blob.w * glm::vec3(x, y, z);
+        }
+        data.scales[i] = glm::exp(uniform3(-6.0f, -2.0f));
+        float w = normal();
+        float qx = normal();
+        float qy = normal();
+        float qz = normal();
+        data.rotations[i] = glm::normalize(glm::quat(w, qx, qy, qz));
+        for (int c = 0; c < 3; c++) {
+            data.colors[i][c] = byte();
+        }
+        data.colors[i].a = static_cast<uint8_t>(16 + rng() % 240);
+        for (size_t k = 0; k < coefficients; k++) {
+            data.shRest[i * coefficients + k] = uniform(-0.3f, 0.3f);
+        }
+    }
+    return data;
+}
+
+struct Result {
+    std::string stage;
+    std::string backend;
+    std::string variant;
+    Distribution distribution;
+    size_t splats;
+    // Seconds per timed run, sorted
+    std::vector<double> seconds;
+
+    double median() const { return seconds[seconds.size() / 2]; }
+    double nsPerSplat(double s) const { return s * 1e9 / static_cast<double>(splats); }
+};
+
+class Bench {
+public:
+    explicit Bench(const Options& opts) : opts(opts) {}
+
+    // Time body, calling setup untimed before each run
+    void run(const std::string& stage, const std::string& backend, const std::string& variant,
+             Distribution distribution, size_t splats, const std::function<void()>& body,
+             const std::function<void()>& setup = nullptr) {
+        Result result{stage, backend, variant, distribution, splats, {}};
+        if (setup) setup();
+        body();
+        double total = 0.0;
+        while (static_cast<int>(result.seconds.size()) < opts.repetitions || total < opts.minTime) {
+            if (setup) setup();
+            auto start = std::chrono::steady_clock::now();
+            body();
+            double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            result.seconds.push_back(s);
+            total += s;
+        }
+        std::sort(result.seconds.begin(), result.seconds.end());
+
+        std::cout << std::left << std::setw(8) << stage << std::setw(10) << backend << std::setw(16) << variant
+                  << std::setw(10) << distributionName(distribution) << std::right << std::setw(10) << splats
+                  << std::fixed << std::setprecision(3) << std::setw(10) << result.nsPerSplat(result.median())
+                  << " ns/splat (min " << result.nsPerSplat(result.seconds.front()) << ", "
+                  << result.seconds.size() << " runs)" << std::defaultfloat << std::endl;
+        results.push_back(std::move(result));
+    }
+
+    void writeJson(const std::string& path, unsigned threads, const std::string& glRenderer) const {
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("Failed to open " + path + " for writing");
+        }
+        out << std::setprecision(9);
+        out << "{\n  \"context\": {\"simd\": \"" << simdLevelName(detectSimdLevel()) << "\", \"threads\": "
+            << threads << ", \"seed\": " << opts.seed << ", \"sh_degree\": "
+            << opts.shDegree << ", \"gl_renderer\": \"" << glRenderer << "\"},\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.stage << "/" << r.backend << "/" << r.variant
+                << "/" << distributionName(r.distribution) << "/" << r.splats << "\", \"stage\": \"" << r.stage
+                << "\", \"backend\": \"" << r.backend << "\", \"variant\": \"" << r.variant
+                << "\", \"distribution\": \"" << distributionName(r.distribution) << "\", \"splats\": " << r.splats
+                << ", \"runs\": " << r.seconds.size() << ", \"ns_per_splat\": " << r.nsPerSplat(r.median())
+                << ", \"ns_per_splat_min\": " << r.nsPerSplat(r.seconds.front())
+                << ", \"seconds_median\": " << r.median() << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+private:
+    const Options& opts;
+    std::vector<Result> results;
+};
+
+// Views for the sort benchmarks: from outside the scene, with every splat
+// in front of the camera, and from inside it, where about a third is culled
+glm::mat4 viewProjection(bool inside) {
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    glm::vec3 eye = inside ? glm::vec3(1.0f, 2.0f, -6.0f) : glm::vec3(1.0f, 2.0f, -35.0f);
+    return projection * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+std::vector<SimdLevel> simdLevels() {
+    std::vector<SimdLevel> levels;
+    for (int level = 0; level <= static_cast<int>(detectSimdLevel()); level++) {
+        levels.push_back(static_cast<SimdLevel>(level));
+    }
+    return levels;
+}
+
+// Keeps results the optimizer could otherwise drop
+volatile uint32_t sink;
+
+void benchHalf(Bench& bench, Distribution distribution, size_t count, uint32_t seed) {
+    // Magnitudes over the whole half range, subnormals and overflow included
+    std::mt19937 rng(seed);
+    std::vector<float> values(count);
+    for (float& v : values) {
+        float magnitude = std::ldexp(static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f), int(rng() % 48) - 30);
+        v = (rng() & 1) ? -magnitude : magnitude;
+    }
+    bench.run("half", "scalar", "floatToHalf", distribution, count, [&] {
+        uint32_t sum = 0;
+        for (float v : values) {
+            sum += floatToHalf(v);
+        }
+        sink = sum;
+    });
+}
+
+void benchPack(Bench& bench, Distribution distribution, GaussianData& data, SplatFormat format, ThreadPool& pool) {
+    data.format = format;
+    for (SimdLevel level : simdLevels()) {
+        bench.run("pack", simdLevelName(level), format == SplatFormat::Full ? "full" : "compressed",
+                  distribution, data.positions.size(), [&] { data.pack(&pool, level); });
+    }
+}
+
+void benchSort(Bench& bench, Distribution distribution, const GaussianData& data, ThreadPool& pool) {
+    const SoAPositions& p = data.worldPositions;
+    uint32_t count = static_cast<uint32_t>(data.count());
+    SplatChunks chunks;
+    chunks.update(p, count);
+    std::vector<uint32_t> indices(count);
+
+    SplatSortContext context;
+    context.setThreadPool(&pool);
+    context.setRefineAngle(0.0f);
+    auto fullSort = [&](const glm::mat4& viewProj) {
+        return [&, viewProj] { context.sort(viewProj, p.x.data(), p.y.data(), p.z.data(), count, indices.data()); };
+    };
+    auto reset = [&] { context.reset(); };
+
+    // Every kernel level on the plain full sort, the culling paths at the best one
+    for (SimdLevel level : simdLevels()) {
+        context.setSimdLevel(level);
+        context.setCulling(false);
+        context.setChunks(nullptr);
+        for (SortKeyBits bits : {SortKeyBits::Bits16, SortKeyBits::Bits32}) {
+            context.setKeyBits(bits);
+            bench.run("sort", simdLevelName(level), bits == SortKeyBits::Bits16 ? "16-bit" : "32-bit",
+                      distribution, count, fullSort(viewProjection(false)), reset);
+        }
+    }
+    context.setKeyBits(SortKeyBits::Bits32);
+    context.setCulling(true);
+    bench.run("sort", simdLevelName(context.getSimdLevel()), "32-bit-culled", distribution, count,
+              fullSort(viewProjection(true)), reset);
+    context.setChunks(&chunks);
+    bench.run("sort", simdLevelName(context.getSimdLevel()), "32-bit-chunked", distribution, count,
+              fullSort(viewProjection(true)), reset);
+}
+
+void benchLoad(Bench& bench, Distribution distribution, const GaussianData& data, ThreadPool& pool) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                 ("gsplat_bench_" + std::to_string(data.positions.size()) + ".ply");
+    SceneFile::write(path.string(), data, SceneFormat::Ply);
+    try {
+        bench.run("load", "ply", "file-order", distribution, data.positions.size(),
+                  [&] { PLYLoader::load(path.string(), &pool); });
+        bench.run("load", "ply", "spatial", distribution, data.positions.size(),
+                  [&] { PLYLoader::load(path.string(), &pool, false, SplatLayout(), true); });
+    } catch (...) {
+        std::filesystem::remove(path);
+        throw;
+    }
+    std::filesystem::remove(path);
+}
+
+#ifdef GSPLAT_BENCH_GL
+// To skip scenes past the device's splat texture limit
+bool fitsTexture(const GaussianData& data) {
+    return data.count() <= SplatTexture::maxSplats(data.layout());
+}
+
+void benchUpload(Bench& bench, Distribution distribution, const GaussianData& data) {
+    if (!fitsTexture(data)) {
+        std::cout << "upload skipped: " << data.count() << " splats exceed the splat texture limit" << std::endl;
+        return;
+    }
+    SplatTexture texture;
+    texture.allocate(data.count(), data.layout());
+    bench.run("upload", "gl", data.format == SplatFormat::Full ? "full" : "compressed", distribution,
+              data.count(), [&] {
+                  texture.upload(data, 0, data.count());
+                  glFinish();
+              });
+}
+
+void benchGpuSort(Bench& bench, Distribution distribution, const GaussianData& data) {
+    if (!GpuSort::isSupported() || !fitsTexture(data)) {
+        std::cout << "gpusort skipped: needs OpenGL 4.3 and a texture of " << data.count() << " splats" << std::endl;
+        return;
+    }
+    SplatTexture texture;
+    texture.allocate(data.count(), data.layout());
+    texture.upload(data, 0, data.count());
+    GpuSort sort;
+    sort.resize(static_cast<uint32_t>(data.count()));
+    glm::mat4 viewProj = viewProjection(false);
+    bench.run("sort", "gpu", "32-bit", distribution, data.count(), [&] {
+                  sort.sort(viewProj, texture);
+                  glFinish();
+              },
+              [&] { sort.resize(static_cast<uint32_t>(data.count())); });
+}
+#endif
+
+bool hasStage(const Options& opts, const std::string& stage) {
+    return std::find(opts.stages.begin(), opts.stages.end(), stage) != opts.stages.end();
+}
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        std::string glRenderer;
+        bool needsGl = hasStage(opts, "upload") || hasStage(opts, "gpusort");
+#ifdef GSPLAT_BENCH_GL
+        std::unique_ptr<HeadlessContext> context;
+        if (needsGl) {
+            try {
+                context = std::make_unique<HeadlessContext>(4, 3);
+                glRenderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+            } catch (const std::exception& e) {
+                std::cerr << "Skipping GL stages: " << e.what() << std::endl;
+            }
+        }
+#else
+        if (needsGl) {
+            std::cerr << "Skipping GL stages: built without EGL" << std::endl;
+        }
+#endif
+        bool gl = !glRenderer.empty();
+
+        ThreadPool pool(opts.threads);
+        std::cout << "SIMD " << simdLevelName(detectSimdLevel()) << ", " << pool.size() << " threads, seed "
+                  << opts.seed << (gl ? ", " + glRenderer : std::string()) << std::endl;
+
+        Bench bench(opts);
+        for (size_t count : opts.sizes) {
+            for (Distribution distribution : opts.distributions) {
+                GaussianData data = generateScene(count, distribution, opts.shDegree, opts.seed);
+                // As the viewer loads scenes, so chunked sorting sees compact chunks
+                data.sortSpatially(&pool);
+
+                if (hasStage(opts, "half")) {
+                    benchHalf(bench, distribution, count, opts.seed);
+                }
+                if (hasStage(opts, "load")) {
+                    benchLoad(bench, distribution, data, pool);
+                }
+                // Full layout last, for the sorts
+                for (SplatFormat format : {SplatFormat::Compressed, SplatFormat::Full}) {
+                    if (hasStage(opts, "pack")) {
+                        benchPack(bench, distribution, data, format, pool);
+                    } else {
+                        data.format = format;
+                        data.pack(&pool);
+                    }
+#ifdef GSPLAT_BENCH_GL
+                    if (gl && hasStage(opts, "upload")) {
+                        benchUpload(bench, distribution, data);
+                    }
+#endif
+                }
+                if (hasStage(opts, "sort")) {
+                    benchSort(bench, distribution, data, pool);
+                }
+#ifdef GSPLAT_BENCH_GL
+                if (gl && hasStage(opts, "gpusort")) {
+                    benchGpuSort(bench, distribution, data);
+                }
+#endif
+            }
+        }
+
+        if (!opts.jsonPath.empty()) {
+            bench.writeJson(opts.jsonPath, pool.size(), glRenderer);
+            std::cout << "Wrote " << opts.jsonPath << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#include "SceneFile.h"
+#include "ThreadPool.h"
+
+using namespace gsplat;
+
+// Converts between the scene formats SceneFile reads and writes, e.g. a
+// training PLY to .splat, .ksplat or .spz. The output format follows the
+// output extension.
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options] <input> <output>\n";
+    std::cout << "\nInput: .ply, .splat, .ksplat or .spz (detected by magic or extension)\n";
+    std::cout << "Output format follows the output extension: .ply, .splat, .ksplat or .spz\n";
+    std::cout << "\nOptions:\n";
+    std::cout << "  --verify    Read the output back, print its largest difference from the input and\n";
+    std::cout << "              exit with status 2 if that exceeds the output format's quantization\n";
+}
+
+uint64_t fileSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file.is_open() ? static_cast<uint64_t>(file.tellg()) : 0;
+}
+
+// Print the round trip's largest difference next to what the output format
+// allows; returns whether it is within
+bool printDifference(const GaussianData& a, const GaussianData& b, SceneFormat format) {
+    SceneDifference difference = SceneFile::compare(a, b);
+    if (!difference.sameCount) {
+        std::cout << "Splat count differs: " << a.positions.size() << " vs " << b.positions.size() << std::endl;
+        return false;
+    }
+    SceneDifference tolerance = SceneFile::roundTripTolerance(a, format);
+    std::cout << "Round trip of " << a.positions.size() << " splats, largest difference (allowed):\n"
+              << "  position  " << difference.position << " (" << tolerance.position << ", scene extent "
+              << glm::length(a.boundsMax - a.boundsMin) << ")\n"
+              << "  scale     " << difference.scale * 100.0f << "% (" << tolerance.scale * 100.0f << "%)\n"
+              << "  rotation  " << difference.rotation << " deg (" << tolerance.rotation << ")\n"
+              << "  color     " << difference.color << "/255 (" << tolerance.color << "), alpha "
+              << difference.alpha << "/255 (" << tolerance.alpha << ")\n"
+              << "  harmonics " << difference.harmonics << " (" << tolerance.harmonics << ", degree "
+              << a.shDegree << " -> " << b.shDegree << ")" << std::endl;
+    return difference.within(tolerance);
+}
+
+int main(int argc, char** argv) {
+    bool verify = false;
+    std::string inputPath, outputPath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--verify") {
+            verify = true;
+        } else if (!arg.empty() && arg[0] != '-' && inputPath.empty()) {
+            inputPath = arg;
+        } else if (!arg.empty() && arg[0] != '-' && outputPath.empty()) {
+            outputPath = arg;
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (outputPath.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    SceneFormat outputFormat;
+    if (!SceneFile::formatFromExtension(outputPath, outputFormat)) {
+        std::cerr << "Unknown output format: " << outputPath << std::endl;
+        return 1;
+    }
+
+    try {
+        ThreadPool threadPool;
+        SceneFormat inputFormat = SceneFile::detect(inputPath);
+        GaussianData data = SceneFile::load(inputPath, &threadPool, true);
+        SceneFile::write(outputPath, data, outputFormat);
+
+        uint64_t inputBytes = fileSize(inputPath);
+        uint64_t outputBytes = fileSize(outputPath);
+        std::cout << "Converted " << data.count() << " splats from " << sceneFormatName(inputFormat) << " to "
+                  << sceneFormatName(outputFormat) << ": " << inputBytes << " -> " << outputBytes << " bytes";
+        if (outputBytes > 0) {
+            std::cout << " (" << static_cast<double>(inputBytes) / static_cast<double>(outputBytes) << "x)";
+        }
+        std::cout << std::endl;
+
+        if (verify && !printDifference(data, SceneFile::load(outputPath, &threadPool, true), outputFormat)) {
+            std::cerr << "Round trip exceeds the " << sceneFormatName(outputFormat) << " quantization" << std::endl;
+            return 2;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
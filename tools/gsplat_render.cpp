@@ -0,0 +1,443 @@
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+#include "glad/glad.h"
+
+#include "CameraSet.h"
+#include "HeadlessContext.h"
+#include "ImageWriter.h"
+#include "Renderer.h"
+#include "SceneComposition.h"
+#include "SceneFile.h"
+#include "SplatCache.h"
+#include "ThreadPool.h"
+#include "Simd.h"
+
+using namespace gsplat;
+
+// Renders every view of a camera list offscreen and writes one PNG per
+// view, for evaluating trained scenes on machines without a display. The
+// sort for the next view runs on the sort worker while the current one is
+// drawn and read back, readback goes through a ring of pixel buffers, and
+// PNGs are written on their own thread.
+
+struct Options {
+    std::string scenePath;
+    std::string camerasPath;
+    std::string outputDir = "renders";
+    unsigned threads = 0;
+    SimdLevel simdLevel = detectSimdLevel();
+    SortKeyBits sortKeyBits = SortKeyBits::Bits32;
+    SortBackend sortBackend = SortBackend::Cpu;
+    bool validateSort = false;
+    bool useCache = true;
+    SplatLayout layout;
+    bool culling = true;
+    bool chunkedSort = true;
+    bool postProcess = true;
+    bool shaderCache = true;
+    bool profile = false;
+    std::string tracePath;
+};
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options] --cameras <cameras.json> <scene_file>\n";
+    std::cout << "\nScene files: .ply, .splat, .ksplat or .spz (gzip-free), or a .json composition of several\n";
+    std::cout << "Cameras: 3DGS cameras.json (img_name, width, height, position, rotation, fx, fy)\n";
+    std::cout << "\nOptions:\n";
+    std::cout << "  --cameras <file>     Camera list to render, one image per entry\n";
+    std::cout << "  --output <dir>       Directory the <img_name>.png files go to (default renders)\n";
+    std::cout << "  --threads <n>        Worker threads for CPU work, 0 = all hardware threads (default 0)\n";
+    std::cout << "  --simd <level>       CPU kernel level: auto, scalar, sse4, avx2, avx512 (default auto)\n";
+    std::cout << "  --sort-bits <16|32>  Depth sort key width (default 32)\n";
+    std::cout << "  --sort-backend <b>   Where to sort: cpu, gpu (compute shaders, OpenGL 4.3) (default cpu)\n";
+    std::cout << "  --validate-sort      With the gpu backend, check every order against the CPU sort and exit\n";
+    std::cout << "                       with status 2 if any differs (slow, for testing)\n";
+    std::cout << "  --no-cache           Neither read nor write the <scene_file>.gsplatcache binary cache\n";
+    std::cout << "  --compressed         Store splats in 16 quantized bytes instead of 32\n";
+    std::cout << "  --sh-degree <0-3>    Highest spherical harmonic degree loaded (default 3)\n";
+    std::cout << "  --sh-format <f>      Harmonic storage: half, or byte with a per-splat range (default half)\n";
+    std::cout << "  --no-cull            Sort and draw every splat instead of only those in the view frustum\n";
+    std::cout << "  --no-chunks          Cull and sort splat by splat instead of by spatial chunk first\n";
+    std::cout << "  --no-post            Draw splat colors as they are, without saturation, white point and sharpening\n";
+    std::cout << "  --no-shader-cache    Compile shaders on every start instead of caching the linked programs\n";
+    std::cout << "  --profile            Time each render phase on the CPU and GPU and print percentiles at the end\n";
+    std::cout << "  --trace <file>       With --profile, write every view's timings: .csv, else Chrome trace JSON\n";
+}
+
+bool parseArgs(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--cameras" && i + 1 < argc) {
+            opts.camerasPath = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            opts.outputDir = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            int threads = std::atoi(argv[++i]);
+            if (threads < 0) {
+                std::cerr << "--threads must not be negative" << std::endl;
+                return false;
+            }
+            opts.threads = static_cast<unsigned>(threads);
+        } else if (arg == "--simd" && i + 1 < argc) {
+            if (!parseSimdLevel(argv[++i], opts.simdLevel)) {
+                std::cerr << "--simd must be auto, scalar, sse4, avx2 or avx512" << std::endl;
+                return false;
+            }
+        } else if (arg == "--sort-bits" && i + 1 < argc) {
+            std::string bits = argv[++i];
+            if (bits == "16") {
+                opts.sortKeyBits = SortKeyBits::Bits16;
+            } else if (bits == "32") {
+                opts.sortKeyBits = SortKeyBits::Bits32;
+            } else {
+                std::cerr << "--sort-bits must be 16 or 32" << std::endl;
+                return false;
+            }
+        } else if (arg == "--sort-backend" && i + 1 < argc) {
+            std::string backend = argv[++i];
+            if (backend == "cpu") {
+                opts.sortBackend = SortBackend::Cpu;
+            } else if (backend == "gpu") {
+                opts.sortBackend = SortBackend::Gpu;
+            } else {
+                std::cerr << "--sort-backend must be cpu or gpu" << std::endl;
+                return false;
+            }
+        } else if (arg == "--validate-sort") {
+            opts.validateSort = true;
+        } else if (arg == "--no-cache") {
+            opts.useCache = false;
+        } else if (arg == "--compressed") {
+            opts.layout.format = SplatFormat::Compressed;
+        } else if (arg == "--sh-degree" && i + 1 < argc) {
+            int degree = std::atoi(argv[++i]);
+            if (degree < 0 || degree > kMaxShDegree) {
+                std::cerr << "--sh-degree must be 0 to " << kMaxShDegree << std::endl;
+                return false;
+            }
+            opts.layout.shDegree = degree;
+        } else if (arg == "--sh-format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format == "half") {
+                opts.layout.shFormat = ShFormat::Half;
+            } else if (format == "byte") {
+                opts.layout.shFormat = ShFormat::Byte;
+            } else {
+                std::cerr << "--sh-format must be half or byte" << std::endl;
+                return false;
+            }
+        } else if (arg == "--no-cull") {
+            opts.culling = false;
+        } else if (arg == "--no-chunks") {
+            opts.chunkedSort = false;
+        } else if (arg == "--no-post") {
+            opts.postProcess = false;
+        } else if (arg == "--no-shader-cache") {
+            opts.shaderCache = false;
+        } else if (arg == "--profile") {
+            opts.profile = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            opts.tracePath = argv[++i];
+            opts.profile = true;
+        } else if (!arg.empty() && arg[0] != '-' && opts.scenePath.empty()) {
+            opts.scenePath = arg;
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    if (opts.validateSort && opts.sortBackend != SortBackend::Gpu) {
+        std::cerr << "--validate-sort needs --sort-backend gpu" << std::endl;
+        return false;
+    }
+    return !opts.scenePath.empty() && !opts.camerasPath.empty();
+}
+
+// Color target the views are drawn into, resized to each view
+class Framebuffer {
+public:
+    Framebuffer() : fbo(0), color(0), width(0), height(0) {
+        glGenFramebuffers(1, &fbo);
+        glGenRenderbuffers(1, &color);
+    }
+    ~Framebuffer() {
+        glDeleteRenderbuffers(1, &color);
+        glDeleteFramebuffers(1, &fbo);
+    }
+
+    void bind(int w, int h) {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        if (w == width && h == height) return;
+        width = w;
+        height = h;
+        glBindRenderbuffer(GL_RENDERBUFFER, color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            throw std::runtime_error("Offscreen framebuffer of " + std::to_string(width) + "x" +
+                                     std::to_string(height) + " is incomplete");
+        }
+    }
+
+private:
+    GLuint fbo;
+    GLuint color;
+    int width;
+    int height;
+};
+
+// Pixel buffers read back asynchronously: a frame's pixels are copied into
+// a buffer right after its draw and mapped only once the ring comes round,
+// so the GPU is never waited on for the frame it is still working on
+class Readback {
+public:
+    static constexpr int kSlots = 3;
+
+    explicit Readback(ImageWriter& writer) : writer(writer), next(0) {
+        glGenBuffers(kSlots, buffers);
+    }
+    ~Readback() {
+        for (Slot& slot : slots) {
+            if (slot.fence) glDeleteSync(slot.fence);
+        }
+        glDeleteBuffers(kSlots, buffers);
+    }
+
+    // Copy the bound framebuffer, retiring the oldest frame first if the ring is full
+    void read(const std::string& path, int width, int height) {
+        Slot& slot = slots[next];
+        if (slot.fence) retire(next);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[next]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width) * height * 4, nullptr, GL_STREAM_READ);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot = {path, width, height, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)};
+        next = (next + 1) % kSlots;
+    }
+
+    // Retire every frame still in flight, oldest first
+    void flush() {
+        for (int k = 0; k < kSlots; k++) {
+            int s = (next + k) % kSlots;
+            if (slots[s].fence) retire(s);
+        }
+    }
+
+private:
+    struct Slot {
+        std::string path;
+        int width = 0;
+        int height = 0;
+        GLsync fence = nullptr;
+    };
+
+    void retire(int s) {
+        Slot& slot = slots[s];
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[s]);
+        const size_t size = static_cast<size_t>(slot.width) * slot.height * 4;
+        const uint8_t* rgba = static_cast<const uint8_t*>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT));
+        if (!rgba) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            throw std::runtime_error("Failed to map the readback buffer for " + slot.path);
+        }
+        // GL rows run bottom up; images top down
+        std::vector<uint8_t> rgb(static_cast<size_t>(slot.width) * slot.height * 3);
+        for (int y = 0; y < slot.height; y++) {
+            const uint8_t* src = rgba + static_cast<size_t>(slot.height - 1 - y) * slot.width * 4;
+            uint8_t* dst = rgb.data() + static_cast<size_t>(y) * slot.width * 3;
+            for (int x = 0; x < slot.width; x++) {
+                dst[x * 3 + 0] = src[x * 4 + 0];
+                dst[x * 3 + 1] = src[x * 4 + 1];
+                dst[x * 3 + 2] = src[x * 4 + 2];
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        writer.write(slot.path, slot.width, slot.height, std::move(rgb));
+    }
+
+    ImageWriter& writer;
+    GLuint buffers[kSlots];
+    Slot slots[kSlots];
+    int next;
+};
+
+// The packed scene from its cache, or parsed and cached
+GaussianData loadScene(const std::string& path, const Options& opts, ThreadPool& threadPool) {
+    GaussianData data;
+    std::string cachePath = SplatCache::pathFor(path);
+    if (opts.useCache && SplatCache::load(cachePath, path, opts.layout, data)) {
+        std::cout << "Using cache " << cachePath << std::endl;
+    } else {
+        data = SceneFile::load(path, &threadPool, false, opts.layout, true);
+        if (opts.useCache && SplatCache::write(cachePath, path, opts.layout, data)) {
+            std::cout << "Wrote cache " << cachePath << std::endl;
+        }
+    }
+    return data;
+}
+
+// Grow [minPos, maxPos] by the box [boxMin, boxMax] placed with transform
+void addBounds(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::mat4& transform, glm::vec3& minPos,
+               glm::vec3& maxPos) {
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec3 p((corner & 1) ? boxMax.x : boxMin.x, (corner & 2) ? boxMax.y : boxMin.y,
+                    (corner & 4) ? boxMax.z : boxMin.z);
+        glm::vec3 world = glm::vec3(transform * glm::vec4(p, 1.0f));
+        minPos = glm::min(minPos, world);
+        maxPos = glm::max(maxPos, world);
+    }
+}
+
+// Pose camera as view, with clip planes around the scene bounds
+void applyView(const CameraView& view, const glm::vec3& boundsMin, const glm::vec3& boundsMax, Camera& camera) {
+    CameraSet::apply(view, camera);
+    float farthest = 0.0f;
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec3 p((corner & 1) ? boundsMax.x : boundsMin.x,
+                    (corner & 2) ? boundsMax.y : boundsMin.y,
+                    (corner & 4) ? boundsMax.z : boundsMin.z);
+        farthest = std::max(farthest, glm::length(p - view.position));
+    }
+    // Far enough that the frustum test keeps every splat in front of view
+    camera.setClipPlanes(0.01f, std::max(farthest * 1.01f, 1.0f));
+}
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        // Compute shaders need 4.3; keep asking for 4.2 otherwise
+        HeadlessContext context(4, opts.sortBackend == SortBackend::Gpu ? 3 : 2);
+        std::cout << "OpenGL " << glGetString(GL_VERSION) << " on " << glGetString(GL_RENDERER) << " ("
+                  << context.getDescription() << ")" << std::endl;
+
+        std::vector<CameraView> views = CameraSet::load(opts.camerasPath);
+        if (views.empty()) {
+            std::cerr << "No cameras in " << opts.camerasPath << std::endl;
+            return 1;
+        }
+        std::filesystem::create_directories(opts.outputDir);
+
+        ThreadPool threadPool(opts.threads);
+        std::vector<ScenePlacement> placements;
+        if (SceneComposition::isComposition(opts.scenePath)) {
+            placements = SceneComposition::load(opts.scenePath);
+        } else {
+            placements.push_back({opts.scenePath, glm::mat4(1.0f), true});
+        }
+
+        Framebuffer framebuffer;
+        framebuffer.bind(views[0].width, views[0].height);
+
+        Renderer renderer(views[0].width, views[0].height, opts.shaderCache ? ProgramCache::defaultDirectory() : "");
+        renderer.setPostProcess(opts.postProcess);
+        renderer.setSortKeyBits(opts.sortKeyBits);
+        renderer.setThreadPool(&threadPool);
+        renderer.setSimdLevel(opts.simdLevel);
+        renderer.setCulling(opts.culling);
+        renderer.setChunkedSort(opts.chunkedSort);
+        renderer.setSortBackend(opts.sortBackend);
+        renderer.setValidateSort(opts.validateSort);
+        // Every view gets an exact order; the worker only lets the next sort overlap this frame
+        renderer.setAsyncSort(true);
+        renderer.setUploadBudget(0);
+        FrameProfiler& profiler = renderer.getProfiler();
+        profiler.setEnabled(opts.profile);
+        profiler.setRecording(!opts.tracePath.empty());
+        
+        // One scene at a time, appended to the renderer's store and freed
+        glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+        for (size_t i = 0; i < placements.size(); i++) {
+            const ScenePlacement& placement = placements[i];
+            GaussianData scene = loadScene(placement.path, opts, threadPool);
+            addBounds(scene.boundsMin, scene.boundsMax, placement.transform, boundsMin, boundsMax);
+            if (i == 0) {
+                renderer.setGaussianData(std::move(scene));
+                if (placement.transform != glm::mat4(1.0f)) {
+                    renderer.setInstanceTransform(0, placement.transform);
+                }
+            } else {
+                renderer.addInstance(scene, placement.transform);
+            }
+            if (!placement.visible) {
+                renderer.setInstanceVisible(i, false);
+            }
+        }
+        std::cout << "Loaded " << renderer.getGaussianData().count() << " Gaussians, rendering " << views.size()
+                  << " views to " << opts.outputDir << std::endl;
+        std::cout << "Splat texture: " << renderer.getSplatTexture().describe() << std::endl;
+
+        Camera camera(views[0].width, views[0].height);
+        Camera next(views[0].width, views[0].height);
+        applyView(views[0], boundsMin, boundsMax, camera);
+
+        ImageWriter writer;
+        Readback readback(writer);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < views.size(); i++) {
+            const CameraView& view = views[i];
+            framebuffer.bind(view.width, view.height);
+            renderer.resize(view.width, view.height);
+            renderer.render(camera);
+            readback.read((std::filesystem::path(opts.outputDir) / (view.name + ".png")).string(),
+                          view.width, view.height);
+
+            if (i + 1 < views.size()) {
+                applyView(views[i + 1], boundsMin, boundsMax, next);
+                renderer.queueSort(next);
+                std::swap(camera, next);
+            }
+        }
+        readback.flush();
+        writer.finish();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Rendered " << writer.getWrittenCount() << " views in " << seconds << "s: "
+                  << (seconds > 0.0 ? static_cast<double>(views.size()) / seconds : 0.0) << " images/s"
+                  << std::endl;
+        const ProgramCache& programs = renderer.getProgramCache();
+        std::cout << "Shader programs: " << programs.getHits() << " from cache, " << programs.getMisses()
+                  << " compiled" << std::endl;
+        if (profiler.isEnabled()) {
+            profiler.flush();
+            profiler.printSummary(std::cout);
+        }
+        if (!opts.tracePath.empty()) {
+            const std::string& path = opts.tracePath;
+            bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+            if (csv) {
+                profiler.writeCsv(path);
+            } else {
+                profiler.writeChromeTrace(path);
+            }
+            std::cout << "Wrote trace " << path << std::endl;
+        }
+        if (opts.validateSort) {
+            size_t validated = renderer.getValidatedSorts(), mismatched = renderer.getMismatchedSorts();
+            std::cout << "Validated " << validated << " GPU orders, " << mismatched << " differ from the CPU sort"
+                      << std::endl;
+            if (validated == 0 || mismatched > 0) {
+                return 2;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}